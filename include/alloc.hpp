@@ -0,0 +1,129 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ALLOC_HPP
+#define ALLOC_HPP
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace alloc_lib {
+/**
+ * @brief Whether allocations are attributed to processing phases.
+ *
+ * The global `operator new` replacement always counts allocations and bytes,
+ * into counters of the allocating thread that are summed when read.
+ * Per-phase attribution is enabled with the `TRACK_ALLOCATIONS` CMake
+ * option; without it every allocation is counted under `phase::other` and
+ * `phase_scope` compiles to nothing.
+ */
+#ifdef TRACK_ALLOCATIONS
+inline constexpr bool enabled = true;
+#else
+inline constexpr bool enabled = false;
+#endif
+
+/**
+ * @brief Processing phase that allocations are attributed to.
+ */
+enum class phase : int {
+    other, ///< Anything outside of the phases below.
+    read, ///< Reading the input file.
+    parse, ///< Parsing the JSON document.
+    compile, ///< Parsing the expression.
+    evaluate, ///< Evaluating the expression.
+    serialize ///< Converting the result to text.
+};
+
+inline constexpr size_t phase_count = static_cast<size_t>(phase::serialize) + 1;
+
+/**
+ * @brief Convert a `phase` to its lower-case name.
+ *
+ * @param type The phase to convert.
+ * @return The name of the phase, e.g. `"parse"`.
+ */
+std::string phase_to_string(phase type);
+
+/**
+ * @brief Allocation counters of a single phase.
+ */
+struct counters {
+    size_t count = 0; ///< Number of `operator new` calls.
+    size_t bytes = 0; ///< Bytes requested by those calls.
+};
+
+/**
+ * @brief Allocations attributed to `type` since start or the last `reset()`.
+ *
+ * Counts are summed over all threads.
+ */
+counters allocations(phase type);
+
+/**
+ * @brief Allocations of all phases together.
+ */
+counters total();
+
+/**
+ * @brief Set all counters back to zero.
+ */
+void reset();
+
+#ifdef TRACK_ALLOCATIONS
+/**
+ * @brief Phase that allocations of the current thread are attributed to.
+ */
+inline thread_local phase current_phase = phase::other;
+#endif
+
+/**
+ * @brief Attribute allocations of the current thread to a phase while in
+ * scope.
+ *
+ * Scopes nest: the previous phase is restored on destruction.
+ */
+class phase_scope {
+public:
+    explicit phase_scope([[maybe_unused]] const phase type) {
+#ifdef TRACK_ALLOCATIONS
+        previous = std::exchange(current_phase, type);
+#endif
+    }
+
+    ~phase_scope() {
+#ifdef TRACK_ALLOCATIONS
+        current_phase = previous;
+#endif
+    }
+
+    phase_scope(const phase_scope&) = delete;
+    phase_scope& operator=(const phase_scope&) = delete;
+
+private:
+    [[maybe_unused]] phase previous = phase::other;
+};
+}
+
+#endif // ALLOC_HPP
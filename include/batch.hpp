@@ -0,0 +1,125 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+#include "governor.hpp"
+#include "json.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace batch_lib {
+/**
+ * @brief Counters of a `coalescer` since construction.
+ */
+struct coalescer_stats {
+    size_t batches = 0; ///< Batches the worker has processed.
+    size_t queries = 0; ///< Queries answered in total.
+    size_t coalesced = 0; ///< Queries answered from the shared traversal.
+    size_t steps = 0; ///< Accessor steps taken by the shared traversal.
+};
+
+/**
+ * @brief Evaluation front-end that answers concurrent queries against one
+ * parsed document in batches.
+ *
+ * Queries submitted within `window` of each other are collected by a single
+ * worker thread. Constant paths (`$` followed by keys and indices only) are
+ * merged into a trie and resolved in one traversal of the document, so a
+ * shared prefix is walked once for the whole batch. Every other expression
+ * is evaluated on its own. Results are handed back through futures.
+ *
+ * All evaluation happens on the worker, so the document is never accessed
+ * concurrently. The worker polls the cancellation token that was active on
+ * the thread constructing the coalescer. The shared traversal of a batch is
+ * charged to the `max_steps` and `max_time` budgets as one query, one step
+ * per trie edge; queries below an edge that exceeds them fail with
+ * `governor_lib::limit_exceeded`.
+ */
+class coalescer {
+public:
+    /**
+     * @param document The parsed document all queries run against.
+     * @param window How long the worker waits for more queries after the
+     * first one of a batch arrived.
+     * @param max_batch Queries after which a batch starts without waiting
+     * for the window to close.
+     */
+    explicit coalescer(
+        std::shared_ptr<json_lib::json> document,
+        std::chrono::microseconds window = std::chrono::microseconds(50),
+        size_t max_batch = 256
+    );
+
+    /**
+     * @brief Answer all pending queries and stop the worker.
+     */
+    ~coalescer();
+
+    coalescer(const coalescer&) = delete;
+    coalescer& operator=(const coalescer&) = delete;
+
+    /**
+     * @brief Queue a query for the next batch.
+     *
+     * The expression is compiled on the calling thread.
+     *
+     * @param expression The expression to evaluate.
+     * @return A future holding the result or the evaluation error.
+     * @throws std::runtime_error If the expression cannot be parsed.
+     */
+    std::future<std::shared_ptr<json_lib::json>>
+    submit(std::string expression);
+
+    [[nodiscard]] coalescer_stats stats() const;
+
+private:
+    struct request {
+        std::shared_ptr<json_lib::json> expression;
+        std::promise<std::shared_ptr<json_lib::json>> result;
+    };
+
+    void run();
+    void process(std::vector<request>& batch);
+
+    std::shared_ptr<json_lib::json> document;
+    std::chrono::microseconds window;
+    size_t max_batch;
+    const governor_lib::cancellation_token* token;
+
+    mutable std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<request> pending;
+    coalescer_stats counters;
+    bool stopping = false;
+    std::thread worker;
+};
+}
+
+#endif // BATCH_HPP
@@ -0,0 +1,146 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BINARY_HPP
+#define BINARY_HPP
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Little-endian encoding shared by the binary formats of the engine:
+ * snapshots, structural indexes, column stores, Bloom filter catalogs and
+ * dataguides.
+ */
+namespace binary_lib {
+inline void put_u8(std::string& out, const uint8_t value) {
+    out += static_cast<char>(value);
+}
+
+inline void put_u32(std::string& out, const uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+inline void put_u64(std::string& out, const uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+/**
+ * @brief Overwrite the 8 bytes at `offset` of `out` with `value`.
+ */
+inline void
+set_u64(std::string& out, const size_t offset, const uint64_t value) {
+    for (size_t i = 0; i < 8; ++i) {
+        out[offset + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+/**
+ * @brief The `width`-byte integer at `offset` of `data`, or nothing if it
+ * does not lie within `data`.
+ */
+inline std::optional<uint64_t>
+read(const std::string_view data, const uint64_t offset, const size_t width) {
+    if (offset > data.size() || data.size() - offset < width) {
+        return std::nullopt;
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < width; ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(data[offset + i]))
+            << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Bounds-checked little-endian cursor over encoded bytes.
+ *
+ * Every read past the end throws `std::runtime_error("corrupt <what>")`.
+ */
+class reader {
+public:
+    /**
+     * @param data The bytes to read; must outlive the reader.
+     * @param what Name of the format in error messages, e.g. `"dataguide"`.
+     */
+    reader(const std::string_view data, const std::string_view what)
+        : data(data)
+        , what(what) { }
+
+    uint8_t u8() { return static_cast<uint8_t>(next(1)); }
+    uint32_t u32() { return static_cast<uint32_t>(next(4)); }
+    uint64_t u64() { return next(8); }
+
+    std::string_view bytes(const uint64_t size) {
+        if (data.size() - pos < size) {
+            corrupt();
+        }
+        const auto result = data.substr(pos, size);
+        pos += size;
+        return result;
+    }
+
+    /**
+     * @brief Check an element count read from the data against the bytes
+     * left, before anything is allocated for it.
+     *
+     * @return `count`.
+     */
+    size_t count(const uint64_t count, const size_t element_size) const {
+        if (count > (data.size() - pos) / element_size) {
+            corrupt();
+        }
+        return count;
+    }
+
+    [[nodiscard]] bool done() const { return pos == data.size(); }
+
+    [[noreturn]] void corrupt() const {
+        throw std::runtime_error("corrupt " + std::string(what));
+    }
+
+private:
+    std::string_view data;
+    std::string_view what;
+    size_t pos = 0;
+
+    uint64_t next(const size_t width) {
+        const auto value = read(data, pos, width);
+        if (!value) {
+            corrupt();
+        }
+        pos += width;
+        return *value;
+    }
+};
+}
+
+#endif // BINARY_HPP
@@ -0,0 +1,169 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BLOOM_HPP
+#define BLOOM_HPP
+#include "index.hpp"
+#include "json.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bloom_lib {
+/**
+ * @brief Bloom filter over strings.
+ *
+ * Each item sets `hashes()` bits chosen by double hashing of a 64-bit
+ * FNV-1a hash, so the filter is stable across builds and can be persisted.
+ * `may_contain()` never misses an added item and reports an item that was
+ * not added with about the false positive rate the filter was sized for.
+ */
+class filter {
+public:
+    /**
+     * @brief An empty filter sized for `items` distinct items.
+     *
+     * @param false_positive_rate Target rate, between 0 and 1 exclusive.
+     */
+    explicit filter(size_t items = 0, double false_positive_rate = 0.01);
+
+    /**
+     * @brief Restore a filter from its bits and hash count.
+     *
+     * @throws std::invalid_argument If `words` is empty or `hashes` is zero.
+     */
+    filter(std::vector<uint64_t> words, uint32_t hashes);
+
+    void add(std::string_view item);
+    [[nodiscard]] bool may_contain(std::string_view item) const;
+
+    [[nodiscard]] const std::vector<uint64_t>& words() const;
+    [[nodiscard]] uint32_t hashes() const;
+
+private:
+    std::vector<uint64_t> bits;
+    uint32_t hash_count = 1;
+};
+
+/**
+ * @brief What a lookup searches for.
+ */
+enum class target : int {
+    key, ///< A member name of any object.
+    value ///< A scalar: a string with that text, or a number or literal
+          ///< written that way.
+};
+
+/**
+ * @brief A single lookup, e.g. the key `"name"` or the value `"Alice"`.
+ */
+struct needle {
+    target kind = target::key;
+    std::string text;
+};
+
+/**
+ * @brief Summarize a document: a filter of all its keys and scalar values.
+ */
+filter summarize(const json_lib::json& document);
+
+/**
+ * @brief Whether a document with this summary may contain `item`.
+ */
+bool may_match(const filter& summary, const needle& item);
+
+/**
+ * @brief Whether `document` contains `item`, checked exactly.
+ */
+bool matches(const json_lib::json& document, const needle& item);
+
+/**
+ * @brief Summaries of many files, persisted in one small catalog file.
+ *
+ * Entries are keyed by the absolute path of the file and remember its size
+ * and modification time; a summary is only returned while both still match,
+ * so modified files are parsed and summarized again. The catalog is not
+ * thread-safe.
+ *
+ * Layout, little-endian: `"JBLM"`, `u32` version, `u32` entry count, then
+ * per entry the `u32` length and bytes of the path, the `u64` size and
+ * `i64` modification time, the `u32` hash count, the `u32` word count and
+ * the `u64` words of the filter.
+ */
+class catalog {
+public:
+    /**
+     * @brief Load a catalog; a missing file yields an empty catalog.
+     *
+     * @throws std::runtime_error If the file is not a valid catalog.
+     */
+    static catalog read(const std::filesystem::path& path);
+
+    /**
+     * @brief Atomically replace `path` with the catalog.
+     *
+     * @throws std::invalid_argument If the file cannot be written.
+     */
+    void write(const std::filesystem::path& path) const;
+
+    /**
+     * @brief The summary of `file` if it was taken at `stamp`.
+     */
+    [[nodiscard]] const filter*
+    find(const std::filesystem::path& file, const index_lib::stamp& stamp)
+        const;
+
+    /**
+     * @brief Add or replace the summary of `file`, taken at `stamp`.
+     */
+    void record(
+        const std::filesystem::path& file, const index_lib::stamp& stamp,
+        filter summary
+    );
+
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Whether summaries were recorded since the catalog was read.
+     */
+    [[nodiscard]] bool modified() const;
+
+private:
+    struct entry {
+        index_lib::stamp stamp;
+        filter summary;
+    };
+
+    static std::string key_of(const std::filesystem::path& file);
+
+    std::map<std::string, entry> entries;
+    bool dirty = false;
+};
+}
+
+#endif // BLOOM_HPP
@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CATALOG_HPP
+#define CATALOG_HPP
+#include "json.hpp"
+
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace catalog_lib {
+/**
+ * @brief Counters of a `catalog` since construction.
+ */
+struct catalog_stats {
+    size_t hits = 0; ///< Lookups answered without parsing.
+    size_t loads = 0; ///< Documents read and parsed.
+    size_t evictions = 0; ///< Documents dropped to stay under the cap.
+};
+
+/**
+ * @brief Thread-safe map from file paths to parsed documents with a memory
+ * cap.
+ *
+ * Documents are parsed on first use and kept in least-recently-used order,
+ * each accounted with its `memory_usage()`. Whenever the total exceeds the
+ * cap, the least recently used documents are dropped. A document is
+ * reloaded when its file was modified since it was parsed.
+ *
+ * Dropping a document only releases the catalog's reference: results and
+ * documents already handed out stay valid.
+ */
+class catalog {
+public:
+    /**
+     * @param memory_limit Cap on the summed `memory_usage()` of all
+     * documents in bytes.
+     */
+    explicit catalog(size_t memory_limit);
+
+    /**
+     * @brief The parsed document of `path`, loading it if necessary.
+     *
+     * A document larger than the cap on its own is returned but not kept.
+     *
+     * @throws std::invalid_argument If the file cannot be opened.
+     * @throws std::runtime_error If the file is not valid JSON.
+     */
+    std::shared_ptr<json_lib::json> get(const std::filesystem::path& path);
+
+    [[nodiscard]] bool contains(const std::filesystem::path& path) const;
+
+    /**
+     * @brief Drop the document of `path`, if loaded.
+     */
+    void erase(const std::filesystem::path& path);
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t memory_usage() const;
+    [[nodiscard]] size_t memory_limit() const;
+    [[nodiscard]] catalog_stats stats() const;
+
+private:
+    struct entry {
+        std::string key;
+        std::shared_ptr<json_lib::json> document;
+        size_t memory = 0;
+        std::filesystem::file_time_type modified;
+    };
+
+    static std::string key_of(const std::filesystem::path& path);
+    void drop(std::list<entry>::iterator position);
+
+    size_t limit;
+    size_t used = 0;
+    catalog_stats counters;
+    std::list<entry> recent; ///< Most recently used first.
+    std::unordered_map<std::string, std::list<entry>::iterator> index;
+    mutable std::mutex mutex;
+};
+}
+
+#endif // CATALOG_HPP
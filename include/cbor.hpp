@@ -0,0 +1,52 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CBOR_HPP
+#define CBOR_HPP
+#include "json.hpp"
+
+#include <ostream>
+#include <string>
+
+namespace cbor_lib {
+/**
+ * @brief Stream a value to `os` as CBOR (RFC 8949).
+ *
+ * Uses the preferred serialization: the shortest head for every integer,
+ * length and count, and real numbers as single-precision floats where that
+ * is exact, double-precision otherwise. Output is produced while the tree
+ * is walked and handed to the stream in chunks, so no text is formatted
+ * and the whole encoding is never held in memory.
+ *
+ * @throws std::invalid_argument If the value contains references.
+ */
+void write(const json_lib::json& value, std::ostream& os);
+
+/**
+ * @brief Encode a value as CBOR into a string, as with `write`.
+ */
+std::string encode(const json_lib::json& value);
+}
+
+#endif // CBOR_HPP
@@ -0,0 +1,140 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CLI_HPP
+#define CLI_HPP
+#include "bloom.hpp"
+#include "governor.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cli_lib {
+/**
+ * @brief What `json_eval` prints instead of the result, if anything.
+ */
+enum class explain_mode : int {
+    none, ///< Print the result of the evaluation.
+    plan, ///< Print the compiled expression without evaluating it.
+    analyze ///< Evaluate and print the plan annotated with step counters.
+};
+
+/**
+ * @brief Encoding of a document or result.
+ */
+enum class data_format : int {
+    json, ///< JSON text.
+    msgpack, ///< MessagePack.
+    cbor ///< CBOR (RFC 8949), for output only.
+};
+
+/**
+ * @brief Command-line configuration of a single `json_eval` run.
+ */
+struct options {
+    std::filesystem::path input; ///< The JSON document to evaluate against.
+    std::vector<std::filesystem::path> inputs; ///< All inputs, `input` first.
+    std::string expression; ///< The expression to evaluate.
+    bool stats = false; ///< Report run statistics to stderr (`--stats`).
+    explain_mode explain = explain_mode::none; ///< `--explain[-analyze]`.
+    std::filesystem::path trace; ///< Chrome trace output file (`--trace`).
+    bool trace_elements = false; ///< Span per top-level element.
+    size_t bench = 0; ///< Repetitions of `--bench`; `0` runs once.
+    bool bench_parse = false; ///< Parse the document in every repetition.
+    std::string metrics; ///< Metrics file, or `unix:<socket>` (`--metrics`).
+    governor_lib::limits limits; ///< Budgets set by the `--max-*` options.
+    std::chrono::milliseconds timeout {}; ///< Deadline of the whole run.
+    std::string output_shm; ///< `fd:<n>` or path for `--output-shm`.
+    size_t parallel = 0; ///< Worker processes of `--parallel`; `0` is off.
+    size_t threads = 0; ///< Threads for multiple inputs; `0` is automatic.
+    size_t column_cache = 0; ///< Cap of `--column-cache`; `0` is off.
+    std::filesystem::path catalog; ///< Summary catalog of `--catalog`.
+    std::optional<bloom_lib::needle> find; ///< `--find-key`/`--find-value`.
+    std::filesystem::path compile; ///< Snapshot written by `--compile`.
+    size_t build_index = 0; ///< Depth of `--build-index`; `0` is off.
+    std::filesystem::path shred; ///< Column store written by `--shred`.
+    bool build_guide = false; ///< Write the dataguide (`--build-guide`).
+    bool infer_schema = false; ///< Print the schema (`--infer-schema`).
+    data_format input_format = data_format::json; ///< By flag or extension.
+    bool format_by_extension = true; ///< No `--input-format` was given.
+    data_format output_format = data_format::json; ///< `--output`.
+};
+
+/**
+ * @brief Parse a format name: `json`, `msgpack` or `cbor`.
+ *
+ * @throws std::invalid_argument For other names.
+ */
+data_format parse_format(const std::string& name);
+
+/**
+ * @brief Parse the command line of `json_eval`.
+ *
+ * Options may appear anywhere before, between or after the positional
+ * arguments: one or more `<json-file>`s (files, directories or patterns)
+ * followed by `"<expression>"`. Options taking a value expect it as the next
+ * argument. With `--compile`, the positional arguments are instead the
+ * input document and the snapshot to write; with `--build-index`, the input
+ * document alone, as with `--build-guide`; with `--find-key`,
+ * `--find-value` or `--infer-schema`, inputs only.
+ * Inputs named `*.msgpack` or `*.mpk` are read as MessagePack unless
+ * `--input-format` says otherwise; with several inputs, each file is
+ * decoded by its own name. `--parallel` and several inputs (or a
+ * directory or pattern) run outside the evaluation of a single document
+ * and cannot be combined with budgets, `--timeout`, `--metrics`,
+ * `--trace`, `--stats`, `--bench`, `--explain`, `--column-cache`,
+ * `--output-shm` or a binary `--output`, nor with each other.
+ *
+ * @param argc The argument count as passed to `main`.
+ * @param argv The argument vector as passed to `main`.
+ * @return The parsed options.
+ * @throws std::invalid_argument On unknown options or a wrong number of
+ * positional arguments.
+ */
+options parse_options(int argc, const char* const argv[]);
+
+/**
+ * @brief File descriptor named by an `--output-shm` target.
+ *
+ * @param target The value of `--output-shm`.
+ * @return The descriptor `<n>` of `fd:<n>`, or nothing if `target` is a
+ * path.
+ * @throws std::invalid_argument If `target` starts with `fd:` but the rest
+ * is not a non-negative integer that fits an `int`.
+ */
+std::optional<int> output_fd(std::string_view target);
+
+/**
+ * @brief Build the usage message printed on invalid command lines.
+ *
+ * @param program The program name, usually `argv[0]`.
+ * @return The usage text, ending with a newline.
+ */
+std::string usage(const std::string& program);
+}
+
+#endif // CLI_HPP
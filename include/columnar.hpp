@@ -0,0 +1,213 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef COLUMNAR_HPP
+#define COLUMNAR_HPP
+#include "json.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace columnar_lib {
+/**
+ * @brief Physical layout of a column.
+ */
+enum class column_type : uint8_t {
+    object, ///< Nested record; values live in the child columns.
+    null, ///< Only nulls or missing values.
+    boolean, ///< Bitmap.
+    integer, ///< `int32` vector.
+    real, ///< `double` vector, and dictionary codes of the literals.
+    string, ///< Dictionary codes.
+    list, ///< Arrays of scalars with Dremel repetition levels.
+    json ///< Anything else, as dictionary-encoded JSON text.
+};
+
+/**
+ * @brief Growable bit vector stored in 64-bit words.
+ */
+struct bitmap {
+    std::vector<uint64_t> words;
+    size_t length = 0;
+
+    void push_back(bool bit);
+    [[nodiscard]] bool operator[](size_t index) const;
+    [[nodiscard]] size_t size() const;
+};
+
+/**
+ * @brief Values of one field path across all records.
+ *
+ * Scalar columns hold one slot per record; list columns one slot per entry,
+ * where every record with a list contributes its elements, or a single
+ * placeholder for an empty list.
+ */
+struct column {
+    std::vector<std::string> path; ///< Keys from the record to the field.
+    column_type type = column_type::null;
+    column_type element = column_type::null; ///< Element type of lists.
+    bitmap present; ///< Per record: the field exists.
+    bitmap valid; ///< Per record: the field exists and is not null.
+
+    std::vector<int32_t> integers;
+    std::vector<double> reals;
+    bitmap booleans;
+    std::vector<uint32_t> codes; ///< Into `dictionary`; for objects, key
+                                 ///< orders as `u32` child positions.
+    std::vector<std::string> dictionary;
+
+    std::vector<uint8_t> repetition; ///< Lists: `0` starts a record's list.
+    std::vector<uint8_t> definition; ///< Lists: empty, null or a value.
+
+    std::vector<size_t> starts; ///< Lists: first entry per record, derived.
+    std::vector<size_t> children; ///< Objects: child columns, derived.
+};
+
+/**
+ * @brief An array of records shredded into columns.
+ *
+ * Every distinct key path of the records gets a column, nested objects
+ * included. A path whose values share one scalar type gets a typed column
+ * with validity bitmaps; arrays of scalars of one type become list columns;
+ * paths with mixed types keep their values as JSON text.
+ *
+ * Object columns keep the key order of every record, dictionary-encoded,
+ * so records are rebuilt as they were. Real columns keep the literal of
+ * every number, dictionary-encoded next to its `double` value, so `2.50`
+ * and `1e2` print back unchanged.
+ */
+class table {
+public:
+    /**
+     * @brief Shred the elements of `records` into columns.
+     *
+     * @throws std::invalid_argument If an element contains references.
+     */
+    static table shred(const json_lib::json_array& records);
+
+    /**
+     * @brief Load a column store written by `write`.
+     *
+     * @throws std::invalid_argument If the file cannot be opened.
+     * @throws std::runtime_error If it is not a valid column store.
+     */
+    static table read(const std::filesystem::path& path);
+
+    /**
+     * @brief Decode column store bytes, as with `read`.
+     */
+    static table decode(std::string_view bytes);
+
+    /**
+     * @brief Serialize the table: `"JCOL"`, `u32` version, `u64` record
+     * count and `u32` column count, then per column its path, types,
+     * bitmaps and value vectors, all little-endian.
+     */
+    [[nodiscard]] std::string encode() const;
+
+    void write(const std::filesystem::path& path) const;
+
+    [[nodiscard]] size_t rows() const;
+    [[nodiscard]] const std::vector<column>& columns() const;
+
+    /**
+     * @brief Column of a key path, or `nullptr` if no record has it.
+     */
+    [[nodiscard]] const column* find(const std::vector<std::string>& path
+    ) const;
+
+    /**
+     * @brief Rebuild the record at `row`.
+     */
+    [[nodiscard]] std::shared_ptr<json_lib::json> record(size_t row) const;
+
+    /**
+     * @brief Rebuild all records as an array.
+     */
+    [[nodiscard]] std::shared_ptr<json_lib::json> materialize() const;
+
+    /**
+     * @brief Value at `path` of the record at `row`, read from the columns
+     * of that path only.
+     *
+     * Accessors are keys, or indices into arrays. Where the columns cannot
+     * answer directly, the enclosing value is rebuilt and the rest of the
+     * path applied to it, so errors match those of the row-wise tree.
+     */
+    [[nodiscard]] std::shared_ptr<json_lib::json> value(
+        size_t row, const std::vector<std::shared_ptr<json_lib::json>>& path
+    ) const;
+
+    /**
+     * @brief Values of the field at `path` in every record that has it.
+     */
+    [[nodiscard]] std::shared_ptr<json_lib::json_array>
+    project(const std::vector<std::string>& path) const;
+
+    /**
+     * @brief Minimum or maximum of an integer field over all records that
+     * have it, computed on the typed vector.
+     *
+     * @return Nothing if the column is not an integer column, holds nulls,
+     * or is empty, i.e. whenever the tree would have to decide.
+     */
+    [[nodiscard]] std::optional<int>
+    extreme(const std::vector<std::string>& path, bool maximum) const;
+
+private:
+    size_t row_count = 0;
+    std::vector<column> data;
+
+    void link();
+    std::shared_ptr<json_lib::json>
+    rebuild(const column& source, size_t row) const;
+};
+
+/**
+ * @brief Whether the file at `path` starts with the column store magic.
+ */
+bool is_table(const std::filesystem::path& path);
+
+/**
+ * @brief Evaluate a compiled expression against a shredded array, which
+ * takes the place of the document root.
+ *
+ * `size($)`, constant paths into single records (`$[i].a.b`) and function
+ * calls, arrays and objects built from them read only the columns they
+ * name. Any other expression runs on the rebuilt array.
+ *
+ * @param data The table to query.
+ * @param expression The compiled expression; consumed by the evaluation.
+ * @return The result of the evaluation.
+ */
+std::shared_ptr<json_lib::json> evaluate(
+    const table& data, const std::shared_ptr<json_lib::json>& expression
+);
+}
+
+#endif // COLUMNAR_HPP
@@ -0,0 +1,147 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DATAGUIDE_HPP
+#define DATAGUIDE_HPP
+#include "index.hpp"
+#include "json.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace dataguide_lib {
+/**
+ * @brief Number of value types a dataguide tells apart: `null_json` to
+ * `object_json`.
+ */
+constexpr size_t type_count = 7;
+
+/**
+ * @brief What the document holds at one path.
+ */
+struct path_stats {
+    uint64_t count = 0; ///< Values at the path.
+    std::array<uint64_t, type_count> types {}; ///< Values per `json_type`.
+    double min_number = 0; ///< Least integer or real value, if any.
+    double max_number = 0; ///< Greatest integer or real value, if any.
+    uint64_t min_size = 0; ///< Fewest elements or members of a container.
+    uint64_t max_size = 0; ///< Most elements or members of a container.
+
+    /**
+     * @brief Number of values of type `type` at the path.
+     */
+    [[nodiscard]] uint64_t of(json_lib::json_type type) const;
+
+    /**
+     * @brief Whether all values at the path have type `type`.
+     */
+    [[nodiscard]] bool only(json_lib::json_type type) const;
+};
+
+/**
+ * @brief Summary of the structure of a document: every distinct path, with
+ * array positions collapsed into `[*]`, and statistics of its values.
+ *
+ * Paths are spelled the way the evaluator prints them, e.g. `$` for the
+ * root and `$["items"][*]["rating"]` for the ratings of all items.
+ */
+class dataguide {
+public:
+    /**
+     * @brief Summarize `document` in a single pass.
+     */
+    static dataguide build(const json_lib::json& document);
+
+    /**
+     * @brief Load a dataguide written by `write()`.
+     *
+     * @throws std::invalid_argument If the file cannot be opened.
+     * @throws std::runtime_error If it is not a valid dataguide.
+     */
+    static dataguide read(const std::filesystem::path& path);
+
+    /**
+     * @throws std::runtime_error If the bytes are not a valid dataguide.
+     */
+    static dataguide decode(std::string_view bytes);
+
+    /**
+     * @brief Serialize the dataguide: `"JDGD"`, `u32` version, the source
+     * stamp (`u64` size, `i64` modification time), `u32` path count, then
+     * per path the `u32` length and bytes of its text, the `u64` count, the
+     * `u64` type histogram, the `f64` minimum and maximum number and the
+     * `u64` minimum and maximum size, all little-endian.
+     */
+    [[nodiscard]] std::string encode() const;
+    void write(const std::filesystem::path& path) const;
+
+    [[nodiscard]] const path_stats* find(const std::string& path) const;
+    [[nodiscard]] const std::map<std::string, path_stats>& paths() const;
+
+    [[nodiscard]] index_lib::stamp source() const;
+    void set_source(const index_lib::stamp& stamp);
+
+private:
+    index_lib::stamp stamp;
+    std::map<std::string, path_stats> entries;
+};
+
+/**
+ * @brief Path of the dataguide stored with `input`: `<input>.guide`.
+ */
+std::filesystem::path sidecar_path(const std::filesystem::path& input);
+
+/**
+ * @brief Parse the JSON file at `input` and write its dataguide sidecar.
+ */
+void build(const std::filesystem::path& input);
+
+/**
+ * @brief Reject an expression whose constant paths cannot exist.
+ *
+ * A path is only rejected where the dataguide proves that evaluating it
+ * throws, so the exception is the one evaluation would raise.
+ *
+ * @throws std::out_of_range If a key or index is certainly missing.
+ * @throws std::invalid_argument If a step certainly meets a value of the
+ * wrong type.
+ */
+void check(const dataguide& guide, const json_lib::json& expression);
+
+/**
+ * @brief Answer `size()`, `min()` or `max()` of a constant path, or of a
+ * `[*]` projection of keys, from the dataguide alone.
+ *
+ * @return The result, or `nullptr` if the dataguide cannot tell it.
+ */
+std::shared_ptr<json_lib::json> answer(
+    const dataguide& guide, const std::shared_ptr<json_lib::json>& expression
+);
+}
+
+#endif // DATAGUIDE_HPP
@@ -0,0 +1,131 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+#include "json.hpp"
+#include "metrics.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace executor_lib {
+/**
+ * @brief Scheduling lane of a query, chosen from its compiled expression.
+ */
+enum class lane : int {
+    cheap, ///< Constant paths and `size()`: a bounded number of steps.
+    expensive ///< Aggregates, unions and subscripts: may visit many nodes.
+};
+
+inline constexpr size_t lane_count = static_cast<size_t>(lane::expensive) + 1;
+
+/**
+ * @brief Estimate the cost of a compiled expression.
+ *
+ * An expression is cheap if every path in it consists of constant keys and
+ * indices only and the only function it calls is `size()`.
+ *
+ * @param expression The compiled (not yet evaluated) expression.
+ * @return The lane the expression should be scheduled on.
+ */
+lane classify(const json_lib::json& expression);
+
+/**
+ * @brief Query executor that keeps point lookups responsive under mixed
+ * load.
+ *
+ * A fixed pool of workers evaluates queries against one parsed document.
+ * Workers always take cheap queries first; expensive ones run only while
+ * fewer than `expensive_slots` of them are in flight, so full scans cannot
+ * occupy every worker. The time each query waits for a worker is recorded
+ * per lane, and also into the `metrics_lib::active_registry` if one is set.
+ *
+ * The document is only read by the workers and must not be modified while
+ * the executor is alive.
+ */
+class executor {
+public:
+    /**
+     * @param document The parsed document all queries run against.
+     * @param threads Number of workers; `0` uses the hardware concurrency.
+     * @param expensive_slots Expensive queries allowed to run at once.
+     */
+    explicit executor(
+        std::shared_ptr<json_lib::json> document, size_t threads = 0,
+        size_t expensive_slots = 1
+    );
+
+    /**
+     * @brief Finish all queued queries and stop the workers.
+     */
+    ~executor();
+
+    executor(const executor&) = delete;
+    executor& operator=(const executor&) = delete;
+
+    /**
+     * @brief Compile a query on the calling thread and queue it on its lane.
+     *
+     * @param expression The expression to evaluate.
+     * @return A future holding the result or the evaluation error.
+     * @throws std::runtime_error If the expression cannot be parsed.
+     */
+    std::future<std::shared_ptr<json_lib::json>>
+    submit(std::string expression);
+
+    [[nodiscard]] const metrics_lib::histogram& queue_latency(lane type
+    ) const;
+
+    [[nodiscard]] size_t threads() const;
+
+private:
+    struct task {
+        std::shared_ptr<json_lib::json> expression;
+        std::promise<std::shared_ptr<json_lib::json>> result;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    void run();
+
+    std::shared_ptr<json_lib::json> document;
+    size_t expensive_slots;
+    std::array<metrics_lib::histogram, lane_count> latencies;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::array<std::deque<task>, lane_count> queues;
+    size_t running_expensive = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
+}
+
+#endif // EXECUTOR_HPP
@@ -0,0 +1,72 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EXPLAIN_HPP
+#define EXPLAIN_HPP
+#include "reference.hpp"
+
+namespace explain_lib {
+/**
+ * @brief One node of the printable plan of a compiled expression.
+ *
+ * `step` is the node of the compiled expression the plan node stands for.
+ * It identifies the step in an `evaluation_profile` and keeps the node alive
+ * while the expression itself is consumed by the evaluation.
+ */
+struct plan_node {
+    std::string label;
+    std::shared_ptr<const json_lib::json> step = nullptr;
+    std::vector<plan_node> children {};
+};
+
+/**
+ * @brief Describe a compiled expression as a tree of plan nodes.
+ *
+ * Must be called before the expression is evaluated, since evaluation
+ * rewrites the expression in place. Paths are listed step by step, unions
+ * from `json_set` with one branch per alternative, function calls with their
+ * arguments, and values folded at compile time as constants.
+ *
+ * @param expression The expression produced by a dynamic parse.
+ * @return The root of the plan.
+ */
+plan_node build_plan(const std::shared_ptr<json_lib::json>& expression);
+
+/**
+ * @brief Render a plan as indented text, one node per line.
+ *
+ * When a profile is given, every executable node is annotated with its
+ * counters, or marked as never executed.
+ *
+ * @param plan The plan to render.
+ * @param profile The profile of an evaluation of the planned expression.
+ * @return The rendered plan, ending with a newline.
+ */
+std::string render(
+    const plan_node& plan,
+    const reference_lib::evaluation_profile* profile = nullptr
+);
+}
+
+#endif // EXPLAIN_HPP
@@ -0,0 +1,120 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FILES_HPP
+#define FILES_HPP
+#include "bloom.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace files_lib {
+/**
+ * @brief How the files of a multi-file run are decoded.
+ */
+enum class file_format : int {
+    by_extension, ///< MessagePack for `*.msgpack` and `*.mpk`, JSON else.
+    json, ///< JSON text, whatever the file name.
+    msgpack ///< MessagePack, whatever the file name.
+};
+
+/**
+ * @brief Match a file name against a pattern with `*` (any run of
+ * characters) and `?` (any single character).
+ */
+bool glob_match(std::string_view pattern, std::string_view name);
+
+/**
+ * @brief Whether an input names more than one file: a directory or a path
+ * whose file name contains `*` or `?`.
+ */
+bool is_collection(const std::filesystem::path& input);
+
+/**
+ * @brief Expand inputs into the list of files to evaluate.
+ *
+ * Directories contribute every `*.json` file below them, patterns every
+ * matching file of their directory, both sorted by path. Other inputs are
+ * kept as they are, so missing files are reported when they are read.
+ *
+ * @param inputs Files, directories and patterns, in order.
+ * @return The files in input order.
+ */
+std::vector<std::filesystem::path>
+expand(const std::vector<std::filesystem::path>& inputs);
+
+/**
+ * @brief Evaluate `expression` against each file on a pool of threads and
+ * print `filename<TAB>result` lines in the order of `files`.
+ *
+ * Files are handed out one at a time to `threads` workers, each of which
+ * reuses its read buffer between files. A file that fails to read, parse
+ * or evaluate is reported on stderr and skipped.
+ *
+ * @param threads Number of workers; `0` uses the hardware concurrency.
+ * @param summaries If set, receives the summary of every parsed file.
+ * @param format How each file is decoded.
+ * @return The number of files that failed.
+ */
+size_t evaluate_files(
+    const std::vector<std::filesystem::path>& files,
+    const std::string& expression, size_t threads, std::ostream& out,
+    bloom_lib::catalog* summaries = nullptr,
+    file_format format = file_format::by_extension
+);
+
+/**
+ * @brief Counters of a `find_files()` run.
+ */
+struct lookup_stats {
+    size_t skipped = 0; ///< Files ruled out by their summary, not opened.
+    size_t parsed = 0; ///< Files read and parsed.
+    size_t matched = 0; ///< Files that contain the item.
+    size_t failed = 0; ///< Files that could not be read or parsed.
+};
+
+/**
+ * @brief Print the path of every file that contains `item`, in the order
+ * of `files`.
+ *
+ * Files whose summary in `summaries` is current and rules the item out are
+ * skipped without opening them. All others are parsed and checked exactly;
+ * files without a current summary get one recorded in `summaries`.
+ *
+ * @param threads Number of workers; `0` uses the hardware concurrency.
+ * @param format How each file is decoded.
+ */
+lookup_stats find_files(
+    const std::vector<std::filesystem::path>& files,
+    const bloom_lib::needle& item, bloom_lib::catalog& summaries,
+    size_t threads, std::ostream& out,
+    file_format format = file_format::by_extension
+);
+}
+
+#endif // FILES_HPP
@@ -0,0 +1,206 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GOVERNOR_HPP
+#define GOVERNOR_HPP
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace governor_lib {
+/**
+ * @brief Resource budgets enforced while parsing and evaluating.
+ *
+ * A value of zero leaves the corresponding resource unlimited.
+ */
+struct limits {
+    size_t max_input_bytes = 0; ///< Bytes of a single input text.
+    size_t max_depth = 0; ///< Nesting depth of arrays and objects.
+    size_t max_nodes = 0; ///< Values of a single parsed text.
+    size_t max_memory = 0; ///< `memory_usage()` of a parsed document.
+    size_t max_steps = 0; ///< Evaluation steps of a single query.
+    std::chrono::milliseconds max_time {}; ///< Wall time of a single query.
+
+    /**
+     * @brief Whether no budget is set at all.
+     */
+    [[nodiscard]] bool unlimited() const;
+};
+
+/**
+ * @brief Thrown as soon as an input or a query exceeds one of the `limits`.
+ */
+class limit_exceeded : public std::runtime_error {
+public:
+    /**
+     * @param resource The name of the exceeded limit, e.g. `"max_depth"`.
+     * @param limit The configured value of that limit.
+     */
+    limit_exceeded(const std::string& resource, size_t limit);
+
+    [[nodiscard]] const std::string& resource() const;
+    [[nodiscard]] size_t limit() const;
+
+private:
+    std::string name;
+    size_t value;
+};
+
+/**
+ * @brief Limits that the parser and evaluator enforce, process-wide.
+ *
+ * Unlike `active_token`, this is shared by all threads: install it once,
+ * before starting the threads that parse or evaluate, and clear it only
+ * after they have finished. Readers load the pointer once per check, so a
+ * concurrent change is never observed half-way. Governing is off while this
+ * is `nullptr`, which costs a single branch per parsed value or evaluated
+ * step.
+ */
+inline std::atomic<const limits*> active_limits { nullptr };
+
+/**
+ * @brief Throw `limit_exceeded` if `value` exceeds a non-zero `limit`.
+ *
+ * @param resource The name of the limit, used in the error message.
+ * @param value The amount used so far.
+ * @param limit The budget, where `0` means unlimited.
+ */
+void check(const char* resource, size_t value, size_t limit);
+
+/**
+ * @brief Step and time budget of one query, installed for the current
+ * thread while in scope.
+ *
+ * Does nothing unless `active_limits` sets `max_steps` or `max_time`.
+ */
+class query_budget {
+public:
+    query_budget();
+    ~query_budget();
+
+    query_budget(const query_budget&) = delete;
+    query_budget& operator=(const query_budget&) = delete;
+
+    /**
+     * @brief Charge `count` evaluation steps to the budget of the current
+     * thread, if any.
+     *
+     * The clock is only read every 64 steps to keep the check cheap.
+     *
+     * @throws limit_exceeded If the step or time budget is used up.
+     */
+    static void charge(size_t count = 1);
+
+private:
+    void take(size_t count);
+
+    const limits* budget; ///< `active_limits` when the query started.
+    query_budget* previous = nullptr;
+    size_t steps = 0;
+    size_t next_clock_check = 0;
+    std::chrono::steady_clock::time_point deadline {};
+};
+
+/**
+ * @brief Thrown at the next checkpoint after a `cancellation_token` was
+ * cancelled or its deadline passed.
+ */
+class operation_cancelled : public std::runtime_error {
+public:
+    explicit operation_cancelled(bool deadline);
+
+    /**
+     * @brief Whether the deadline passed, as opposed to an explicit
+     * `cancel()`.
+     */
+    [[nodiscard]] bool deadline_exceeded() const;
+
+private:
+    bool deadline;
+};
+
+/**
+ * @brief Cooperative cancellation of an in-flight parse or evaluation.
+ *
+ * The token is shared between the caller and the worker: any thread may
+ * `cancel()` it or move its deadline, while the worker polls it at
+ * checkpoints of the parser and evaluator once installed with a
+ * `token_scope`.
+ */
+class cancellation_token {
+public:
+    void cancel();
+    [[nodiscard]] bool cancelled() const;
+
+    void set_deadline(std::chrono::steady_clock::time_point deadline);
+    void cancel_after(std::chrono::nanoseconds timeout);
+
+    /**
+     * @throws operation_cancelled If the token was cancelled or the deadline
+     * passed.
+     */
+    void throw_if_expired() const;
+
+private:
+    std::atomic<bool> flag { false };
+    std::atomic<std::chrono::steady_clock::rep> deadline_ticks { 0 };
+};
+
+/**
+ * @brief Token that `poll()` on the current thread checks.
+ *
+ * Cancellation is off while this is `nullptr`, which costs a single branch
+ * per checkpoint.
+ */
+inline thread_local const cancellation_token* active_token = nullptr;
+
+/**
+ * @brief Install a token for the current thread while in scope.
+ */
+class token_scope {
+public:
+    explicit token_scope(const cancellation_token& token);
+    ~token_scope();
+
+    token_scope(const token_scope&) = delete;
+    token_scope& operator=(const token_scope&) = delete;
+
+private:
+    const cancellation_token* previous;
+};
+
+/**
+ * @brief Checkpoint of the parser (per value) and evaluator (per step or
+ * aggregated element).
+ *
+ * The cancel flag is read at every call, the clock only every 64 calls.
+ *
+ * @throws operation_cancelled If the active token expired.
+ */
+void poll();
+}
+
+#endif // GOVERNOR_HPP
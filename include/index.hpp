@@ -0,0 +1,192 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INDEX_HPP
+#define INDEX_HPP
+#include "json.hpp"
+#include "transport.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace index_lib {
+/**
+ * @brief Size and modification time of an indexed file, used to detect
+ * stale indexes.
+ */
+struct stamp {
+    uint64_t size = 0;
+    int64_t modified = 0; ///< Modification time in file clock ticks.
+
+    /**
+     * @brief Stamp of the file at `path`.
+     *
+     * @throws std::filesystem::filesystem_error If the file does not exist.
+     */
+    static stamp of(const std::filesystem::path& path);
+
+    bool operator==(const stamp&) const = default;
+};
+
+/**
+ * @brief Byte range of a value in the indexed text.
+ */
+struct span {
+    uint64_t begin = 0;
+    uint64_t end = 0; ///< One past the last byte of the value.
+    uint64_t record = 0; ///< Offset of its container record, `0` if none.
+};
+
+/**
+ * @brief Build the structural index of a JSON text.
+ *
+ * Containers up to `max_depth` levels deep (the root being level 1) get a
+ * record of the byte ranges of their elements or members, so a path through
+ * them can be followed without parsing. Layout, with all integers
+ * little-endian:
+ *
+ * - header: `"JIDX"`, `u32` version, the `u64` size and `i64` modification
+ *   time of the source, `u32` max depth, `u32` reserved, and the root span
+ *   (`u64` begin, end and record offset);
+ * - records: a `u8` kind (`[` or `{`) and a `u32` count, followed by one
+ *   `(u64 begin, u64 end, u64 record)` entry per element, or for objects one
+ *   `(u64 key offset, u64 begin, u64 end, u64 record)` entry per member,
+ *   sorted by key. Keys are stored unescaped as a `u32` length and the
+ *   bytes, ahead of the record.
+ *
+ * @param text The JSON text to index.
+ * @param max_depth Number of container levels to index.
+ * @param source Stamp of the file the text was read from.
+ * @return The index bytes.
+ * @throws std::runtime_error If the text is not well-formed.
+ * @throws std::invalid_argument If an indexed object repeats a key.
+ */
+std::string encode(std::string_view text, size_t max_depth, stamp source = {});
+
+/**
+ * @brief Path of the sidecar index of `input`: `<input>.idx`.
+ */
+std::filesystem::path sidecar_path(const std::filesystem::path& input);
+
+/**
+ * @brief Index the file at `input` and write its sidecar.
+ */
+void build(const std::filesystem::path& input, size_t max_depth);
+
+/**
+ * @brief Read-only view of a structural index, either mapped from a file
+ * or over caller-owned bytes.
+ *
+ * Every offset read is checked against the index size.
+ */
+class structural_index {
+public:
+    /**
+     * @brief Map the index file at `path`.
+     *
+     * @throws std::invalid_argument If the file cannot be opened.
+     * @throws std::runtime_error If it is not a valid index.
+     */
+    explicit structural_index(const std::filesystem::path& path);
+
+    /**
+     * @brief View index bytes that outlive the `structural_index`.
+     *
+     * @throws std::runtime_error If the bytes are not a valid index.
+     */
+    explicit structural_index(const std::string& bytes);
+    explicit structural_index(std::string&& bytes) = delete;
+
+    [[nodiscard]] stamp source() const;
+    [[nodiscard]] size_t max_depth() const;
+    [[nodiscard]] span root() const;
+
+    /**
+     * @brief Type of an indexed container: array or object. Values without
+     * a record are reported as `null_json`.
+     */
+    [[nodiscard]] json_lib::json_type type(const span& value) const;
+
+    /**
+     * @brief Number of elements or members of an indexed container.
+     */
+    [[nodiscard]] size_t size(const span& value) const;
+
+    /**
+     * @brief Element `index` of an indexed array.
+     *
+     * @return The element, or nothing if `value` is no indexed array or the
+     * index is out of range.
+     */
+    [[nodiscard]] std::optional<span>
+    element(const span& value, size_t index) const;
+
+    /**
+     * @brief Member `key` of an indexed object, found by binary search.
+     *
+     * @return The member, or nothing if `value` is no indexed object or has
+     * no such key.
+     */
+    [[nodiscard]] std::optional<span>
+    member(const span& value, std::string_view key) const;
+
+private:
+    void validate();
+    uint8_t read_u8(uint64_t offset) const;
+    uint32_t read_u32(uint64_t offset) const;
+    uint64_t read_u64(uint64_t offset) const;
+    span read_span(uint64_t offset) const;
+
+    std::unique_ptr<transport_lib::mapped_segment> mapping;
+    std::string_view data;
+};
+
+/**
+ * @brief Evaluate a compiled expression against an indexed text.
+ *
+ * Constant paths (`$` followed by keys and indices), and function calls,
+ * arrays and objects built from them, follow the index as deep as it goes
+ * and parse only the subtree found there. Any other expression falls back
+ * to parsing the whole text.
+ *
+ * For well-formed input the result, and any error raised by the remaining
+ * accessors, match those of a full parse. Text outside the parsed subtree
+ * is not validated, so malformed JSON elsewhere in `text` goes unreported.
+ *
+ * @param index The index of `text`.
+ * @param text The indexed JSON text.
+ * @param expression The compiled expression; consumed by the evaluation.
+ * @return The result of the evaluation.
+ */
+std::shared_ptr<json_lib::json> evaluate(
+    const structural_index& index, std::string_view text,
+    const std::shared_ptr<json_lib::json>& expression
+);
+}
+
+#endif // INDEX_HPP
@@ -28,6 +28,7 @@
 #include <source_location>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace json_lib {
@@ -284,8 +285,37 @@ public:
     [[nodiscard]] virtual std::shared_ptr<json>
     by(const std::shared_ptr<json>& item) const;
 
+    /**
+     * @brief Estimate the heap memory held by the JSON element and its
+     * descendants.
+     *
+     * Accounts for the node objects themselves, their `make_shared` control
+     * blocks, the capacity (not just the size) of vectors and strings, and
+     * the buckets and nodes of the key index of objects. Containers shared
+     * between several parents are counted once, so looped structures are
+     * safe to measure.
+     *
+     * @return The estimated footprint in bytes.
+     */
+    [[nodiscard]] size_t memory_usage() const;
+
+    /**
+     * @brief Accumulate the footprint of the element, skipping containers
+     * that were already counted.
+     *
+     * This is the recursive step behind `memory_usage()`; subclasses that own
+     * heap memory or children override it.
+     *
+     * @param counted Containers already accounted for.
+     * @return The footprint in bytes not yet included in `counted`.
+     */
+    virtual size_t footprint(std::unordered_set<const json*>& counted) const;
+
 protected:
     json_type _type = json_type::null_json; ///< The type of the JSON object.
+
+    static size_t node_size(size_t object_size);
+    static size_t heap_size(const std::string& str);
 };
 
 /**
@@ -320,6 +350,12 @@ public:
     std::string
     indented_string(size_t indent_level, bool pretty) const override;
 
+    /**
+     * @brief Returns the boolean value represented by this JSON element.
+     */
+    [[nodiscard]] bool as_bool() const;
+    size_t footprint(std::unordered_set<const json*>& counted) const override;
+
 private:
     bool value; ///< The boolean value represented by this JSON element.
 };
@@ -332,6 +368,7 @@ public:
     [[nodiscard]] int as_index() const;
     [[nodiscard]] std::shared_ptr<json> by(const std::shared_ptr<json>& item
     ) const override;
+    size_t footprint(std::unordered_set<const json*>& counted) const override;
 
 private:
     int value;
@@ -343,6 +380,7 @@ public:
     explicit json_real(const std::string& str_value);
     std::string
     indented_string(size_t indent_level, bool pretty) const override;
+    size_t footprint(std::unordered_set<const json*>& counted) const override;
 
 private:
     float value;
@@ -355,8 +393,10 @@ public:
     std::string
     indented_string(size_t indent_level, bool pretty) const override;
     [[nodiscard]] std::string as_key() const;
+    [[nodiscard]] size_t size() const;
     [[nodiscard]] std::shared_ptr<json> by(const std::shared_ptr<json>& item
     ) const override;
+    size_t footprint(std::unordered_set<const json*>& counted) const override;
 
 private:
     std::string value;
@@ -372,9 +412,11 @@ public:
     std::string
     indented_string(size_t indent_level, bool pretty) const override;
     [[nodiscard]] size_t size() const;
+    [[nodiscard]] const std::vector<std::shared_ptr<json>>& items() const;
     [[nodiscard]] std::shared_ptr<json> at(int index) const;
     [[nodiscard]] std::shared_ptr<json> by(const std::shared_ptr<json>& item
     ) const override;
+    size_t footprint(std::unordered_set<const json*>& counted) const override;
 
 private:
     bool looped { false };
@@ -400,9 +442,13 @@ public:
     indented_string(size_t indent_level, bool pretty) const override;
     [[nodiscard]] size_t size() const;
     [[nodiscard]] std::vector<std::string> get_keys();
+    [[nodiscard]] const std::vector<
+        std::pair<std::string, std::shared_ptr<json>>>&
+    items() const;
     [[nodiscard]] std::shared_ptr<json> at(const std::string& key) const;
     [[nodiscard]] std::shared_ptr<json> by(const std::shared_ptr<json>& item
     ) const override;
+    size_t footprint(std::unordered_set<const json*>& counted) const override;
 
 private:
     bool looped { false };
@@ -0,0 +1,162 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace metrics_lib {
+/**
+ * @brief Lock-free monotonic counter.
+ */
+class counter {
+public:
+    void add(uint64_t amount = 1);
+    [[nodiscard]] uint64_t value() const;
+
+private:
+    std::atomic<uint64_t> total { 0 };
+};
+
+/**
+ * @brief Lock-free latency histogram with HdrHistogram-style buckets.
+ *
+ * Values (nanoseconds) are grouped into power-of-two ranges, each split into
+ * 16 linear sub-buckets, so any recorded value is reproduced within about 6%
+ * from 1 ns up to the full 64-bit range. Recording is a handful of relaxed
+ * atomic additions.
+ */
+class histogram {
+public:
+    static constexpr size_t sub_bucket_bits = 5;
+    static constexpr size_t sub_bucket_count = size_t { 1 } << sub_bucket_bits;
+    static constexpr size_t sub_bucket_half = sub_bucket_count / 2;
+    static constexpr size_t bucket_count
+        = (64 - sub_bucket_bits + 2) * sub_bucket_half;
+
+    void record(std::chrono::nanoseconds latency);
+
+    [[nodiscard]] uint64_t count() const;
+    [[nodiscard]] std::chrono::nanoseconds sum() const;
+
+    /**
+     * @brief Number of recorded values not greater than `limit`.
+     *
+     * Counts whole buckets, i.e. values that may exceed `limit` by at most
+     * the bucket resolution are not included.
+     */
+    [[nodiscard]] uint64_t count_below(std::chrono::nanoseconds limit) const;
+
+    /**
+     * @brief Value at the given percentile (0 to 100) of the recorded data.
+     *
+     * @return The highest value equivalent to the bucket holding the
+     * percentile, or zero for an empty histogram.
+     */
+    [[nodiscard]] std::chrono::nanoseconds percentile(double percent) const;
+
+    static size_t index_of(uint64_t value);
+    static uint64_t lowest_of(size_t index);
+    static uint64_t highest_of(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, bucket_count> buckets {};
+    std::atomic<uint64_t> total { 0 };
+    std::atomic<uint64_t> total_ns { 0 };
+};
+
+/**
+ * @brief All metrics an embedding of the engine exports.
+ */
+struct registry {
+    histogram parse; ///< Latency of parsing JSON documents.
+    histogram compile; ///< Latency of parsing expressions.
+    histogram evaluate; ///< Latency of evaluating expressions.
+    histogram cheap_queue; ///< Queueing delay of cheap executor queries.
+    histogram expensive_queue; ///< Queueing delay of expensive ones.
+    counter cache_hits; ///< Lookups answered from a cache.
+    counter documents_loaded; ///< JSON documents parsed successfully.
+    counter bytes_parsed; ///< Input bytes of those documents.
+    counter errors; ///< Failed parses and evaluations.
+
+    /**
+     * @brief Render all metrics in the Prometheus text exposition format.
+     *
+     * Latencies are exported as histograms in seconds with `le` bounds from
+     * 1 microsecond to 10 seconds.
+     *
+     * @return The exposition text, ending with a newline.
+     */
+    [[nodiscard]] std::string render() const;
+
+    /**
+     * @brief Atomically replace `path` with the rendered metrics.
+     *
+     * Suitable for the node exporter's textfile collector.
+     */
+    void write_file(const std::filesystem::path& path) const;
+
+    /**
+     * @brief Send the rendered metrics to a local (UNIX domain) socket.
+     *
+     * @throws std::runtime_error If the socket cannot be reached or local
+     * sockets are not available on the platform.
+     */
+    void write_socket(const std::filesystem::path& path) const;
+};
+
+/**
+ * @brief Registry that the parser and evaluator report to.
+ *
+ * Metrics are off while this is `nullptr`, which costs a single branch per
+ * parse or evaluation.
+ */
+inline registry* active_registry = nullptr;
+
+/**
+ * @brief Records the lifetime of the scope into a histogram of the active
+ * registry, or counts an error if the scope is left by an exception.
+ */
+class timer {
+public:
+    explicit timer(histogram registry::* target);
+    ~timer();
+
+    timer(const timer&) = delete;
+    timer& operator=(const timer&) = delete;
+
+private:
+    registry* owner;
+    histogram registry::* target;
+    int exceptions = 0;
+    std::chrono::steady_clock::time_point start {};
+};
+}
+
+#endif // METRICS_HPP
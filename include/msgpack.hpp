@@ -0,0 +1,69 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MSGPACK_HPP
+#define MSGPACK_HPP
+#include "json.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace msgpack_lib {
+/**
+ * @brief Build the `json` tree of a MessagePack document.
+ *
+ * Produces the same tree as parsing the equivalent JSON text: integers
+ * become `json_integer`, floats become `json_real` with their shortest
+ * round-trip text, and maps become objects. The parser's limits and metrics
+ * apply as for text input.
+ *
+ * @param bytes Exactly one MessagePack value.
+ * @return The decoded document.
+ * @throws std::runtime_error If the bytes are truncated, have trailing
+ * data, or use types without a JSON equivalent (binary, extensions,
+ * non-string map keys, non-finite floats).
+ * @throws std::out_of_range If an integer does not fit into an `int`, as
+ * for JSON text.
+ * @throws std::invalid_argument If a map repeats a key.
+ */
+std::shared_ptr<json_lib::json> decode(std::string_view bytes);
+
+/**
+ * @brief Encode a value as MessagePack, using the smallest representation
+ * of every integer, length and count. Real numbers are written as 64-bit
+ * floats.
+ *
+ * @throws std::invalid_argument If the value contains references.
+ */
+std::string encode(const json_lib::json& value);
+
+/**
+ * @brief Whether `path` has a MessagePack extension: `.msgpack` or `.mpk`.
+ */
+bool has_extension(const std::filesystem::path& path);
+}
+
+#endif // MSGPACK_HPP
@@ -0,0 +1,109 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace parallel_lib {
+/**
+ * @brief How an input is divided into independently evaluated records.
+ */
+enum class input_layout : int {
+    single, ///< One document that is not an array: a single record.
+    lines, ///< Newline-delimited JSON: every non-blank line is a record.
+    array ///< One top-level array: every element is a record.
+};
+
+/**
+ * @brief Byte ranges of an input, each holding whole records only.
+ *
+ * For `array` the ranges cover the elements between the brackets and do not
+ * include the separating commas.
+ */
+struct partition {
+    input_layout layout = input_layout::single;
+    std::vector<std::pair<size_t, size_t>> ranges; ///< `[begin, end)` pairs.
+};
+
+/**
+ * @brief Detect the layout of `text` and split it into at most `parts`
+ * ranges of roughly equal size.
+ *
+ * Lines are split at newlines and arrays after top-level commas, found with
+ * a single pass that tracks nesting and strings without building values.
+ *
+ * @throws std::runtime_error If the first value is not terminated.
+ */
+partition split(std::string_view text, size_t parts);
+
+/**
+ * @brief Evaluate `expression` against every record of one range.
+ *
+ * @return The serialized result of each record, one per line.
+ */
+std::string evaluate_range(
+    std::string_view text, input_layout layout,
+    std::pair<size_t, size_t> range, const std::string& expression
+);
+
+/**
+ * @brief Evaluate `expression` against every record of one range and pass
+ * each serialized result, with its trailing newline, to `emit` as soon as
+ * it is produced.
+ */
+void evaluate_range(
+    std::string_view text, input_layout layout,
+    std::pair<size_t, size_t> range, const std::string& expression,
+    const std::function<void(std::string_view)>& emit
+);
+
+/**
+ * @brief Map `input` once, fork `workers` processes that each evaluate one
+ * range, and write their results to `out` in input order.
+ *
+ * Workers write each record's result as soon as it is evaluated. Output of
+ * the first unfinished worker is streamed as it arrives; later workers are
+ * buffered until their predecessors have finished. If a pipe or process
+ * cannot be created, the workers already started are killed and reaped.
+ *
+ * @return `0` on success, `1` if any worker failed (its error is printed to
+ * stderr by the worker).
+ * @throws std::runtime_error If the input cannot be mapped or a process or
+ * pipe cannot be created.
+ */
+int run(
+    const std::filesystem::path& input, const std::string& expression,
+    size_t workers, std::ostream& out
+);
+}
+
+#endif // PARALLEL_HPP
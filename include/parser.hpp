@@ -42,21 +42,34 @@ public:
         std::shared_ptr<json_lib::json>& result, bool dynamic = false
     );
 
+    /**
+     * @brief Hand the input buffer back to the caller, e.g. to reuse its
+     * capacity for the next input. The parser is left without input.
+     */
+    std::string release_buffer();
+
 private:
     std::ifstream ifs;
     std::string buffer;
     int pos { -1 };
     int line { -1 };
+    size_t depth { 0 };
+    size_t bytes_read { 0 };
+    size_t nodes { 0 };
 
     size_t get_pos() const;
     bool valid() const;
     void next();
     void read_line();
+    void descend();
+    void count_value(bool dynamic);
     char peek() const;
     char get();
     bool check_ahead(char expected) const;
     bool separator(char val = ',');
 
+    bool traced_element(bool dynamic) const;
+
     void nonessential();
     std::string parse_keyword();
     std::string parse_string();
@@ -110,6 +123,28 @@ Container parser::parse_collection(
     next();
     return children;
 }
+
+/**
+ * @brief Read a whole file into memory.
+ *
+ * Used by callers that want to separate file I/O from parsing, e.g. to time
+ * the two phases independently before handing the buffer to a `parser`.
+ *
+ * @param path The file to read.
+ * @return The file contents.
+ * @throws std::invalid_argument If the file cannot be opened.
+ */
+std::string read_file(const std::filesystem::path& path);
+
+/**
+ * @brief Read a whole file into `buffer`, replacing its contents but
+ * reusing its capacity.
+ *
+ * @param path The file to read.
+ * @param buffer Receives the file contents.
+ * @throws std::invalid_argument If the file cannot be opened.
+ */
+void read_file(const std::filesystem::path& path, std::string& buffer);
 }
 
 #endif // PARSER_HPP
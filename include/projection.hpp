@@ -0,0 +1,125 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PROJECTION_HPP
+#define PROJECTION_HPP
+#include "json.hpp"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace projection_lib {
+/**
+ * @brief Values gathered by a `[*]` projection from the elements of one
+ * array.
+ */
+struct column {
+    /// The gathered values, in element order.
+    std::shared_ptr<json_lib::json_array> values;
+    /// Index of the element each value was gathered from.
+    std::vector<size_t> positions;
+};
+
+/**
+ * @brief Counters of a `cache` since construction.
+ */
+struct cache_stats {
+    size_t hits = 0; ///< Projections answered from a cached column.
+    size_t builds = 0; ///< Columns gathered and offered to the cache.
+    size_t evictions = 0; ///< Columns dropped to stay under the cap.
+};
+
+/**
+ * @brief Thread-safe cache of gathered columns with a memory cap.
+ *
+ * Columns are keyed by the array they were gathered from and the path
+ * applied to its elements. The array's identity stands in for the document
+ * version: a reparsed or reloaded document consists of new nodes, and an
+ * entry is only matched while the array it was gathered from is alive.
+ * Entries are kept in least-recently-used order, each accounted with the
+ * `memory_usage()` of its values plus its positions; whenever the total
+ * exceeds the cap, the least recently used columns are dropped.
+ */
+class cache {
+public:
+    /**
+     * @param memory_limit Cap on the summed size of all columns in bytes.
+     */
+    explicit cache(size_t memory_limit);
+
+    /**
+     * @brief The column gathered by `path` from `source`, if cached.
+     */
+    std::shared_ptr<const column> find(
+        const std::shared_ptr<json_lib::json>& source, const std::string& path
+    );
+
+    /**
+     * @brief Offer a freshly gathered column to the cache.
+     *
+     * A column larger than the cap on its own is not kept.
+     */
+    void insert(
+        const std::shared_ptr<json_lib::json>& source, const std::string& path,
+        std::shared_ptr<const column> gathered
+    );
+
+    void clear();
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t memory_usage() const;
+    [[nodiscard]] size_t memory_limit() const;
+    [[nodiscard]] cache_stats stats() const;
+
+private:
+    struct entry {
+        std::string key;
+        std::weak_ptr<json_lib::json> source;
+        std::shared_ptr<const column> gathered;
+        size_t memory = 0;
+    };
+
+    static std::string
+    key_of(const json_lib::json* source, const std::string& path);
+    void drop(std::list<entry>::iterator position);
+
+    size_t limit;
+    size_t used = 0;
+    cache_stats counters;
+    std::list<entry> recent; ///< Most recently used first.
+    std::unordered_map<std::string, std::list<entry>::iterator> index;
+    mutable std::mutex mutex;
+};
+
+/**
+ * @brief Cache that `[*]` projections consult and fill.
+ *
+ * Projections gather their column on every evaluation while this is
+ * `nullptr`.
+ */
+inline cache* active_cache = nullptr;
+}
+
+#endif // PROJECTION_HPP
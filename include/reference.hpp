@@ -26,13 +26,56 @@
 #define CUSTOM_JSON_HPP
 #include "json.hpp"
 
+#include <chrono>
 #include <deque>
+#include <functional>
 
 namespace reference_lib {
+/**
+ * @brief Counters collected for one step of an evaluated expression.
+ *
+ * Times are inclusive: a step that evaluates nested paths (unions,
+ * subscripts, function arguments) also accounts for their time.
+ */
+struct step_profile {
+    size_t calls = 0; ///< How many times the step was applied.
+    size_t visited = 0; ///< Nodes the step had to look at.
+    size_t produced = 0; ///< Elements the step produced.
+    std::chrono::nanoseconds time {}; ///< Wall time spent in the step.
+};
+
+/**
+ * @brief Per-step profile of an evaluation, keyed by the step's node.
+ *
+ * Steps are identified by the address of the accessor (or function) node in
+ * the compiled expression, so the expression must be kept alive while the
+ * profile is inspected.
+ */
+class evaluation_profile {
+public:
+    void record(
+        const json_lib::json* step, size_t visited, size_t produced,
+        std::chrono::nanoseconds time
+    );
+    [[nodiscard]] const step_profile* find(const json_lib::json* step) const;
+
+private:
+    std::unordered_map<const json_lib::json*, step_profile> steps;
+};
+
+/**
+ * @brief Profile that evaluations on the current thread report to.
+ *
+ * Profiling is off while this is `nullptr`, which costs a single branch per
+ * evaluated step.
+ */
+inline thread_local evaluation_profile* active_profile = nullptr;
+
 enum class json_reference_type : int {
     reference_json,
     set_json,
-    function_json
+    function_json,
+    projection_json
 };
 enum class ref_head_type : int { local, root, accessor, object, set };
 
@@ -55,6 +98,9 @@ public:
     virtual size_t length() const;
     virtual std::shared_ptr<json> value();
     ref_head_type get_head_type() const;
+    std::shared_ptr<json> get_head() const;
+    const std::deque<std::shared_ptr<json>>& get_tail() const;
+    size_t footprint(std::unordered_set<const json*>& counted) const override;
 
 private:
     ref_head_type head_type;
@@ -79,6 +125,8 @@ public:
     void set_root(const std::shared_ptr<json>& item) override;
     void emplace_back(const std::shared_ptr<json>& item) override;
     void set_parent(const std::shared_ptr<json>& local) override;
+    const std::vector<std::shared_ptr<json_reference>>& get_elements() const;
+    size_t footprint(std::unordered_set<const json*>& counted) const override;
 
 private:
     bool independent = false;
@@ -95,11 +143,92 @@ public:
     void set_parent(const std::shared_ptr<json>& local) override;
     void set_args(const std::vector<std::shared_ptr<json>>& args);
     std::shared_ptr<json> value() override;
+    const std::string& get_name() const;
+    const std::vector<std::shared_ptr<json>>& get_args() const;
+    size_t footprint(std::unordered_set<const json*>& counted) const override;
 
 private:
     std::string name;
     std::vector<std::shared_ptr<json>> args {};
+
+    std::shared_ptr<json> compute();
 };
+
+/**
+ * @brief The `[*]` accessor: applies the path that follows it to every
+ * element of an array and collects the results into an array.
+ *
+ * Elements on which the path does not resolve (a missing key, an index out
+ * of range or a value of another type) are skipped. The path may consist of
+ * constant keys and indices and further `[*]`s, which yield nested arrays.
+ * While a `projection_lib::active_cache` is set, the gathered column is
+ * reused by later evaluations against the same array.
+ */
+class json_projection final : public json_reference {
+public:
+    json_projection();
+
+    std::string
+    indented_string(size_t indent_level, bool pretty) const override;
+    void emplace_back(const std::shared_ptr<json>& accessor) override;
+
+    /**
+     * @brief Gather the path from every element of `source`.
+     *
+     * @throws std::invalid_argument If `source` is not an array.
+     */
+    std::shared_ptr<json> gather(const std::shared_ptr<json>& source) const;
+};
+
+/**
+ * @brief Evaluate a parsed expression against a root document.
+ *
+ * Binds every `$` in `expression` to `root` and resolves whatever becomes
+ * resolvable, including intrinsic functions whose arguments were waiting for
+ * the root. The expression tree is consumed by the evaluation, so parse it
+ * again before evaluating it against another document.
+ *
+ * @param expression The expression produced by a dynamic parse.
+ * @param root The document that `$` refers to.
+ * @return The evaluated value, or the remaining reference if it cannot be
+ * resolved further.
+ */
+std::shared_ptr<json_lib::json> evaluate(
+    const std::shared_ptr<json_lib::json>& expression,
+    const std::shared_ptr<json_lib::json>& root
+);
+
+/**
+ * @brief Whether `reference` is a constant path: `$` followed by keys and
+ * indices only.
+ */
+bool is_constant_path(const json_reference& reference);
+
+/**
+ * @brief Resolve the paths of an expression against a document that is not
+ * loaded as a tree, such as an index, a snapshot or a column store.
+ *
+ * Arrays, objects and function arguments are rebuilt with every path
+ * replaced by what `locate` returns for it; other values are kept. Each
+ * function call is first offered to `shortcut`, if set, which may answer it
+ * without its arguments.
+ *
+ * @param expression The expression produced by a dynamic parse.
+ * @param locate Value of a path, or `nullptr` if it cannot be located.
+ * @param shortcut Value of a function call, or `nullptr` to resolve its
+ * arguments instead.
+ * @return The expression with values in place of its paths, to be evaluated
+ * against an empty root, or `nullptr` if any path or other reference could
+ * not be resolved.
+ */
+std::shared_ptr<json_lib::json> resolve_paths(
+    const std::shared_ptr<json_lib::json>& expression,
+    const std::function<std::shared_ptr<json_lib::json>(const json_reference&)>&
+        locate,
+    const std::function<std::shared_ptr<json_lib::json>(const json_function&)>&
+        shortcut
+    = nullptr
+);
 }
 
 #endif // CUSTOM_JSON_HPP
@@ -0,0 +1,166 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SCHEMA_HPP
+#define SCHEMA_HPP
+#include "json.hpp"
+#include "parallel.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace schema_lib {
+/**
+ * @brief Number of value types a schema tells apart: `null_json` to
+ * `object_json`.
+ */
+constexpr size_t type_count = 7;
+
+/**
+ * @brief Distinct keys kept per object schema. Further keys are merged into
+ * a single schema for all of them, so that the size of a schema depends on
+ * the variety of the input, not on its length.
+ */
+constexpr size_t max_properties = 1024;
+
+/**
+ * @brief Least and greatest of the values added.
+ */
+template <typename T> struct bounds {
+    T min {};
+    T max {};
+    bool observed = false; ///< Whether any value was added.
+
+    void add(const T value) {
+        if (!observed || value < min) {
+            min = value;
+        }
+        if (!observed || max < value) {
+            max = value;
+        }
+        observed = true;
+    }
+
+    void merge(const bounds& other) {
+        if (other.observed) {
+            add(other.min);
+            add(other.max);
+        }
+    }
+};
+
+/**
+ * @brief Structure of all values observed at one place of the input.
+ *
+ * Schemas of the same place in different parts of the input merge into the
+ * schema of their union, in any order, which lets chunks of an input be
+ * inferred independently.
+ */
+struct node {
+    uint64_t count = 0; ///< Values observed.
+    std::array<uint64_t, type_count> types {}; ///< Values per `json_type`.
+    bounds<double> numbers; ///< Range of integer and real values.
+    bounds<uint64_t> lengths; ///< Range of string lengths in bytes.
+    bounds<uint64_t> sizes; ///< Range of array sizes.
+    std::unique_ptr<node> elements; ///< Schema of all array elements.
+    /// Schema of each member; its count is the number of objects with it.
+    std::map<std::string, std::unique_ptr<node>, std::less<>> properties;
+    std::unique_ptr<node> others; ///< Members past `max_properties`.
+
+    /**
+     * @brief Number of values of type `type`.
+     */
+    [[nodiscard]] uint64_t of(json_lib::json_type type) const;
+
+    /**
+     * @brief Schema of member `key`, added if it is new.
+     */
+    node& property(std::string_view key);
+
+    /**
+     * @brief Schema of the array elements, added if there is none.
+     */
+    node& element();
+
+    /**
+     * @brief Fold the observations of `other` into this schema.
+     */
+    void merge(const node& other);
+
+    /**
+     * @brief Render the schema as JSON.
+     *
+     * Every schema has the `count` of values and their `types`, with the
+     * number of values of each. Numbers add their `range`, strings the
+     * `length` and arrays the `size` range, each as `[min, max]`, and
+     * arrays the schema of their `elements`. Objects list the schema of
+     * each key under `properties` and the keys missing from some of them
+     * under `optional`; keys past `max_properties` share one schema under
+     * `other`.
+     */
+    [[nodiscard]] std::string to_string() const;
+};
+
+/**
+ * @brief Add one JSON text to `schema` without building the document.
+ *
+ * The text is scanned once; only the schema is kept in memory.
+ *
+ * @throws std::runtime_error If the text is not a single well-formed
+ * value.
+ */
+void observe(std::string_view text, node& schema);
+
+/**
+ * @brief Schema of the records in one range of a partitioned input: the
+ * lines of NDJSON, the elements of an array or the single document.
+ */
+node infer_range(
+    std::string_view text, parallel_lib::input_layout layout,
+    std::pair<size_t, size_t> range
+);
+
+/**
+ * @brief Schema of the documents in `files`.
+ *
+ * Every file is mapped and split into chunks of whole records that
+ * `threads` threads infer in parallel (`0` for the hardware concurrency);
+ * the chunk schemas are merged. Each line of NDJSON counts as a document,
+ * and a top-level array as one document whose elements are inferred in
+ * parallel.
+ *
+ * @throws std::invalid_argument If a file cannot be opened.
+ * @throws std::runtime_error If a file is not well-formed.
+ */
+node infer(const std::vector<std::filesystem::path>& files, size_t threads);
+}
+
+#endif // SCHEMA_HPP
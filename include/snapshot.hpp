@@ -0,0 +1,200 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+#include "json.hpp"
+#include "transport.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace snapshot_lib {
+/**
+ * @brief Encode a parsed document in the `.jbin` snapshot format.
+ *
+ * The encoding is position independent: containers refer to their children
+ * by byte offset from the start of the snapshot, and every string and real
+ * number text is stored once in a string table. Layout, with all integers
+ * little-endian:
+ *
+ * - header: `"JBIN"`, `u32` version, `u64` root offset, `u64` string table
+ *   offset, `u64` total size;
+ * - nodes: a `u8` tag (null, false, true, integer, real, string, array,
+ *   object) followed by an `i32` value, a `u32` string id, or for containers
+ *   a `u32` count and the child offsets. Objects store `(u32 key id, u64
+ *   offset)` entries in document order, followed by a directory of `u32`
+ *   entry indices sorted by key for binary search;
+ * - string table: `u32` count, `(u64 offset, u32 length)` per string, then
+ *   the bytes.
+ *
+ * @param document The document to encode; references are not supported.
+ * @return The snapshot bytes.
+ * @throws std::invalid_argument If the document contains references.
+ */
+std::string encode(const json_lib::json& document);
+
+/**
+ * @brief Encode `document` and write it to `path`.
+ */
+void write(const json_lib::json& document, const std::filesystem::path& path);
+
+class snapshot;
+
+/**
+ * @brief A value inside a snapshot, read in place.
+ *
+ * Nodes are cheap handles (the snapshot and an offset); they must not
+ * outlive their snapshot.
+ */
+class node {
+public:
+    node(const snapshot& owner, uint64_t offset);
+
+    [[nodiscard]] json_lib::json_type type() const;
+
+    /**
+     * @brief Number of elements or members; `0` for scalars.
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Element `index` of an array.
+     *
+     * @throws std::out_of_range If the node is no array or the index is out
+     * of range.
+     */
+    [[nodiscard]] node at(size_t index) const;
+
+    /**
+     * @brief Member `key` of an object, found by binary search over the
+     * sorted key directory.
+     *
+     * @return The member, or nothing if the node is no object or has no
+     * such key.
+     */
+    [[nodiscard]] std::optional<node> find(std::string_view key) const;
+
+    /**
+     * @brief Key of the member at position `index` in document order.
+     */
+    [[nodiscard]] std::string_view key_at(size_t index) const;
+
+    /**
+     * @brief Value of the member at position `index` in document order.
+     */
+    [[nodiscard]] node value_at(size_t index) const;
+
+    /**
+     * @brief Text of a string, or of a real number as written in the input.
+     */
+    [[nodiscard]] std::string_view text() const;
+
+    [[nodiscard]] int integer() const;
+    [[nodiscard]] bool boolean() const;
+
+    /**
+     * @brief Build the `json` tree of this value and everything below it.
+     */
+    [[nodiscard]] std::shared_ptr<json_lib::json> materialize() const;
+
+    [[nodiscard]] uint64_t offset() const;
+
+private:
+    const snapshot* owner;
+    uint64_t position;
+    uint8_t tag;
+};
+
+/**
+ * @brief Read-only view of a `.jbin` snapshot, either mapped from a file or
+ * over caller-owned bytes.
+ *
+ * Opening validates the header only; nodes are decoded lazily as they are
+ * visited, with every offset checked against the snapshot size and every
+ * child offset required to lie below its parent's.
+ */
+class snapshot {
+public:
+    /**
+     * @brief Map the snapshot file at `path`.
+     *
+     * @throws std::invalid_argument If the file cannot be opened.
+     * @throws std::runtime_error If it is not a valid snapshot.
+     */
+    explicit snapshot(const std::filesystem::path& path);
+
+    /**
+     * @brief View snapshot bytes that outlive the `snapshot`.
+     *
+     * @throws std::runtime_error If the bytes are not a valid snapshot.
+     */
+    explicit snapshot(const std::string& bytes);
+    explicit snapshot(std::string&& bytes) = delete;
+
+    [[nodiscard]] node root() const;
+    [[nodiscard]] std::string_view string_at(uint32_t id) const;
+    [[nodiscard]] std::string_view bytes() const;
+
+    uint8_t read_u8(uint64_t offset) const;
+    uint32_t read_u32(uint64_t offset) const;
+    uint64_t read_u64(uint64_t offset) const;
+
+private:
+    void validate();
+
+    std::unique_ptr<transport_lib::mapped_segment> mapping;
+    std::string_view data;
+    uint64_t root_offset = 0;
+    uint64_t strings_offset = 0;
+    uint32_t string_count = 0;
+};
+
+/**
+ * @brief Whether the file at `path` starts with the snapshot magic.
+ */
+bool is_snapshot(const std::filesystem::path& path);
+
+/**
+ * @brief Evaluate a compiled expression against a snapshot.
+ *
+ * Constant paths (`$` followed by keys and indices), and function calls,
+ * arrays and objects built from them, are resolved by navigating the
+ * snapshot in place; only the values they reach are materialized. Any other
+ * expression falls back to materializing the whole document.
+ *
+ * @param data The snapshot to query.
+ * @param expression The compiled expression; consumed by the evaluation.
+ * @return The result of the evaluation.
+ */
+std::shared_ptr<json_lib::json> evaluate(
+    const snapshot& data, const std::shared_ptr<json_lib::json>& expression
+);
+}
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,149 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STATS_HPP
+#define STATS_HPP
+#include "json.hpp"
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace stats_lib {
+/**
+ * @brief Monotonic wall-clock timer used to measure the CLI phases.
+ */
+class stopwatch {
+public:
+    stopwatch();
+
+    /**
+     * @brief Reset the start point to the current moment.
+     */
+    void restart();
+
+    /**
+     * @brief Time elapsed since construction or the last `restart()`.
+     *
+     * @return The elapsed time in microseconds.
+     */
+    [[nodiscard]] std::chrono::microseconds elapsed() const;
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Structural summary of a parsed JSON document.
+ *
+ * Filled by a single recursive walk over the tree. Only the concrete value
+ * types (`null_json` ... `object_json`) are counted; references left over
+ * from expressions are ignored.
+ */
+struct document_stats {
+    static constexpr size_t type_count
+        = static_cast<size_t>(json_lib::json_type::object_json) + 1;
+
+    std::array<size_t, type_count> nodes {}; ///< Node counts by `json_type`.
+    size_t max_depth = 0; ///< Deepest nesting level; a scalar root is 1.
+    size_t string_bytes = 0; ///< Bytes held by string values and object keys.
+
+    /**
+     * @brief Add `item` and all of its descendants to the summary.
+     *
+     * @param item The subtree to account for.
+     * @param depth The nesting level of `item` itself.
+     */
+    void collect(const json_lib::json& item, size_t depth = 1);
+
+    [[nodiscard]] size_t total_nodes() const;
+};
+
+/**
+ * @brief Everything `json_eval --stats` reports about a single run.
+ */
+struct run_stats {
+    size_t bytes_read = 0;
+    std::chrono::microseconds read_time {};
+    std::chrono::microseconds parse_time {};
+    std::chrono::microseconds compile_time {};
+    std::chrono::microseconds evaluate_time {};
+    std::chrono::microseconds serialize_time {};
+    document_stats document;
+    size_t document_memory = 0; ///< `memory_usage()` of the parsed document.
+
+    /**
+     * @brief Render the statistics as a single-line JSON object.
+     *
+     * Process-wide figures (peak RSS and the allocation counters of
+     * `alloc_lib`) are sampled at the moment of the call. Allocations are
+     * broken down by phase only if the build tracks them.
+     *
+     * @return The JSON text, without a trailing newline.
+     */
+    [[nodiscard]] std::string to_string() const;
+};
+
+/**
+ * @brief Order statistics of a series of latency measurements.
+ */
+struct latency_summary {
+    size_t count = 0;
+    std::chrono::nanoseconds min {};
+    std::chrono::nanoseconds median {};
+    std::chrono::nanoseconds p99 {};
+    std::chrono::nanoseconds max {};
+    std::chrono::nanoseconds total {}; ///< Sum of all samples.
+
+    /**
+     * @brief Samples completed per second of measured time.
+     */
+    [[nodiscard]] double throughput() const;
+
+    /**
+     * @brief Render the summary as human-readable lines.
+     *
+     * @return The text, ending with a newline.
+     */
+    [[nodiscard]] std::string to_string() const;
+};
+
+/**
+ * @brief Compute nearest-rank percentiles of latency samples.
+ *
+ * @param samples The measured latencies; the order does not matter.
+ * @return The summary, all zero for an empty series.
+ */
+latency_summary summarize(std::vector<std::chrono::nanoseconds> samples);
+
+/**
+ * @brief Peak resident set size of the current process.
+ *
+ * @return The peak RSS in bytes, or `0` where the platform does not expose
+ * it.
+ */
+size_t peak_rss();
+}
+
+#endif // STATS_HPP
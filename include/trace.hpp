@@ -0,0 +1,123 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace trace_lib {
+using clock = std::chrono::steady_clock;
+
+/**
+ * @brief Collects Chrome trace events ("complete" events with a duration).
+ *
+ * The recorder is safe to share between threads; every event carries a small
+ * per-thread id so parallel work shows up on separate tracks in
+ * `chrome://tracing` or Perfetto.
+ */
+class recorder {
+public:
+    /**
+     * @brief Start a trace whose timestamps are relative to now.
+     *
+     * @param elements Also emit one span per top-level element of parsed
+     * documents.
+     */
+    explicit recorder(bool elements = false);
+
+    /**
+     * @brief Record a finished span.
+     *
+     * @param category The event category, e.g. `"phase"` or `"step"`.
+     * @param name The name shown on the span.
+     * @param start When the span began.
+     * @param end When the span ended.
+     */
+    void complete(
+        const std::string& category, const std::string& name,
+        clock::time_point start, clock::time_point end
+    );
+
+    [[nodiscard]] bool elements() const;
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Write all events in the Chrome trace-event JSON format.
+     *
+     * @param os The stream to write to.
+     */
+    void write(std::ostream& os) const;
+
+private:
+    struct event {
+        std::string category;
+        std::string name;
+        std::chrono::nanoseconds start;
+        std::chrono::nanoseconds duration;
+        size_t thread;
+    };
+
+    clock::time_point origin;
+    bool per_element;
+    mutable std::mutex mutex;
+    std::vector<event> events {};
+};
+
+/**
+ * @brief Recorder that spans report to, shared by all threads.
+ *
+ * Tracing is off while this is `nullptr`; a disabled span costs one branch on
+ * construction and one on destruction.
+ */
+inline recorder* active_recorder = nullptr;
+
+/**
+ * @brief Small sequential id of the calling thread, starting at 1.
+ */
+size_t thread_id();
+
+/**
+ * @brief Records the lifetime of the scope as a span, if tracing is on.
+ */
+class span {
+public:
+    explicit span(const char* name, const char* category = "phase");
+    ~span();
+
+    span(const span&) = delete;
+    span& operator=(const span&) = delete;
+
+private:
+    recorder* target;
+    const char* name;
+    const char* category;
+    clock::time_point start {};
+};
+}
+
+#endif // TRACE_HPP
@@ -0,0 +1,95 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TRANSPORT_HPP
+#define TRANSPORT_HPP
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace transport_lib {
+/**
+ * @brief Create an anonymous shared-memory file.
+ *
+ * Uses `memfd_create` where available. The descriptor is not close-on-exec,
+ * so it is inherited by a child process started with `exec` (e.g.
+ * `json_eval --output-shm fd:<n>`) and mapped by the consumer afterwards.
+ *
+ * @param name Debugging name of the file, shown in `/proc/<pid>/fd`.
+ * @return The open file descriptor, owned by the caller.
+ * @throws std::runtime_error If anonymous shared memory is not available.
+ */
+int create_memfd(const std::string& name);
+
+/**
+ * @brief Resize the file behind `fd` to exactly `text.size()` bytes and copy
+ * `text` into it through a shared mapping.
+ *
+ * The result is serialized into `text` first, so producing a segment costs
+ * one copy; consumers then read it through `mapped_segment` without any.
+ *
+ * @throws std::runtime_error If the file cannot be resized or mapped.
+ */
+void write_segment(int fd, std::string_view text);
+
+/**
+ * @brief Create or truncate the file at `path` (typically in `/dev/shm`)
+ * and write `text` into it as with `write_segment(int, std::string_view)`.
+ */
+void write_segment(const std::filesystem::path& path, std::string_view text);
+
+/**
+ * @brief Read-only shared mapping of a segment, for consumers.
+ *
+ * The whole file is mapped on construction and unmapped on destruction;
+ * the descriptor itself is not closed.
+ */
+class mapped_segment {
+public:
+    explicit mapped_segment(int fd);
+
+    /**
+     * @brief Map the file at `path`; the descriptor is closed right away.
+     *
+     * @throws std::invalid_argument If the file cannot be opened.
+     * @throws std::runtime_error If it cannot be mapped.
+     */
+    explicit mapped_segment(const std::filesystem::path& path);
+    ~mapped_segment();
+
+    mapped_segment(const mapped_segment&) = delete;
+    mapped_segment& operator=(const mapped_segment&) = delete;
+
+    [[nodiscard]] std::string_view view() const;
+
+private:
+    void map(int fd);
+
+    void* address = nullptr;
+    size_t length = 0;
+};
+}
+
+#endif // TRANSPORT_HPP
@@ -0,0 +1,168 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "alloc.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+struct atomic_counters {
+    std::atomic<size_t> count { 0 };
+    std::atomic<size_t> bytes { 0 };
+};
+
+/**
+ * Counters of the threads leasing it, on a cache line of its own so that
+ * threads do not contend on shared counters. A slot keeps its counts when
+ * its thread exits and the next thread to lease it adds to them, so the
+ * sum over all slots is the process total.
+ */
+struct alignas(64) slot {
+    std::array<atomic_counters, alloc_lib::phase_count> phases;
+    std::atomic<bool> leased { false };
+};
+
+constexpr size_t slot_count = 64;
+
+std::array<slot, slot_count> slots;
+slot overflow; ///< Shared by the threads beyond `slot_count`.
+
+thread_local slot* leased_slot = nullptr;
+
+struct lease_release {
+    ~lease_release() {
+        if (leased_slot != &overflow) {
+            leased_slot->leased.store(false, std::memory_order_release);
+        }
+    }
+};
+
+slot& lease() {
+    for (auto& candidate : slots) {
+        bool expected = false;
+        if (!candidate.leased.load(std::memory_order_relaxed)
+            && candidate.leased.compare_exchange_strong(
+                expected, true, std::memory_order_acquire
+            )) {
+            return candidate;
+        }
+    }
+    return overflow;
+}
+
+/**
+ * Slot of the calling thread. Allocations made after the slot has been
+ * released at thread exit still land in it; counters are atomic, so a
+ * second writer only costs contention, not counts.
+ */
+slot& thread_slot() {
+    if (leased_slot == nullptr) {
+        leased_slot = &lease();
+        thread_local const lease_release release;
+        static_cast<void>(release);
+    }
+    return *leased_slot;
+}
+
+template <typename Visit> void for_each_slot(Visit visit) {
+    for (auto& each : slots) {
+        visit(each);
+    }
+    visit(overflow);
+}
+}
+
+void* operator new(const std::size_t size) {
+#ifdef TRACK_ALLOCATIONS
+    const auto type = alloc_lib::current_phase;
+#else
+    const auto type = alloc_lib::phase::other;
+#endif
+    while (true) {
+        if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+            auto& counter = thread_slot().phases[static_cast<size_t>(type)];
+            counter.count.fetch_add(1, std::memory_order_relaxed);
+            counter.bytes.fetch_add(size, std::memory_order_relaxed);
+            return ptr;
+        }
+        const std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+std::string alloc_lib::phase_to_string(const phase type) {
+    switch (type) {
+    case phase::read:
+        return "read";
+    case phase::parse:
+        return "parse";
+    case phase::compile:
+        return "compile";
+    case phase::evaluate:
+        return "evaluate";
+    case phase::serialize:
+        return "serialize";
+    default:
+        return "other";
+    }
+}
+
+alloc_lib::counters alloc_lib::allocations(const phase type) {
+    counters result;
+    for_each_slot([&](const slot& each) {
+        const auto& counter = each.phases[static_cast<size_t>(type)];
+        result.count += counter.count.load(std::memory_order_relaxed);
+        result.bytes += counter.bytes.load(std::memory_order_relaxed);
+    });
+    return result;
+}
+
+alloc_lib::counters alloc_lib::total() {
+    counters result;
+    for (size_t i = 0; i < phase_count; ++i) {
+        const auto current = allocations(static_cast<phase>(i));
+        result.count += current.count;
+        result.bytes += current.bytes;
+    }
+    return result;
+}
+
+void alloc_lib::reset() {
+    for_each_slot([](slot& each) {
+        for (auto& counter : each.phases) {
+            counter.count.store(0, std::memory_order_relaxed);
+            counter.bytes.store(0, std::memory_order_relaxed);
+        }
+    });
+}
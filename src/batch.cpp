@@ -0,0 +1,212 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "batch.hpp"
+#include "governor.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+#include "trace.hpp"
+
+#include <map>
+#include <optional>
+
+namespace {
+struct trie_node {
+    std::shared_ptr<json_lib::json> accessor;
+    std::map<std::string, size_t> children;
+    std::vector<size_t> requests;
+};
+
+const std::deque<std::shared_ptr<json_lib::json>>*
+constant_path(const std::shared_ptr<json_lib::json>& expression) {
+    if (expression->type() != json_lib::json_type::reference_json) {
+        return nullptr;
+    }
+    const auto& reference
+        = dynamic_cast<const reference_lib::json_reference&>(*expression);
+    return reference_lib::is_constant_path(reference) ? &reference.get_tail()
+                                                      : nullptr;
+}
+}
+
+batch_lib::coalescer::coalescer(
+    std::shared_ptr<json_lib::json> document,
+    const std::chrono::microseconds window, const size_t max_batch
+)
+    : document(std::move(document))
+    , window(window)
+    , max_batch(max_batch)
+    , token(governor_lib::active_token)
+    , worker(&coalescer::run, this) { }
+
+batch_lib::coalescer::~coalescer() {
+    {
+        const std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    worker.join();
+}
+
+std::future<std::shared_ptr<json_lib::json>>
+batch_lib::coalescer::submit(std::string expression) {
+    request query;
+    parser_lib::parser(expression).completely_parse_json(
+        query.expression, true
+    );
+    auto result = query.result.get_future();
+    bool wake = false;
+    {
+        const std::lock_guard lock(mutex);
+        pending.emplace_back(std::move(query));
+        wake = pending.size() == 1 || pending.size() >= max_batch;
+    }
+    if (wake) {
+        ready.notify_one();
+    }
+    return result;
+}
+
+batch_lib::coalescer_stats batch_lib::coalescer::stats() const {
+    const std::lock_guard lock(mutex);
+    return counters;
+}
+
+void batch_lib::coalescer::run() {
+    std::optional<governor_lib::token_scope> cancellation;
+    if (token != nullptr) {
+        cancellation.emplace(*token);
+    }
+    std::unique_lock lock(mutex);
+    for (;;) {
+        ready.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty()) {
+            return;
+        }
+        ready.wait_for(lock, window, [this] {
+            return stopping || pending.size() >= max_batch;
+        });
+        std::vector<request> batch;
+        batch.swap(pending);
+        lock.unlock();
+        process(batch);
+        lock.lock();
+    }
+}
+
+void batch_lib::coalescer::process(std::vector<request>& batch) {
+    std::vector<std::shared_ptr<json_lib::json>> values(batch.size());
+    std::vector<std::exception_ptr> errors(batch.size());
+    std::vector<trie_node> trie(1);
+    size_t coalesced = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const auto* path = constant_path(batch[i].expression);
+        if (path == nullptr) {
+            try {
+                values[i]
+                    = reference_lib::evaluate(batch[i].expression, document);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+            continue;
+        }
+        size_t node = 0;
+        for (const auto& accessor : *path) {
+            const size_t next = trie.size();
+            const auto [child, inserted] = trie[node].children.try_emplace(
+                accessor->to_string(), next
+            );
+            node = child->second;
+            if (inserted) {
+                trie.emplace_back().accessor = accessor;
+            }
+        }
+        trie[node].requests.emplace_back(i);
+        ++coalesced;
+    }
+
+    // Depth-first over the trie, so every shared prefix is resolved once.
+    // The traversal is charged as one query, one step per trie edge.
+    const governor_lib::query_budget budget;
+    const bool traced = trace_lib::active_recorder != nullptr;
+    size_t steps = 0;
+    std::vector<std::pair<size_t, std::shared_ptr<json_lib::json>>> stack {
+        { 0, document }
+    };
+    while (!stack.empty()) {
+        const auto [node, value] = std::move(stack.back());
+        stack.pop_back();
+        for (const size_t i : trie[node].requests) {
+            values[i] = value;
+        }
+        for (const auto& [key, child] : trie[node].children) {
+            try {
+                governor_lib::poll();
+                governor_lib::query_budget::charge();
+                ++steps;
+                std::chrono::steady_clock::time_point start;
+                if (traced) {
+                    start = std::chrono::steady_clock::now();
+                }
+                stack.emplace_back(child, value->by(trie[child].accessor));
+                if (traced) {
+                    trace_lib::active_recorder->complete(
+                        "step",
+                        '[' + trie[child].accessor->indented_string(0, false)
+                            + ']',
+                        start, std::chrono::steady_clock::now()
+                    );
+                }
+            } catch (...) {
+                const auto error = std::current_exception();
+                std::vector<size_t> failed { child };
+                while (!failed.empty()) {
+                    const size_t current = failed.back();
+                    failed.pop_back();
+                    for (const size_t i : trie[current].requests) {
+                        errors[i] = error;
+                    }
+                    for (const auto& [_, next] : trie[current].children) {
+                        failed.emplace_back(next);
+                    }
+                }
+            }
+        }
+    }
+
+    {
+        const std::lock_guard lock(mutex);
+        ++counters.batches;
+        counters.queries += batch.size();
+        counters.coalesced += coalesced;
+        counters.steps += steps;
+    }
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (errors[i] != nullptr) {
+            batch[i].result.set_exception(errors[i]);
+        } else {
+            batch[i].result.set_value(std::move(values[i]));
+        }
+    }
+}
@@ -0,0 +1,290 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bloom.hpp"
+#include "binary.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numbers>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+using binary_lib::put_u32;
+using binary_lib::put_u64;
+
+constexpr std::string_view magic = "JBLM";
+constexpr uint32_t version = 1;
+constexpr uint32_t max_hashes = 16;
+
+uint64_t fnv1a(const std::string_view item) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char c : item) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * SplitMix64 finalizer, deriving the second hash of the double hashing
+ * scheme from the first.
+ */
+uint64_t mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+std::string item_of(const bloom_lib::target kind, const std::string_view text) {
+    std::string result(1, kind == bloom_lib::target::key ? 'k' : 'v');
+    result += text;
+    return result;
+}
+
+std::string scalar_text(const json_lib::json& value) {
+    if (value.type() == json_lib::json_type::string_json) {
+        return dynamic_cast<const json_lib::json_string&>(value).as_key();
+    }
+    return value.to_string();
+}
+
+/**
+ * Visit every object key and scalar value of `document` without recursion;
+ * stops as soon as `visit` returns true.
+ */
+template <typename Visit>
+bool walk(const json_lib::json& document, Visit visit) {
+    std::vector<const json_lib::json*> stack { &document };
+    while (!stack.empty()) {
+        const json_lib::json* node = stack.back();
+        stack.pop_back();
+        switch (node->type()) {
+        case json_lib::json_type::array_json:
+            for (const auto& item :
+                 dynamic_cast<const json_lib::json_array&>(*node).items()) {
+                stack.emplace_back(item.get());
+            }
+            break;
+        case json_lib::json_type::object_json:
+            for (const auto& [key, item] :
+                 dynamic_cast<const json_lib::json_object&>(*node).items()) {
+                if (visit(bloom_lib::target::key, key)) {
+                    return true;
+                }
+                stack.emplace_back(item.get());
+            }
+            break;
+        default:
+            if (visit(bloom_lib::target::value, scalar_text(*node))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+}
+
+bloom_lib::filter::filter(
+    const size_t items, const double false_positive_rate
+) {
+    if (!(false_positive_rate > 0.0 && false_positive_rate < 1.0)) {
+        throw std::invalid_argument("false positive rate must be in (0, 1)");
+    }
+    // Optimal size m = -n ln p / (ln 2)^2 and hash count k = m / n ln 2.
+    const double count = static_cast<double>(std::max<size_t>(items, 1));
+    const double bits_needed = -count * std::log(false_positive_rate)
+        / (std::numbers::ln2 * std::numbers::ln2);
+    bits.assign(
+        std::max<size_t>(1, static_cast<size_t>(std::ceil(bits_needed / 64))),
+        0
+    );
+    const double optimal = static_cast<double>(bits.size() * 64) / count
+        * std::numbers::ln2;
+    hash_count = std::clamp<uint32_t>(
+        static_cast<uint32_t>(std::lround(optimal)), 1, max_hashes
+    );
+}
+
+bloom_lib::filter::filter(std::vector<uint64_t> words, const uint32_t hashes)
+    : bits(std::move(words))
+    , hash_count(hashes) {
+    if (bits.empty() || hash_count == 0 || hash_count > max_hashes) {
+        throw std::invalid_argument("invalid bloom filter");
+    }
+}
+
+void bloom_lib::filter::add(const std::string_view item) {
+    const uint64_t first = fnv1a(item);
+    const uint64_t second = mix(first) | 1;
+    const uint64_t size = bits.size() * 64;
+    for (uint32_t i = 0; i < hash_count; ++i) {
+        const uint64_t bit = (first + i * second) % size;
+        bits[bit / 64] |= uint64_t { 1 } << (bit % 64);
+    }
+}
+
+bool bloom_lib::filter::may_contain(const std::string_view item) const {
+    const uint64_t first = fnv1a(item);
+    const uint64_t second = mix(first) | 1;
+    const uint64_t size = bits.size() * 64;
+    for (uint32_t i = 0; i < hash_count; ++i) {
+        const uint64_t bit = (first + i * second) % size;
+        if ((bits[bit / 64] & (uint64_t { 1 } << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::vector<uint64_t>& bloom_lib::filter::words() const { return bits; }
+
+uint32_t bloom_lib::filter::hashes() const { return hash_count; }
+
+bloom_lib::filter bloom_lib::summarize(const json_lib::json& document) {
+    // Collect first, so that the filter is sized by the distinct items.
+    std::unordered_set<std::string> items;
+    walk(document, [&items](const target kind, const std::string_view text) {
+        items.emplace(item_of(kind, text));
+        return false;
+    });
+    filter result(items.size());
+    for (const auto& item : items) {
+        result.add(item);
+    }
+    return result;
+}
+
+bool bloom_lib::may_match(const filter& summary, const needle& item) {
+    return summary.may_contain(item_of(item.kind, item.text));
+}
+
+bool bloom_lib::matches(const json_lib::json& document, const needle& item) {
+    return walk(
+        document,
+        [&item](const target kind, const std::string_view text) {
+            return kind == item.kind && text == item.text;
+        }
+    );
+}
+
+std::string bloom_lib::catalog::key_of(const std::filesystem::path& file) {
+    return std::filesystem::absolute(file).lexically_normal().string();
+}
+
+bloom_lib::catalog bloom_lib::catalog::read(const std::filesystem::path& path
+) {
+    catalog result;
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        return result;
+    }
+    const std::string bytes(
+        (std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()
+    );
+    binary_lib::reader in(bytes, "bloom catalog");
+    if (in.bytes(magic.size()) != magic || in.u32() != version) {
+        throw std::runtime_error("not a bloom catalog: " + path.string());
+    }
+    for (uint32_t count = in.u32(); count > 0; --count) {
+        std::string key(in.bytes(in.u32()));
+        index_lib::stamp stamp;
+        stamp.size = in.u64();
+        stamp.modified = static_cast<int64_t>(in.u64());
+        const uint32_t hashes = in.u32();
+        std::vector<uint64_t> words(in.count(in.u32(), 8));
+        for (auto& word : words) {
+            word = in.u64();
+        }
+        try {
+            filter summary(std::move(words), hashes);
+            result.entries.insert_or_assign(
+                std::move(key), entry { stamp, std::move(summary) }
+            );
+        } catch (const std::invalid_argument&) {
+            in.corrupt();
+        }
+    }
+    if (!in.done()) {
+        in.corrupt();
+    }
+    return result;
+}
+
+void bloom_lib::catalog::write(const std::filesystem::path& path) const {
+    std::string out(magic);
+    put_u32(out, version);
+    put_u32(out, static_cast<uint32_t>(entries.size()));
+    for (const auto& [key, value] : entries) {
+        put_u32(out, static_cast<uint32_t>(key.size()));
+        out += key;
+        put_u64(out, value.stamp.size);
+        put_u64(out, static_cast<uint64_t>(value.stamp.modified));
+        put_u32(out, value.summary.hashes());
+        put_u32(out, static_cast<uint32_t>(value.summary.words().size()));
+        for (const uint64_t word : value.summary.words()) {
+            put_u64(out, word);
+        }
+    }
+
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream ofs(temporary, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            throw std::invalid_argument(
+                "failed to open file with path: " + temporary.string()
+            );
+        }
+        ofs.write(out.data(), static_cast<std::streamsize>(out.size()));
+    }
+    std::filesystem::rename(temporary, path);
+}
+
+const bloom_lib::filter* bloom_lib::catalog::find(
+    const std::filesystem::path& file, const index_lib::stamp& stamp
+) const {
+    const auto found = entries.find(key_of(file));
+    if (found == entries.end() || !(found->second.stamp == stamp)) {
+        return nullptr;
+    }
+    return &found->second.summary;
+}
+
+void bloom_lib::catalog::record(
+    const std::filesystem::path& file, const index_lib::stamp& stamp,
+    filter summary
+) {
+    entries.insert_or_assign(key_of(file), entry { stamp, std::move(summary) });
+    dirty = true;
+}
+
+size_t bloom_lib::catalog::size() const { return entries.size(); }
+
+bool bloom_lib::catalog::modified() const { return dirty; }
@@ -0,0 +1,114 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "catalog.hpp"
+#include "metrics.hpp"
+#include "parser.hpp"
+
+catalog_lib::catalog::catalog(const size_t memory_limit)
+    : limit(memory_limit) { }
+
+std::string catalog_lib::catalog::key_of(const std::filesystem::path& path) {
+    return std::filesystem::absolute(path).lexically_normal().string();
+}
+
+void catalog_lib::catalog::drop(const std::list<entry>::iterator position) {
+    used -= position->memory;
+    index.erase(position->key);
+    recent.erase(position);
+}
+
+std::shared_ptr<json_lib::json>
+catalog_lib::catalog::get(const std::filesystem::path& path) {
+    const std::string key = key_of(path);
+    std::error_code error;
+    const auto modified = std::filesystem::last_write_time(path, error);
+    {
+        const std::lock_guard lock(mutex);
+        if (const auto found = index.find(key); found != index.end()) {
+            if (!error && found->second->modified == modified) {
+                recent.splice(recent.begin(), recent, found->second);
+                ++counters.hits;
+                if (metrics_lib::active_registry != nullptr) {
+                    metrics_lib::active_registry->cache_hits.add();
+                }
+                return found->second->document;
+            }
+            drop(found->second);
+        }
+    }
+
+    // Parse without holding the lock; a concurrent load of the same file
+    // simply replaces this one.
+    std::string buffer = parser_lib::read_file(path);
+    std::shared_ptr<json_lib::json> document;
+    parser_lib::parser(buffer).completely_parse_json(document);
+    const size_t memory = document->memory_usage();
+
+    const std::lock_guard lock(mutex);
+    ++counters.loads;
+    if (const auto found = index.find(key); found != index.end()) {
+        drop(found->second);
+    }
+    if (memory > limit) {
+        return document;
+    }
+    recent.emplace_front(key, document, memory, modified);
+    index.emplace(key, recent.begin());
+    used += memory;
+    while (used > limit) {
+        drop(std::prev(recent.end()));
+        ++counters.evictions;
+    }
+    return document;
+}
+
+bool catalog_lib::catalog::contains(const std::filesystem::path& path) const {
+    const std::lock_guard lock(mutex);
+    return index.contains(key_of(path));
+}
+
+void catalog_lib::catalog::erase(const std::filesystem::path& path) {
+    const std::lock_guard lock(mutex);
+    if (const auto found = index.find(key_of(path)); found != index.end()) {
+        drop(found->second);
+    }
+}
+
+size_t catalog_lib::catalog::size() const {
+    const std::lock_guard lock(mutex);
+    return index.size();
+}
+
+size_t catalog_lib::catalog::memory_usage() const {
+    const std::lock_guard lock(mutex);
+    return used;
+}
+
+size_t catalog_lib::catalog::memory_limit() const { return limit; }
+
+catalog_lib::catalog_stats catalog_lib::catalog::stats() const {
+    const std::lock_guard lock(mutex);
+    return counters;
+}
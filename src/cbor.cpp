@@ -0,0 +1,183 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cbor.hpp"
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+enum major : uint8_t {
+    unsigned_integer = 0,
+    negative_integer = 1,
+    text_string = 3,
+    array = 4,
+    map = 5,
+    simple = 7
+};
+
+constexpr size_t chunk_size = 64 * 1024;
+
+class encoder {
+public:
+    explicit encoder(std::ostream& os)
+        : os(os) {
+        buffer.reserve(chunk_size);
+    }
+
+    void put(const json_lib::json& value) {
+        if (buffer.size() >= chunk_size) {
+            flush();
+        }
+        switch (value.type()) {
+        case json_lib::json_type::null_json:
+            buffer += '\xF6';
+            break;
+        case json_lib::json_type::boolean_json:
+            buffer
+                += dynamic_cast<const json_lib::json_boolean&>(value).as_bool()
+                ? '\xF5'
+                : '\xF4';
+            break;
+        case json_lib::json_type::integer_json: {
+            const int integer
+                = dynamic_cast<const json_lib::json_integer&>(value).as_index();
+            if (integer >= 0) {
+                put_head(unsigned_integer, static_cast<uint64_t>(integer));
+            } else {
+                put_head(
+                    negative_integer, static_cast<uint64_t>(-(integer + 1))
+                );
+            }
+            break;
+        }
+        case json_lib::json_type::real_json:
+            put_real(std::strtod(value.to_string().c_str(), nullptr));
+            break;
+        case json_lib::json_type::string_json:
+            put_text(
+                dynamic_cast<const json_lib::json_string&>(value).as_key()
+            );
+            break;
+        case json_lib::json_type::array_json: {
+            const auto& items
+                = dynamic_cast<const json_lib::json_array&>(value).items();
+            put_head(array, items.size());
+            for (const auto& item : items) {
+                put(*item);
+            }
+            break;
+        }
+        case json_lib::json_type::object_json: {
+            const auto& items
+                = dynamic_cast<const json_lib::json_object&>(value).items();
+            put_head(map, items.size());
+            for (const auto& [key, item] : items) {
+                put_text(key);
+                put(*item);
+            }
+            break;
+        }
+        default:
+            throw std::invalid_argument(
+                "cannot encode a "
+                + json_lib::json_type_to_string(value.type()) + " as CBOR"
+            );
+        }
+    }
+
+    void flush() {
+        os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+private:
+    std::ostream& os;
+    std::string buffer;
+
+    void put_bytes(const uint64_t value, const int width) {
+        for (int shift = 8 * (width - 1); shift >= 0; shift -= 8) {
+            buffer += static_cast<char>((value >> shift) & 0xFF);
+        }
+    }
+
+    /**
+     * Initial byte of a data item with its argument in the shortest form.
+     */
+    void put_head(const major type, const uint64_t argument) {
+        const auto initial = static_cast<uint8_t>(type << 5);
+        if (argument < 24) {
+            buffer += static_cast<char>(initial | argument);
+        } else if (argument <= 0xFF) {
+            buffer += static_cast<char>(initial | 24);
+            put_bytes(argument, 1);
+        } else if (argument <= 0xFFFF) {
+            buffer += static_cast<char>(initial | 25);
+            put_bytes(argument, 2);
+        } else if (argument <= 0xFFFFFFFF) {
+            buffer += static_cast<char>(initial | 26);
+            put_bytes(argument, 4);
+        } else {
+            buffer += static_cast<char>(initial | 27);
+            put_bytes(argument, 8);
+        }
+    }
+
+    void put_text(const std::string& text) {
+        put_head(text_string, text.size());
+        buffer += text;
+    }
+
+    void put_real(const double real) {
+        const auto bits = std::bit_cast<uint64_t>(real);
+        if (std::abs(real) <= std::numeric_limits<float>::max()) {
+            const auto single = static_cast<float>(real);
+            if (std::bit_cast<uint64_t>(static_cast<double>(single)) == bits) {
+                buffer += static_cast<char>(simple << 5 | 26);
+                put_bytes(std::bit_cast<uint32_t>(single), 4);
+                return;
+            }
+        }
+        buffer += static_cast<char>(simple << 5 | 27);
+        put_bytes(bits, 8);
+    }
+};
+}
+
+void cbor_lib::write(const json_lib::json& value, std::ostream& os) {
+    encoder output(os);
+    output.put(value);
+    output.flush();
+}
+
+std::string cbor_lib::encode(const json_lib::json& value) {
+    std::ostringstream oss;
+    write(value, oss);
+    return std::move(oss).str();
+}
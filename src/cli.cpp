@@ -0,0 +1,360 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cli.hpp"
+#include "files.hpp"
+#include "msgpack.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+size_t parse_count(const std::string& option, const std::string& value) {
+    size_t pos = 0;
+    unsigned long count = 0;
+    if (!value.empty() && std::isdigit(static_cast<unsigned char>(value[0]))) {
+        try {
+            count = std::stoul(value, &pos);
+        } catch (const std::out_of_range&) {
+            pos = 0;
+        }
+    }
+    if (pos == 0 || pos != value.size() || count == 0) {
+        throw std::invalid_argument(
+            "option `" + option + "` expects a positive integer"
+        );
+    }
+    return count;
+}
+
+/**
+ * Name of the first option in `result` that only the evaluation of a
+ * single document honors, or an empty string if there is none.
+ */
+std::string single_document_option(const cli_lib::options& result) {
+    if (!result.limits.unlimited()) {
+        return "--max-*";
+    }
+    if (result.timeout.count() != 0) {
+        return "--timeout";
+    }
+    if (!result.metrics.empty()) {
+        return "--metrics";
+    }
+    if (!result.trace.empty()) {
+        return "--trace";
+    }
+    if (result.stats) {
+        return "--stats";
+    }
+    if (result.bench > 0) {
+        return "--bench";
+    }
+    if (result.explain != cli_lib::explain_mode::none) {
+        return "--explain";
+    }
+    if (result.column_cache > 0) {
+        return "--column-cache";
+    }
+    if (!result.output_shm.empty()) {
+        return "--output-shm";
+    }
+    if (result.output_format != cli_lib::data_format::json) {
+        return "--output";
+    }
+    return {};
+}
+}
+
+cli_lib::data_format cli_lib::parse_format(const std::string& name) {
+    if (name == "json") {
+        return data_format::json;
+    }
+    if (name == "msgpack") {
+        return data_format::msgpack;
+    }
+    if (name == "cbor") {
+        return data_format::cbor;
+    }
+    throw std::invalid_argument("unknown format `" + name + "`");
+}
+
+cli_lib::options
+cli_lib::parse_options(const int argc, const char* const argv[]) {
+    options result;
+    std::vector<std::string> positional;
+    bool compile = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(
+                    "option `" + arg + "` expects a value"
+                );
+            }
+            return argv[++i];
+        };
+        if (arg == "--stats") {
+            result.stats = true;
+        } else if (arg == "--explain") {
+            result.explain = explain_mode::plan;
+        } else if (arg == "--explain-analyze") {
+            result.explain = explain_mode::analyze;
+        } else if (arg == "--trace") {
+            result.trace = value();
+        } else if (arg == "--trace-elements") {
+            result.trace_elements = true;
+        } else if (arg == "--bench") {
+            result.bench = parse_count(arg, value());
+        } else if (arg == "--bench-parse") {
+            result.bench_parse = true;
+        } else if (arg == "--metrics") {
+            result.metrics = value();
+        } else if (arg == "--max-input-bytes") {
+            result.limits.max_input_bytes = parse_count(arg, value());
+        } else if (arg == "--max-depth") {
+            result.limits.max_depth = parse_count(arg, value());
+        } else if (arg == "--max-nodes") {
+            result.limits.max_nodes = parse_count(arg, value());
+        } else if (arg == "--max-memory") {
+            result.limits.max_memory = parse_count(arg, value());
+        } else if (arg == "--max-steps") {
+            result.limits.max_steps = parse_count(arg, value());
+        } else if (arg == "--max-time") {
+            result.limits.max_time = std::chrono::milliseconds(
+                parse_count(arg, value())
+            );
+        } else if (arg == "--timeout") {
+            result.timeout = std::chrono::milliseconds(
+                parse_count(arg, value())
+            );
+        } else if (arg == "--compile") {
+            compile = true;
+        } else if (arg == "--shred") {
+            result.shred = value();
+        } else if (arg == "--build-guide") {
+            result.build_guide = true;
+        } else if (arg == "--infer-schema") {
+            result.infer_schema = true;
+        } else if (arg == "--build-index") {
+            result.build_index = parse_count(arg, value());
+        } else if (arg == "--input-format") {
+            result.input_format = parse_format(value());
+            if (result.input_format == data_format::cbor) {
+                throw std::invalid_argument("CBOR input is not supported");
+            }
+            result.format_by_extension = false;
+        } else if (arg == "--output") {
+            result.output_format = parse_format(value());
+        } else if (arg == "--column-cache") {
+            result.column_cache = parse_count(arg, value());
+        } else if (arg == "--catalog") {
+            result.catalog = value();
+        } else if (arg == "--find-key") {
+            result.find = bloom_lib::needle { bloom_lib::target::key, value() };
+        } else if (arg == "--find-value") {
+            result.find
+                = bloom_lib::needle { bloom_lib::target::value, value() };
+        } else if (arg == "--threads") {
+            result.threads = parse_count(arg, value());
+        } else if (arg == "--parallel") {
+            result.parallel = parse_count(arg, value());
+        } else if (arg == "--output-shm") {
+            result.output_shm = value();
+            static_cast<void>(cli_lib::output_fd(result.output_shm));
+        } else if (arg.starts_with("--")) {
+            throw std::invalid_argument("unknown option `" + arg + "`");
+        } else {
+            positional.emplace_back(arg);
+        }
+    }
+    if (result.format_by_extension && !positional.empty()
+        && msgpack_lib::has_extension(positional.front())) {
+        result.input_format = data_format::msgpack;
+    }
+    if (result.input_format != data_format::json && result.parallel > 0) {
+        throw std::invalid_argument("option `--parallel` expects JSON text");
+    }
+    if (const auto option = single_document_option(result);
+        result.parallel > 0 && !option.empty()) {
+        throw std::invalid_argument(
+            "option `" + option + "` is not supported with `--parallel`"
+        );
+    }
+    if (result.input_format != data_format::json && result.infer_schema) {
+        throw std::invalid_argument(
+            "option `--infer-schema` expects JSON text"
+        );
+    }
+    if (compile) {
+        if (positional.size() != 2) {
+            throw std::invalid_argument(
+                "option `--compile` expects <json-file> and <snapshot-file>"
+            );
+        }
+        result.input = positional[0];
+        result.inputs = { result.input };
+        result.compile = positional[1];
+        return result;
+    }
+    if (result.build_index > 0 || result.build_guide) {
+        if (positional.size() != 1) {
+            throw std::invalid_argument(
+                std::string("option `")
+                + (result.build_guide ? "--build-guide" : "--build-index")
+                + "` expects a single <json-file>"
+            );
+        }
+        result.input = positional[0];
+        result.inputs = { result.input };
+        return result;
+    }
+    if (result.find || result.infer_schema) {
+        if (positional.empty()) {
+            throw std::invalid_argument(
+                result.find
+                    ? "option `--find-key`/`--find-value` expects <json-file>s"
+                    : "option `--infer-schema` expects <json-file>s"
+            );
+        }
+        result.inputs.assign(positional.begin(), positional.end());
+        result.input = result.inputs.front();
+        return result;
+    }
+    if (positional.size() < 2) {
+        throw std::invalid_argument(
+            "expected <json-file> and \"<expression>\""
+        );
+    }
+    result.expression = positional.back();
+    positional.pop_back();
+    result.inputs.assign(positional.begin(), positional.end());
+    result.input = result.inputs.front();
+    if (result.inputs.size() > 1 || files_lib::is_collection(result.input)) {
+        auto option = single_document_option(result);
+        if (option.empty() && result.parallel > 0) {
+            option = "--parallel";
+        }
+        if (!option.empty()) {
+            throw std::invalid_argument(
+                "option `" + option + "` is not supported with several inputs"
+            );
+        }
+    }
+    return result;
+}
+
+std::optional<int> cli_lib::output_fd(const std::string_view target) {
+    constexpr std::string_view prefix = "fd:";
+    if (!target.starts_with(prefix)) {
+        return std::nullopt;
+    }
+    const std::string_view digits = target.substr(prefix.size());
+    int fd = 0;
+    const auto [end, error]
+        = std::from_chars(digits.data(), digits.data() + digits.size(), fd);
+    if (digits.empty() || error != std::errc {}
+        || end != digits.data() + digits.size() || fd < 0) {
+        throw std::invalid_argument(
+            "option `--output-shm` expects fd:<n> or a path"
+        );
+    }
+    return fd;
+}
+
+std::string cli_lib::usage(const std::string& program) {
+    std::string result
+        = "Usage: " + program
+        + " [options] <json-file>... \"<expression>\"\n"
+          "A <json-file> may also be a directory or a pattern such as "
+          "'logs/*.json';\n"
+          "several files print one `file<TAB>result` line each.\n";
+    result += "Options:\n";
+    result += "  --stats            report run statistics to stderr as a JSON "
+              "object\n";
+    result += "  --explain          print the compiled expression instead of "
+              "evaluating it\n";
+    result += "  --explain-analyze  evaluate and print the plan with per-step "
+              "counters\n";
+    result += "  --trace <file>     write Chrome trace events of the run to "
+              "<file>\n";
+    result += "  --trace-elements   with --trace, add a span per top-level "
+              "element\n";
+    result += "  --bench <n>        evaluate <n> times and print latency "
+              "percentiles\n";
+    result += "  --bench-parse      with --bench, parse the document in every "
+              "repetition\n";
+    result += "  --metrics <target> write Prometheus metrics to a file or to "
+              "unix:<socket>\n";
+    result += "  --max-input-bytes <n>, --max-depth <n>, --max-nodes <n>,\n"
+              "  --max-memory <bytes>, --max-steps <n>, --max-time <ms>\n"
+              "                     fail as soon as an input or the query "
+              "exceeds the budget\n";
+    result += "  --timeout <ms>     cancel parsing and evaluation after <ms> "
+              "milliseconds\n";
+    result += "  --parallel <n>     evaluate each line of NDJSON or element of "
+              "a top-level\n"
+              "                     array in <n> forked worker processes\n";
+    result += "  --threads <n>      worker threads for multiple input files\n";
+    result += "  --catalog <file>   keep Bloom filter summaries of the parsed "
+              "input files in <file>\n";
+    result += "  --find-key <key>, --find-value <text>\n"
+              "                     print the inputs containing the key or "
+              "scalar value, parsing\n"
+              "                     only files whose --catalog summary may "
+              "match\n";
+    result += "  --column-cache <bytes>\n"
+              "                     keep columns gathered by `[*]` for later "
+              "evaluations, up to\n"
+              "                     <bytes> in total\n";
+    result += "  --compile <json-file> <snapshot-file>\n"
+              "                     write a binary snapshot that can be "
+              "queried without parsing\n";
+    result += "  --shred <file>     write the array selected by the expression "
+              "as a column store\n";
+    result += "  --build-index <depth> <json-file>\n"
+              "                     write <json-file>.idx with the offsets of "
+              "containers up to\n"
+              "                     <depth> levels, used to parse only the "
+              "subtree a path needs\n";
+    result += "  --build-guide <json-file>\n"
+              "                     write <json-file>.guide with the paths, "
+              "types and value ranges\n"
+              "                     of the document, used to reject missing "
+              "paths and answer\n"
+              "                     size(), min() and max() without reading "
+              "it\n";
+    result += "  --input-format <f>  read the input as `json` or `msgpack` "
+              "(default: by extension)\n";
+    result += "  --output <f>       write the result as `json`, `msgpack` or "
+              "`cbor`\n";
+    result += "  --output-shm <target>\n"
+              "                     write the result to shared memory "
+              "(fd:<n> or a path) and\n"
+              "                     print its size in bytes\n";
+    return result;
+}
@@ -0,0 +1,931 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "columnar.hpp"
+#include "binary.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+constexpr std::string_view magic = "JCOL";
+constexpr uint32_t version = 2;
+
+enum definition_level : uint8_t { empty_list, null_element, element_value };
+
+using binary_lib::put_u32;
+using binary_lib::put_u64;
+using binary_lib::put_u8;
+
+void put_text(std::string& out, const std::string& text) {
+    put_u32(out, static_cast<uint32_t>(text.size()));
+    out += text;
+}
+
+void put_bitmap(std::string& out, const columnar_lib::bitmap& bits) {
+    put_u64(out, bits.length);
+    for (const uint64_t word : bits.words) {
+        put_u64(out, word);
+    }
+}
+
+[[noreturn]] void corrupt() {
+    throw std::runtime_error("corrupt column store");
+}
+
+std::string read_text(binary_lib::reader& input) {
+    return std::string(input.bytes(input.u32()));
+}
+
+columnar_lib::bitmap read_bitmap(binary_lib::reader& input) {
+    columnar_lib::bitmap result;
+    result.length = input.u64();
+    result.words.resize(
+        input.count(result.length / 64 + (result.length % 64 != 0), 8)
+    );
+    for (auto& word : result.words) {
+        word = input.u64();
+    }
+    return result;
+}
+
+std::shared_ptr<json_lib::json> parse(std::string text) {
+    std::shared_ptr<json_lib::json> result;
+    parser_lib::parser(text).completely_parse_json(result);
+    return result;
+}
+
+enum kind : unsigned {
+    object_kind = 1,
+    boolean_kind = 2,
+    integer_kind = 4,
+    real_kind = 8,
+    string_kind = 16,
+    array_kind = 32
+};
+
+unsigned kind_of(const json_lib::json& value) {
+    switch (value.type()) {
+    case json_lib::json_type::null_json:
+        return 0;
+    case json_lib::json_type::boolean_json:
+        return boolean_kind;
+    case json_lib::json_type::integer_json:
+        return integer_kind;
+    case json_lib::json_type::real_json:
+        return real_kind;
+    case json_lib::json_type::string_json:
+        return string_kind;
+    case json_lib::json_type::array_json:
+        return array_kind;
+    case json_lib::json_type::object_json:
+        return object_kind;
+    default:
+        throw std::invalid_argument(
+            "cannot shred a " + json_lib::json_type_to_string(value.type())
+        );
+    }
+}
+
+columnar_lib::column_type scalar_type(const unsigned kinds) {
+    switch (kinds) {
+    case boolean_kind:
+        return columnar_lib::column_type::boolean;
+    case integer_kind:
+        return columnar_lib::column_type::integer;
+    case real_kind:
+        return columnar_lib::column_type::real;
+    case string_kind:
+        return columnar_lib::column_type::string;
+    default:
+        return columnar_lib::column_type::json;
+    }
+}
+
+/**
+ * Two passes over the records: the first collects every key path with the
+ * kinds of values seen there, which fixes the column types; the second
+ * appends every record to the columns.
+ */
+class shredder {
+public:
+    std::vector<columnar_lib::column> columns;
+
+    explicit shredder(const json_lib::json_array& records) {
+        nodes.emplace_back();
+        for (const auto& record : records.items()) {
+            observe(0, *record);
+        }
+        column_of.assign(nodes.size(), 0);
+        dictionaries.clear();
+        add_column(0, {});
+        for (const auto& record : records.items()) {
+            fill(0, record.get());
+        }
+    }
+
+private:
+    struct node {
+        std::vector<std::pair<std::string, size_t>> children;
+        std::unordered_map<std::string, size_t> positions;
+        unsigned kinds = 0;
+        unsigned elements = 0; ///< Kinds of array elements; `~0u` if mixed.
+    };
+
+    std::vector<node> nodes;
+    std::vector<size_t> column_of;
+    std::vector<std::unordered_map<std::string, uint32_t>> dictionaries;
+
+    size_t child(const size_t parent, const std::string& key) {
+        if (const auto it = nodes[parent].positions.find(key);
+            it != nodes[parent].positions.end()) {
+            return nodes[parent].children[it->second].second;
+        }
+        const size_t index = nodes.size();
+        nodes[parent].positions.emplace(key, nodes[parent].children.size());
+        nodes[parent].children.emplace_back(key, index);
+        nodes.emplace_back();
+        return index;
+    }
+
+    void observe(const size_t index, const json_lib::json& value) {
+        const unsigned kind = kind_of(value);
+        nodes[index].kinds |= kind;
+        if (kind == object_kind) {
+            const auto& object = dynamic_cast<const json_lib::json_object&>(
+                value
+            );
+            for (const auto& [key, item] : object.items()) {
+                observe(child(index, key), *item);
+            }
+        } else if (kind == array_kind) {
+            const auto& array = dynamic_cast<const json_lib::json_array&>(
+                value
+            );
+            for (const auto& item : array.items()) {
+                const unsigned element = kind_of(*item);
+                nodes[index].elements
+                    |= (element == object_kind || element == array_kind)
+                    ? ~0u
+                    : element;
+            }
+        }
+    }
+
+    void add_column(const size_t index, std::vector<std::string> path) {
+        const node& current = nodes[index];
+        columnar_lib::column result;
+        result.path = std::move(path);
+        if (current.kinds == 0) {
+            result.type = columnar_lib::column_type::null;
+        } else if (current.kinds == object_kind) {
+            result.type = columnar_lib::column_type::object;
+        } else if (current.kinds == array_kind) {
+            result.element = current.elements == 0
+                ? columnar_lib::column_type::null
+                : scalar_type(current.elements);
+            result.type = result.element == columnar_lib::column_type::json
+                ? columnar_lib::column_type::json
+                : columnar_lib::column_type::list;
+        } else {
+            result.type = scalar_type(current.kinds);
+        }
+        column_of[index] = columns.size();
+        const bool nested = result.type == columnar_lib::column_type::object;
+        const auto prefix = result.path;
+        columns.emplace_back(std::move(result));
+        dictionaries.emplace_back();
+        if (!nested) {
+            return;
+        }
+        for (const auto& [key, position] : nodes[index].children) {
+            auto child_path = prefix;
+            child_path.emplace_back(key);
+            add_column(position, std::move(child_path));
+        }
+    }
+
+    uint32_t intern(const size_t column, const std::string& text) {
+        auto& codes = dictionaries[column];
+        auto& dictionary = columns[column].dictionary;
+        const auto [it, inserted] = codes.emplace(
+            text, static_cast<uint32_t>(dictionary.size())
+        );
+        if (inserted) {
+            dictionary.emplace_back(text);
+        }
+        return it->second;
+    }
+
+    /**
+     * Append one slot of `type`; `value` is `nullptr` for a default slot.
+     */
+    void put_slot(
+        const size_t index, const columnar_lib::column_type type,
+        const json_lib::json* value
+    ) {
+        auto& target = columns[index];
+        switch (type) {
+        case columnar_lib::column_type::boolean: {
+            const auto* boolean
+                = dynamic_cast<const json_lib::json_boolean*>(value);
+            target.booleans.push_back(boolean != nullptr && boolean->as_bool());
+            break;
+        }
+        case columnar_lib::column_type::integer:
+            target.integers.emplace_back(
+                value == nullptr
+                    ? 0
+                    : dynamic_cast<const json_lib::json_integer&>(*value)
+                          .as_index()
+            );
+            break;
+        case columnar_lib::column_type::real: {
+            // The value for computing, the literal for printing it back.
+            const std::string text
+                = value == nullptr ? std::string() : value->to_string();
+            target.reals.emplace_back(
+                value == nullptr ? 0.0 : std::strtod(text.c_str(), nullptr)
+            );
+            target.codes.emplace_back(
+                value == nullptr ? 0 : intern(index, text)
+            );
+            break;
+        }
+        case columnar_lib::column_type::string:
+            target.codes.emplace_back(
+                value == nullptr
+                    ? 0
+                    : intern(
+                        index,
+                        dynamic_cast<const json_lib::json_string&>(*value)
+                            .as_key()
+                    )
+            );
+            break;
+        case columnar_lib::column_type::json:
+            target.codes.emplace_back(
+                value == nullptr ? 0 : intern(index, value->to_string())
+            );
+            break;
+        default:
+            break;
+        }
+    }
+
+    void fill(const size_t index, const json_lib::json* value) {
+        const size_t target = column_of[index];
+        const bool valid = value != nullptr
+            && value->type() != json_lib::json_type::null_json;
+        columns[target].present.push_back(value != nullptr);
+        columns[target].valid.push_back(valid);
+
+        switch (columns[target].type) {
+        case columnar_lib::column_type::object: {
+            const auto& children = nodes[index].children;
+            std::vector<const json_lib::json*> members(children.size());
+            std::string order;
+            if (valid) {
+                const auto& object
+                    = dynamic_cast<const json_lib::json_object&>(*value);
+                for (const auto& [key, item] : object.items()) {
+                    const size_t position = nodes[index].positions.at(key);
+                    members[position] = item.get();
+                    put_u32(order, static_cast<uint32_t>(position));
+                }
+            }
+            columns[target].codes.emplace_back(intern(target, order));
+            for (size_t i = 0; i < children.size(); ++i) {
+                fill(children[i].second, members[i]);
+            }
+            break;
+        }
+        case columnar_lib::column_type::list: {
+            if (!valid) {
+                break;
+            }
+            const auto& items
+                = dynamic_cast<const json_lib::json_array&>(*value).items();
+            const auto element = columns[target].element;
+            if (items.empty()) {
+                columns[target].repetition.emplace_back(0);
+                columns[target].definition.emplace_back(empty_list);
+                put_slot(target, element, nullptr);
+            }
+            for (size_t i = 0; i < items.size(); ++i) {
+                const bool is_null
+                    = items[i]->type() == json_lib::json_type::null_json;
+                columns[target].repetition.emplace_back(i == 0 ? 0 : 1);
+                columns[target].definition.emplace_back(
+                    is_null ? null_element : element_value
+                );
+                put_slot(target, element, is_null ? nullptr : items[i].get());
+            }
+            break;
+        }
+        default:
+            put_slot(target, columns[target].type, valid ? value : nullptr);
+        }
+    }
+};
+
+size_t slot_count(const columnar_lib::column& source) {
+    switch (
+        source.type == columnar_lib::column_type::list ? source.element
+                                                       : source.type
+    ) {
+    case columnar_lib::column_type::boolean:
+        return source.booleans.size();
+    case columnar_lib::column_type::integer:
+        return source.integers.size();
+    case columnar_lib::column_type::real:
+        return source.reals.size();
+    case columnar_lib::column_type::object:
+    case columnar_lib::column_type::string:
+    case columnar_lib::column_type::json:
+        return source.codes.size();
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Decode slot `slot` of a scalar, list element or JSON column.
+ */
+std::shared_ptr<json_lib::json> slot_value(
+    const columnar_lib::column& source, const columnar_lib::column_type type,
+    const size_t slot
+) {
+    switch (type) {
+    case columnar_lib::column_type::boolean:
+        return std::make_shared<json_lib::json_boolean>(source.booleans[slot]);
+    case columnar_lib::column_type::integer:
+        return std::make_shared<json_lib::json_integer>(source.integers[slot]);
+    case columnar_lib::column_type::real:
+        return std::make_shared<json_lib::json_real>(
+            source.dictionary.at(source.codes[slot])
+        );
+    case columnar_lib::column_type::string:
+        return std::make_shared<json_lib::json_string>(
+            source.dictionary.at(source.codes[slot])
+        );
+    case columnar_lib::column_type::json:
+        return parse(source.dictionary.at(source.codes[slot]));
+    default:
+        return std::make_shared<json_lib::json>();
+    }
+}
+}
+
+void columnar_lib::bitmap::push_back(const bool bit) {
+    if (length % 64 == 0) {
+        words.emplace_back(0);
+    }
+    if (bit) {
+        words.back() |= uint64_t { 1 } << (length % 64);
+    }
+    ++length;
+}
+
+bool columnar_lib::bitmap::operator[](const size_t index) const {
+    return (words[index / 64] >> (index % 64) & 1) != 0;
+}
+
+size_t columnar_lib::bitmap::size() const { return length; }
+
+columnar_lib::table
+columnar_lib::table::shred(const json_lib::json_array& records) {
+    table result;
+    result.row_count = records.size();
+    result.data = shredder(records).columns;
+    result.link();
+    return result;
+}
+
+columnar_lib::table
+columnar_lib::table::read(const std::filesystem::path& path) {
+    return decode(parser_lib::read_file(path));
+}
+
+columnar_lib::table columnar_lib::table::decode(const std::string_view bytes) {
+    binary_lib::reader input(bytes, "column store");
+    if (input.bytes(std::min(bytes.size(), magic.size())) != magic
+        || input.u32() != version) {
+        throw std::runtime_error("not a column store");
+    }
+    table result;
+    result.row_count = input.u64();
+    const uint32_t count = input.u32();
+    for (uint32_t i = 0; i < count; ++i) {
+        column source;
+        source.path.resize(input.count(input.u64(), 4));
+        for (auto& key : source.path) {
+            key = read_text(input);
+        }
+        const uint8_t type = input.u8();
+        const uint8_t element = input.u8();
+        if (type > static_cast<uint8_t>(column_type::json)
+            || element > static_cast<uint8_t>(column_type::json)) {
+            corrupt();
+        }
+        source.type = static_cast<column_type>(type);
+        source.element = static_cast<column_type>(element);
+        source.present = read_bitmap(input);
+        source.valid = read_bitmap(input);
+        source.integers.resize(input.count(input.u64(), 4));
+        for (auto& value : source.integers) {
+            value = static_cast<int32_t>(input.u32());
+        }
+        source.reals.resize(input.count(input.u64(), 8));
+        for (auto& value : source.reals) {
+            value = std::bit_cast<double>(input.u64());
+        }
+        source.booleans = read_bitmap(input);
+        source.codes.resize(input.count(input.u64(), 4));
+        for (auto& value : source.codes) {
+            value = input.u32();
+        }
+        source.dictionary.resize(input.count(input.u64(), 4));
+        for (auto& value : source.dictionary) {
+            value = read_text(input);
+        }
+        const auto repetition = input.bytes(input.count(input.u64(), 1));
+        source.repetition.assign(repetition.begin(), repetition.end());
+        const auto definition = input.bytes(input.count(input.u64(), 1));
+        source.definition.assign(definition.begin(), definition.end());
+        result.data.emplace_back(std::move(source));
+    }
+    if (!input.done()) {
+        corrupt();
+    }
+    result.link();
+    return result;
+}
+
+std::string columnar_lib::table::encode() const {
+    std::string out(magic);
+    put_u32(out, version);
+    put_u64(out, row_count);
+    put_u32(out, static_cast<uint32_t>(data.size()));
+    for (const auto& source : data) {
+        put_u64(out, source.path.size());
+        for (const auto& key : source.path) {
+            put_text(out, key);
+        }
+        put_u8(out, static_cast<uint8_t>(source.type));
+        put_u8(out, static_cast<uint8_t>(source.element));
+        put_bitmap(out, source.present);
+        put_bitmap(out, source.valid);
+        put_u64(out, source.integers.size());
+        for (const int32_t value : source.integers) {
+            put_u32(out, static_cast<uint32_t>(value));
+        }
+        put_u64(out, source.reals.size());
+        for (const double value : source.reals) {
+            put_u64(out, std::bit_cast<uint64_t>(value));
+        }
+        put_bitmap(out, source.booleans);
+        put_u64(out, source.codes.size());
+        for (const uint32_t value : source.codes) {
+            put_u32(out, value);
+        }
+        put_u64(out, source.dictionary.size());
+        for (const auto& value : source.dictionary) {
+            put_text(out, value);
+        }
+        put_u64(out, source.repetition.size());
+        out.append(source.repetition.begin(), source.repetition.end());
+        put_u64(out, source.definition.size());
+        out.append(source.definition.begin(), source.definition.end());
+    }
+    return out;
+}
+
+void columnar_lib::table::write(const std::filesystem::path& path) const {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        throw std::invalid_argument(
+            "failed to open file with path: " + path.string()
+        );
+    }
+    const std::string bytes = encode();
+    ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+/**
+ * Derive the child lists and list entry offsets, checking along the way
+ * that every vector has the size its column type implies, so that reads
+ * need no further checks.
+ */
+void columnar_lib::table::link() {
+    if (data.empty() || !data[0].path.empty()) {
+        corrupt();
+    }
+    std::map<std::vector<std::string>, size_t> positions;
+    for (size_t i = 0; i < data.size(); ++i) {
+        auto& source = data[i];
+        if (source.present.size() != row_count
+            || source.valid.size() != row_count
+            || !positions.emplace(source.path, i).second) {
+            corrupt();
+        }
+        if (i > 0) {
+            auto parent_path = source.path;
+            parent_path.pop_back();
+            const auto parent = positions.find(parent_path);
+            if (parent == positions.end()
+                || data[parent->second].type != column_type::object) {
+                corrupt();
+            }
+            data[parent->second].children.emplace_back(i);
+        }
+
+        size_t slots = row_count;
+        if (source.type == column_type::list) {
+            if (source.definition.size() != source.repetition.size()) {
+                corrupt();
+            }
+            source.starts.assign(row_count + 1, 0);
+            size_t entry = 0;
+            for (size_t row = 0; row < row_count; ++row) {
+                source.starts[row] = entry;
+                if (!source.valid[row]) {
+                    continue;
+                }
+                if (entry >= source.repetition.size()
+                    || source.repetition[entry] != 0) {
+                    corrupt();
+                }
+                do {
+                    if (source.definition[entry] > element_value) {
+                        corrupt();
+                    }
+                    ++entry;
+                } while (entry < source.repetition.size()
+                         && source.repetition[entry] == 1);
+            }
+            source.starts[row_count] = entry;
+            if (entry != source.repetition.size()) {
+                corrupt();
+            }
+            slots = source.element == column_type::null ? 0 : entry;
+        } else if (source.type == column_type::null) {
+            slots = 0;
+        }
+        const auto scalar
+            = source.type == column_type::list ? source.element : source.type;
+        if (slot_count(source) != slots
+            || (scalar == column_type::real
+                && source.codes.size() != source.reals.size())
+            || std::ranges::any_of(source.codes, [&](const uint32_t code) {
+                   return code > 0 && code >= source.dictionary.size();
+               })) {
+            corrupt();
+        }
+    }
+}
+
+size_t columnar_lib::table::rows() const { return row_count; }
+
+const std::vector<columnar_lib::column>&
+columnar_lib::table::columns() const {
+    return data;
+}
+
+const columnar_lib::column*
+columnar_lib::table::find(const std::vector<std::string>& path) const {
+    const auto it = std::ranges::find(data, path, &column::path);
+    return it == data.end() ? nullptr : &*it;
+}
+
+std::shared_ptr<json_lib::json>
+columnar_lib::table::rebuild(const column& source, const size_t row) const {
+    if (!source.present[row]) {
+        return nullptr;
+    }
+    if (!source.valid[row]) {
+        return std::make_shared<json_lib::json>();
+    }
+    switch (source.type) {
+    case column_type::object: {
+        std::vector<std::pair<std::string, std::shared_ptr<json_lib::json>>>
+            items;
+        const std::string& order = source.dictionary.at(source.codes[row]);
+        for (size_t i = 0; i + 4 <= order.size(); i += 4) {
+            uint32_t position = 0;
+            for (size_t byte = 0; byte < 4; ++byte) {
+                position |= static_cast<uint32_t>(
+                                static_cast<uint8_t>(order[i + byte])
+                            )
+                    << (8 * byte);
+            }
+            const column& child = data[source.children.at(position)];
+            auto value = rebuild(child, row);
+            if (value == nullptr) {
+                corrupt();
+            }
+            items.emplace_back(child.path.back(), std::move(value));
+        }
+        return std::make_shared<json_lib::json_object>(items);
+    }
+    case column_type::list: {
+        std::vector<std::shared_ptr<json_lib::json>> items;
+        for (size_t entry = source.starts[row]; entry < source.starts[row + 1];
+             ++entry) {
+            if (source.definition[entry] == empty_list) {
+                break;
+            }
+            items.emplace_back(
+                source.definition[entry] == null_element
+                    ? std::make_shared<json_lib::json>()
+                    : slot_value(source, source.element, entry)
+            );
+        }
+        return std::make_shared<json_lib::json_array>(items);
+    }
+    default:
+        return slot_value(source, source.type, row);
+    }
+}
+
+std::shared_ptr<json_lib::json>
+columnar_lib::table::record(const size_t row) const {
+    if (row >= row_count) {
+        throw std::out_of_range("index out of range");
+    }
+    return rebuild(data[0], row);
+}
+
+std::shared_ptr<json_lib::json> columnar_lib::table::materialize() const {
+    std::vector<std::shared_ptr<json_lib::json>> items;
+    items.reserve(row_count);
+    for (size_t row = 0; row < row_count; ++row) {
+        items.emplace_back(rebuild(data[0], row));
+    }
+    return std::make_shared<json_lib::json_array>(items);
+}
+
+std::shared_ptr<json_lib::json> columnar_lib::table::value(
+    const size_t row, const std::vector<std::shared_ptr<json_lib::json>>& path
+) const {
+    if (row >= row_count) {
+        throw std::out_of_range("index out of range");
+    }
+    const column* current = &data[0];
+    size_t consumed = 0;
+    for (; consumed < path.size(); ++consumed) {
+        const auto& accessor = path[consumed];
+        if (current->type != column_type::object || !current->valid[row]
+            || accessor->type() != json_lib::json_type::string_json) {
+            break;
+        }
+        const auto& key
+            = std::dynamic_pointer_cast<json_lib::json_string>(accessor)
+                  ->as_key();
+        const auto child = std::ranges::find_if(
+            current->children,
+            [&](const size_t index) { return data[index].path.back() == key; }
+        );
+        if (child == current->children.end() || !data[*child].present[row]) {
+            break;
+        }
+        current = &data[*child];
+    }
+
+    if (consumed + 1 == path.size() && current->type == column_type::list
+        && current->valid[row]
+        && path[consumed]->type() == json_lib::json_type::integer_json) {
+        const size_t begin = current->starts[row];
+        const size_t end = current->starts[row + 1];
+        const bool empty = current->definition[begin] == empty_list;
+        int index = std::dynamic_pointer_cast<json_lib::json_integer>(
+                        path[consumed]
+        )
+                        ->as_index();
+        if (json_lib::enable_negative_indexing && index < 0 && !empty) {
+            index += static_cast<int>(end - begin);
+        }
+        if (!empty && index >= 0 && static_cast<size_t>(index) < end - begin) {
+            const size_t entry = begin + static_cast<size_t>(index);
+            return current->definition[entry] == null_element
+                ? std::make_shared<json_lib::json>()
+                : slot_value(*current, current->element, entry);
+        }
+    }
+
+    auto result = rebuild(*current, row);
+    for (; consumed < path.size(); ++consumed) {
+        result = result->by(path[consumed]);
+    }
+    return result;
+}
+
+std::shared_ptr<json_lib::json_array>
+columnar_lib::table::project(const std::vector<std::string>& path) const {
+    std::vector<std::shared_ptr<json_lib::json>> items;
+    if (const column* source = find(path)) {
+        for (size_t row = 0; row < row_count; ++row) {
+            if (auto value = rebuild(*source, row)) {
+                items.emplace_back(std::move(value));
+            }
+        }
+    }
+    return std::make_shared<json_lib::json_array>(items);
+}
+
+std::optional<int> columnar_lib::table::extreme(
+    const std::vector<std::string>& path, const bool maximum
+) const {
+    const column* source = find(path);
+    if (source == nullptr || source->type != column_type::integer) {
+        return std::nullopt;
+    }
+    std::optional<int> result;
+    for (size_t row = 0; row < row_count; ++row) {
+        if (!source->present[row]) {
+            continue;
+        }
+        if (!source->valid[row]) {
+            return std::nullopt;
+        }
+        const int value = source->integers[row];
+        if (!result || (maximum ? value > *result : value < *result)) {
+            result = value;
+        }
+    }
+    return result;
+}
+
+bool columnar_lib::is_table(const std::filesystem::path& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    std::string head(magic.size(), '\0');
+    return ifs.read(head.data(), static_cast<std::streamsize>(head.size()))
+        && head == magic;
+}
+
+namespace {
+bool is_root(const std::shared_ptr<json_lib::json>& expression) {
+    if (expression->type() != json_lib::json_type::reference_json) {
+        return false;
+    }
+    const auto reference
+        = std::dynamic_pointer_cast<reference_lib::json_reference>(expression);
+    return reference->reference_type()
+        == reference_lib::json_reference_type::reference_json
+        && reference->get_head_type() == reference_lib::ref_head_type::root
+        && reference->get_tail().empty();
+}
+
+/**
+ * @brief The keys of `$[*].a.b`, or nothing for other expressions.
+ */
+std::optional<std::vector<std::string>>
+projected_path(const reference_lib::json_reference& reference) {
+    if (reference.reference_type()
+            != reference_lib::json_reference_type::reference_json
+        || reference.get_head_type() != reference_lib::ref_head_type::root
+        || reference.get_tail().size() != 1
+        || reference.get_tail().front()->type()
+            != json_lib::json_type::reference_json) {
+        return std::nullopt;
+    }
+    const auto projection
+        = std::dynamic_pointer_cast<reference_lib::json_reference>(
+            reference.get_tail().front()
+        );
+    if (projection->reference_type()
+            != reference_lib::json_reference_type::projection_json
+        || projection->get_tail().empty()) {
+        return std::nullopt;
+    }
+    std::vector<std::string> path;
+    for (const auto& accessor : projection->get_tail()) {
+        if (accessor->type() != json_lib::json_type::string_json) {
+            return std::nullopt;
+        }
+        path.emplace_back(
+            std::dynamic_pointer_cast<json_lib::json_string>(accessor)
+                ->as_key()
+        );
+    }
+    return path;
+}
+
+std::optional<std::vector<std::string>>
+projected_path(const std::shared_ptr<json_lib::json>& expression) {
+    if (expression->type() != json_lib::json_type::reference_json) {
+        return std::nullopt;
+    }
+    return projected_path(
+        dynamic_cast<const reference_lib::json_reference&>(*expression)
+    );
+}
+
+std::shared_ptr<json_lib::json> locate(
+    const columnar_lib::table& data,
+    const std::deque<std::shared_ptr<json_lib::json>>& tail
+) {
+    if (tail.empty()) {
+        return data.materialize();
+    }
+    if (tail.front()->type() == json_lib::json_type::integer_json) {
+        int row = std::dynamic_pointer_cast<json_lib::json_integer>(
+                      tail.front()
+        )
+                      ->as_index();
+        if (json_lib::enable_negative_indexing && row < 0) {
+            row += static_cast<int>(data.rows());
+        }
+        if (row >= 0 && static_cast<size_t>(row) < data.rows()) {
+            return data.value(
+                static_cast<size_t>(row),
+                std::vector<std::shared_ptr<json_lib::json>>(
+                    tail.begin() + 1, tail.end()
+                )
+            );
+        }
+    }
+    // Let the rebuilt array report the error.
+    auto result = data.materialize();
+    for (const auto& accessor : tail) {
+        result = result->by(accessor);
+    }
+    return result;
+}
+}
+
+std::shared_ptr<json_lib::json> columnar_lib::evaluate(
+    const table& data, const std::shared_ptr<json_lib::json>& expression
+) {
+    const auto resolved = reference_lib::resolve_paths(
+        expression,
+        [&](const reference_lib::json_reference& reference)
+            -> std::shared_ptr<json_lib::json> {
+            if (const auto path = projected_path(reference);
+                path && data.find(*path) != nullptr) {
+                return data.project(*path);
+            }
+            if (!reference_lib::is_constant_path(reference)) {
+                return nullptr;
+            }
+            return locate(data, reference.get_tail());
+        },
+        [&](const reference_lib::json_function& function)
+            -> std::shared_ptr<json_lib::json> {
+            if (function.get_name() == "size"
+                && function.get_args().size() == 1
+                && is_root(function.get_args()[0])) {
+                return std::make_shared<json_lib::json_integer>(
+                    static_cast<int>(data.rows())
+                );
+            }
+            const auto& name = function.get_name();
+            if ((name != "min" && name != "max")
+                || function.get_args().size() != 1) {
+                return nullptr;
+            }
+            const auto path = projected_path(function.get_args()[0]);
+            if (!path) {
+                return nullptr;
+            }
+            const auto result = data.extreme(*path, name == "max");
+            return result ? std::make_shared<json_lib::json_integer>(*result)
+                          : nullptr;
+        }
+    );
+    if (resolved) {
+        return reference_lib::evaluate(
+            resolved, std::make_shared<json_lib::json>()
+        );
+    }
+    return reference_lib::evaluate(expression, data.materialize());
+}
@@ -0,0 +1,529 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "dataguide.hpp"
+#include "binary.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+
+#include <bit>
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+using binary_lib::put_u32;
+using binary_lib::put_u64;
+
+constexpr std::string_view magic = "JDGD";
+constexpr uint32_t version = 1;
+constexpr size_t none = std::numeric_limits<size_t>::max();
+
+size_t type_index(const json_lib::json_type type) {
+    return static_cast<size_t>(type);
+}
+
+/**
+ * Trie of the paths seen so far; children are found by key or, for array
+ * elements, through the single `elements` edge.
+ */
+class builder {
+public:
+    builder() { nodes.emplace_back(); }
+
+    void add(const json_lib::json& document) {
+        std::vector<std::pair<const json_lib::json*, size_t>> stack {
+            { &document, 0 }
+        };
+        while (!stack.empty()) {
+            const auto [value, id] = stack.back();
+            stack.pop_back();
+            record(id, *value);
+            if (value->type() == json_lib::json_type::array_json) {
+                const size_t elements = element_of(id);
+                const auto& array
+                    = dynamic_cast<const json_lib::json_array&>(*value);
+                for (const auto& item : array.items()) {
+                    stack.emplace_back(item.get(), elements);
+                }
+            } else if (value->type() == json_lib::json_type::object_json) {
+                for (const auto& [key, item] :
+                     dynamic_cast<const json_lib::json_object&>(*value)
+                         .items()) {
+                    stack.emplace_back(item.get(), member_of(id, key));
+                }
+            }
+        }
+    }
+
+    void flatten(
+        std::map<std::string, dataguide_lib::path_stats>& out,
+        const size_t id = 0, const std::string& path = "$"
+    ) const {
+        out.emplace(path, nodes[id].stats);
+        for (const auto& [key, child] : nodes[id].members) {
+            flatten(
+                out, child,
+                path + '[' + json_lib::json_string(key).to_string() + ']'
+            );
+        }
+        if (nodes[id].elements != none) {
+            flatten(out, nodes[id].elements, path + "[*]");
+        }
+    }
+
+private:
+    struct node {
+        dataguide_lib::path_stats stats;
+        std::unordered_map<std::string, size_t> members;
+        size_t elements = none;
+        bool numbers = false;
+        bool containers = false;
+    };
+
+    std::vector<node> nodes;
+
+    size_t member_of(const size_t id, const std::string& key) {
+        if (const auto found = nodes[id].members.find(key);
+            found != nodes[id].members.end()) {
+            return found->second;
+        }
+        nodes.emplace_back();
+        nodes[id].members.emplace(key, nodes.size() - 1);
+        return nodes.size() - 1;
+    }
+
+    size_t element_of(const size_t id) {
+        if (nodes[id].elements == none) {
+            nodes.emplace_back();
+            nodes[id].elements = nodes.size() - 1;
+        }
+        return nodes[id].elements;
+    }
+
+    void record(const size_t id, const json_lib::json& value) {
+        auto& target = nodes[id];
+        auto& stats = target.stats;
+        ++stats.count;
+        ++stats.types[type_index(value.type())];
+        std::optional<double> number;
+        std::optional<uint64_t> size;
+        switch (value.type()) {
+        case json_lib::json_type::integer_json:
+            number = dynamic_cast<const json_lib::json_integer&>(value)
+                         .as_index();
+            break;
+        case json_lib::json_type::real_json: {
+            const std::string text = value.to_string();
+            double parsed = 0;
+            if (std::from_chars(text.data(), text.data() + text.size(), parsed)
+                    .ec
+                == std::errc {}) {
+                number = parsed;
+            }
+            break;
+        }
+        case json_lib::json_type::array_json:
+            size = dynamic_cast<const json_lib::json_array&>(value).size();
+            break;
+        case json_lib::json_type::object_json:
+            size = dynamic_cast<const json_lib::json_object&>(value).size();
+            break;
+        default:
+            break;
+        }
+        if (number) {
+            if (!target.numbers) {
+                stats.min_number = stats.max_number = *number;
+            }
+            stats.min_number = std::min(stats.min_number, *number);
+            stats.max_number = std::max(stats.max_number, *number);
+            target.numbers = true;
+        }
+        if (size) {
+            if (!target.containers) {
+                stats.min_size = stats.max_size = *size;
+            }
+            stats.min_size = std::min(stats.min_size, *size);
+            stats.max_size = std::max(stats.max_size, *size);
+            target.containers = true;
+        }
+    }
+};
+
+/**
+ * A position while following a constant path through the dataguide.
+ * `exists` is set while the value at the followed path certainly exists.
+ */
+struct position {
+    std::string path = "$";
+    const dataguide_lib::path_stats* stats = nullptr;
+    bool exists = true;
+};
+
+/**
+ * Apply one constant accessor. Throws where evaluation certainly fails,
+ * and returns false where the dataguide can no longer tell.
+ */
+bool step(
+    const dataguide_lib::dataguide& guide, position& at,
+    const json_lib::json& accessor
+) {
+    if (!at.exists || at.stats == nullptr) {
+        return false;
+    }
+    const auto& stats = *at.stats;
+    if (accessor.type() == json_lib::json_type::string_json) {
+        if (stats.of(json_lib::json_type::object_json) == 0) {
+            throw std::invalid_argument(
+                "`" + at.path + "` never holds an object"
+            );
+        }
+        if (!stats.only(json_lib::json_type::object_json)) {
+            return false;
+        }
+        std::string path = at.path + '[' + accessor.to_string() + ']';
+        const auto* child = guide.find(path);
+        if (child == nullptr) {
+            throw std::out_of_range("`" + path + "` does not exist");
+        }
+        // Keys are unique, so every object has the key if the counts agree.
+        at = { std::move(path), child, child->count == stats.count };
+        return true;
+    }
+    if (accessor.type() != json_lib::json_type::integer_json) {
+        return false;
+    }
+    if (stats.of(json_lib::json_type::array_json) == 0) {
+        throw std::invalid_argument("`" + at.path + "` never holds an array");
+    }
+    const int index
+        = dynamic_cast<const json_lib::json_integer&>(accessor).as_index();
+    if (!stats.only(json_lib::json_type::array_json) || index < 0) {
+        return false;
+    }
+    const auto unsigned_index = static_cast<uint64_t>(index);
+    if (unsigned_index >= stats.max_size) {
+        throw std::out_of_range(
+            "`" + at.path + "` has at most " + std::to_string(stats.max_size)
+            + " elements"
+        );
+    }
+    std::string path = at.path + "[*]";
+    const auto* child = guide.find(path);
+    at = { std::move(path), child, unsigned_index < stats.min_size };
+    return true;
+}
+
+const reference_lib::json_reference*
+root_path(const json_lib::json& expression) {
+    if (expression.type() != json_lib::json_type::reference_json) {
+        return nullptr;
+    }
+    const auto& reference
+        = dynamic_cast<const reference_lib::json_reference&>(expression);
+    if (reference.reference_type()
+            != reference_lib::json_reference_type::reference_json
+        || reference.get_head_type() != reference_lib::ref_head_type::root) {
+        return nullptr;
+    }
+    return &reference;
+}
+
+bool is_projection(const json_lib::json& accessor) {
+    return accessor.type() == json_lib::json_type::reference_json
+        && dynamic_cast<const reference_lib::json_reference&>(accessor)
+               .reference_type()
+        == reference_lib::json_reference_type::projection_json;
+}
+
+/**
+ * Follow the constant prefix of `tail`; returns how many accessors were
+ * followed with certainty.
+ */
+size_t follow(
+    const dataguide_lib::dataguide& guide, position& at,
+    const std::deque<std::shared_ptr<json_lib::json>>& tail
+) {
+    at.stats = guide.find(at.path);
+    size_t followed = 0;
+    for (const auto& accessor : tail) {
+        if (!step(guide, at, *accessor)) {
+            break;
+        }
+        ++followed;
+    }
+    return followed;
+}
+
+std::shared_ptr<json_lib::json> integer(const double value) {
+    return std::make_shared<json_lib::json_integer>(static_cast<int>(value));
+}
+
+/**
+ * Extreme of the integers gathered by `at[*]` followed by `keys`, where
+ * `at` is the single value at its path.
+ */
+std::shared_ptr<json_lib::json> extreme(
+    const dataguide_lib::dataguide& guide, const position& at,
+    const std::deque<std::shared_ptr<json_lib::json>>& keys, const bool maximum
+) {
+    if (!at.exists || at.stats == nullptr || at.stats->count != 1
+        || !at.stats->only(json_lib::json_type::array_json)) {
+        return nullptr;
+    }
+    std::string path = at.path + "[*]";
+    for (const auto& key : keys) {
+        if (key->type() != json_lib::json_type::string_json) {
+            return nullptr;
+        }
+        path += '[' + key->to_string() + ']';
+    }
+    const auto* values = guide.find(path);
+    if (values == nullptr || values->count == 0
+        || !values->only(json_lib::json_type::integer_json)) {
+        return nullptr;
+    }
+    return integer(maximum ? values->max_number : values->min_number);
+}
+}
+
+uint64_t dataguide_lib::path_stats::of(const json_lib::json_type type) const {
+    const size_t index = type_index(type);
+    return index < type_count ? types[index] : 0;
+}
+
+bool dataguide_lib::path_stats::only(const json_lib::json_type type) const {
+    return count > 0 && of(type) == count;
+}
+
+dataguide_lib::dataguide
+dataguide_lib::dataguide::build(const json_lib::json& document) {
+    builder paths;
+    paths.add(document);
+    dataguide result;
+    paths.flatten(result.entries);
+    return result;
+}
+
+dataguide_lib::dataguide
+dataguide_lib::dataguide::read(const std::filesystem::path& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        throw std::invalid_argument(
+            "failed to open file with path: " + path.string()
+        );
+    }
+    const std::string bytes(
+        (std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()
+    );
+    return decode(bytes);
+}
+
+dataguide_lib::dataguide
+dataguide_lib::dataguide::decode(const std::string_view bytes) {
+    binary_lib::reader in(bytes, "dataguide");
+    if (in.bytes(magic.size()) != magic || in.u32() != version) {
+        throw std::runtime_error("not a dataguide");
+    }
+    dataguide result;
+    result.stamp.size = in.u64();
+    result.stamp.modified = static_cast<int64_t>(in.u64());
+    for (uint64_t count = in.u32(); count > 0; --count) {
+        std::string path(in.bytes(in.u32()));
+        path_stats stats;
+        stats.count = in.u64();
+        for (auto& type : stats.types) {
+            type = in.u64();
+        }
+        stats.min_number = std::bit_cast<double>(in.u64());
+        stats.max_number = std::bit_cast<double>(in.u64());
+        stats.min_size = in.u64();
+        stats.max_size = in.u64();
+        result.entries.insert_or_assign(std::move(path), stats);
+    }
+    if (!in.done() || !result.entries.contains("$")) {
+        in.corrupt();
+    }
+    return result;
+}
+
+std::string dataguide_lib::dataguide::encode() const {
+    std::string out(magic);
+    put_u32(out, version);
+    put_u64(out, stamp.size);
+    put_u64(out, static_cast<uint64_t>(stamp.modified));
+    put_u32(out, static_cast<uint32_t>(entries.size()));
+    for (const auto& [path, stats] : entries) {
+        put_u32(out, static_cast<uint32_t>(path.size()));
+        out += path;
+        put_u64(out, stats.count);
+        for (const uint64_t type : stats.types) {
+            put_u64(out, type);
+        }
+        put_u64(out, std::bit_cast<uint64_t>(stats.min_number));
+        put_u64(out, std::bit_cast<uint64_t>(stats.max_number));
+        put_u64(out, stats.min_size);
+        put_u64(out, stats.max_size);
+    }
+    return out;
+}
+
+void dataguide_lib::dataguide::write(const std::filesystem::path& path) const {
+    const std::string bytes = encode();
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        throw std::invalid_argument(
+            "failed to open file with path: " + path.string()
+        );
+    }
+    ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+const dataguide_lib::path_stats*
+dataguide_lib::dataguide::find(const std::string& path) const {
+    const auto found = entries.find(path);
+    return found == entries.end() ? nullptr : &found->second;
+}
+
+const std::map<std::string, dataguide_lib::path_stats>&
+dataguide_lib::dataguide::paths() const {
+    return entries;
+}
+
+index_lib::stamp dataguide_lib::dataguide::source() const { return stamp; }
+
+void dataguide_lib::dataguide::set_source(const index_lib::stamp& stamp) {
+    this->stamp = stamp;
+}
+
+std::filesystem::path
+dataguide_lib::sidecar_path(const std::filesystem::path& input) {
+    auto result = input;
+    result += ".guide";
+    return result;
+}
+
+void dataguide_lib::build(const std::filesystem::path& input) {
+    const auto source = index_lib::stamp::of(input);
+    std::string buffer = parser_lib::read_file(input);
+    std::shared_ptr<json_lib::json> document;
+    parser_lib::parser(buffer).completely_parse_json(document);
+    auto guide = dataguide::build(*document);
+    guide.set_source(source);
+    guide.write(sidecar_path(input));
+}
+
+void dataguide_lib::check(
+    const dataguide& guide, const json_lib::json& expression
+) {
+    switch (expression.type()) {
+    case json_lib::json_type::array_json:
+        for (const auto& item :
+             dynamic_cast<const json_lib::json_array&>(expression).items()) {
+            check(guide, *item);
+        }
+        return;
+    case json_lib::json_type::object_json:
+        for (const auto& [key, item] :
+             dynamic_cast<const json_lib::json_object&>(expression).items()) {
+            check(guide, *item);
+        }
+        return;
+    case json_lib::json_type::reference_json:
+        break;
+    default:
+        return;
+    }
+    const auto& reference
+        = dynamic_cast<const reference_lib::json_reference&>(expression);
+    if (reference.reference_type()
+        == reference_lib::json_reference_type::function_json) {
+        for (const auto& arg :
+             dynamic_cast<const reference_lib::json_function&>(expression)
+                 .get_args()) {
+            check(guide, *arg);
+        }
+        return;
+    }
+    for (const auto& accessor : reference.get_tail()) {
+        if (accessor->type() == json_lib::json_type::reference_json
+            && !is_projection(*accessor)) {
+            check(guide, *accessor);
+        }
+    }
+    if (root_path(expression) != nullptr) {
+        position at;
+        follow(guide, at, reference.get_tail());
+    }
+}
+
+std::shared_ptr<json_lib::json> dataguide_lib::answer(
+    const dataguide& guide, const std::shared_ptr<json_lib::json>& expression
+) {
+    if (expression->type() != json_lib::json_type::reference_json) {
+        return nullptr;
+    }
+    const auto function
+        = std::dynamic_pointer_cast<reference_lib::json_function>(expression);
+    if (function == nullptr || function->get_args().size() != 1) {
+        return nullptr;
+    }
+    const std::string& name = function->get_name();
+    const auto* path = root_path(*function->get_args()[0]);
+    if (path == nullptr || (name != "size" && name != "min" && name != "max")) {
+        return nullptr;
+    }
+    const auto& tail = path->get_tail();
+    position at;
+    const size_t followed = follow(guide, at, tail);
+    if (followed == tail.size()) {
+        if (name != "size") {
+            return extreme(guide, at, {}, name == "max");
+        }
+        if (at.exists && at.stats != nullptr
+            && at.stats->min_size == at.stats->max_size
+            && (at.stats->only(json_lib::json_type::array_json)
+                || at.stats->only(json_lib::json_type::object_json))) {
+            return std::make_shared<json_lib::json_integer>(
+                static_cast<int>(at.stats->min_size)
+            );
+        }
+        return nullptr;
+    }
+    if (name != "size" && followed + 1 == tail.size()
+        && is_projection(*tail.back())) {
+        return extreme(
+            guide, at,
+            dynamic_cast<const reference_lib::json_reference&>(*tail.back())
+                .get_tail(),
+            name == "max"
+        );
+    }
+    return nullptr;
+}
@@ -0,0 +1,184 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "executor.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+
+#include <algorithm>
+
+namespace {
+bool cheap(const json_lib::json& node) {
+    switch (node.type()) {
+    case json_lib::json_type::array_json: {
+        const auto& array = dynamic_cast<const json_lib::json_array&>(node);
+        return std::ranges::all_of(array.items(), [](const auto& item) {
+            return cheap(*item);
+        });
+    }
+    case json_lib::json_type::object_json: {
+        const auto& object = dynamic_cast<const json_lib::json_object&>(node);
+        return std::ranges::all_of(object.items(), [](const auto& item) {
+            return cheap(*item.second);
+        });
+    }
+    case json_lib::json_type::reference_json: {
+        const auto& reference
+            = dynamic_cast<const reference_lib::json_reference&>(node);
+        switch (reference.reference_type()) {
+        case reference_lib::json_reference_type::function_json: {
+            const auto& function
+                = dynamic_cast<const reference_lib::json_function&>(node);
+            return function.get_name() == "size"
+                && std::ranges::all_of(
+                       function.get_args(),
+                       [](const auto& arg) { return cheap(*arg); }
+                );
+        }
+        case reference_lib::json_reference_type::reference_json: {
+            if (const auto head = reference.get_head();
+                head != nullptr && !cheap(*head)) {
+                return false;
+            }
+            return std::ranges::none_of(
+                reference.get_tail(),
+                [](const auto& accessor) {
+                    return accessor->type()
+                        == json_lib::json_type::reference_json;
+                }
+            );
+        }
+        default:
+            return false;
+        }
+    }
+    default:
+        return true;
+    }
+}
+}
+
+executor_lib::lane executor_lib::classify(const json_lib::json& expression) {
+    return cheap(expression) ? lane::cheap : lane::expensive;
+}
+
+executor_lib::executor::executor(
+    std::shared_ptr<json_lib::json> document, size_t threads,
+    const size_t expensive_slots
+)
+    : document(std::move(document))
+    , expensive_slots(std::max<size_t>(expensive_slots, 1)) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&executor::run, this);
+    }
+}
+
+executor_lib::executor::~executor() {
+    {
+        const std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::future<std::shared_ptr<json_lib::json>>
+executor_lib::executor::submit(std::string expression) {
+    task query;
+    parser_lib::parser(expression).completely_parse_json(
+        query.expression, true
+    );
+    const auto type = static_cast<size_t>(classify(*query.expression));
+    auto result = query.result.get_future();
+    query.queued = std::chrono::steady_clock::now();
+    {
+        const std::lock_guard lock(mutex);
+        queues[type].emplace_back(std::move(query));
+    }
+    ready.notify_one();
+    return result;
+}
+
+const metrics_lib::histogram&
+executor_lib::executor::queue_latency(const lane type) const {
+    return latencies[static_cast<size_t>(type)];
+}
+
+size_t executor_lib::executor::threads() const { return workers.size(); }
+
+void executor_lib::executor::run() {
+    constexpr auto cheap_lane = static_cast<size_t>(lane::cheap);
+    constexpr auto expensive_lane = static_cast<size_t>(lane::expensive);
+    std::unique_lock lock(mutex);
+    for (;;) {
+        const auto runnable = [this] {
+            return !queues[cheap_lane].empty()
+                || (!queues[expensive_lane].empty()
+                    && running_expensive < expensive_slots);
+        };
+        ready.wait(lock, [&] { return stopping || runnable(); });
+        if (!runnable()) {
+            // Stopping; queued expensive queries are left to the workers
+            // holding their slots.
+            return;
+        }
+        const size_t type
+            = queues[cheap_lane].empty() ? expensive_lane : cheap_lane;
+        task query = std::move(queues[type].front());
+        queues[type].pop_front();
+        if (type == expensive_lane) {
+            ++running_expensive;
+        }
+        lock.unlock();
+
+        const auto waited = std::chrono::steady_clock::now() - query.queued;
+        latencies[type].record(waited);
+        if (auto* registry = metrics_lib::active_registry) {
+            (type == expensive_lane ? registry->expensive_queue
+                                    : registry->cheap_queue)
+                .record(waited);
+        }
+        try {
+            query.result.set_value(
+                reference_lib::evaluate(query.expression, document)
+            );
+        } catch (...) {
+            query.result.set_exception(std::current_exception());
+        }
+
+        lock.lock();
+        if (type == expensive_lane) {
+            --running_expensive;
+            if (!queues[expensive_lane].empty()) {
+                ready.notify_one();
+            }
+        }
+    }
+}
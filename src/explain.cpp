@@ -0,0 +1,204 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "explain.hpp"
+
+#include <iomanip>
+#include <ranges>
+#include <sstream>
+
+namespace {
+bool is_dynamic(const json_lib::json& item) {
+    switch (item.type()) {
+    case json_lib::json_type::reference_json:
+        return true;
+    case json_lib::json_type::array_json: {
+        const auto& items = dynamic_cast<const json_lib::json_array&>(item);
+        for (const auto& child : items.items()) {
+            if (is_dynamic(*child)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    case json_lib::json_type::object_json: {
+        const auto& items = dynamic_cast<const json_lib::json_object&>(item);
+        for (const auto& child : items.items() | std::views::values) {
+            if (is_dynamic(*child)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    default:
+        return false;
+    }
+}
+
+explain_lib::plan_node describe(const std::shared_ptr<json_lib::json>& item);
+
+explain_lib::plan_node unprofiled(explain_lib::plan_node node) {
+    node.step = nullptr;
+    for (auto& child : node.children) {
+        child = unprofiled(std::move(child));
+    }
+    return node;
+}
+
+explain_lib::plan_node
+describe_step(const std::shared_ptr<json_lib::json>& accessor) {
+    if (accessor->type() != json_lib::json_type::reference_json) {
+        return { "step [" + accessor->to_string() + "]", accessor };
+    }
+    const auto ref
+        = std::dynamic_pointer_cast<reference_lib::json_reference>(accessor);
+    if (ref->reference_type() == reference_lib::json_reference_type::set_json
+        || ref->reference_type()
+            == reference_lib::json_reference_type::projection_json) {
+        return describe(accessor);
+    }
+    return { "subscript", accessor, { describe(accessor) } };
+}
+
+std::string head_label(const reference_lib::json_reference& ref) {
+    switch (ref.get_head_type()) {
+    case reference_lib::ref_head_type::root:
+        return "path $";
+    case reference_lib::ref_head_type::local:
+        return "path @";
+    case reference_lib::ref_head_type::accessor:
+        return "branch";
+    default:
+        return "path";
+    }
+}
+
+explain_lib::plan_node describe(const std::shared_ptr<json_lib::json>& item) {
+    if (item->type() != json_lib::json_type::reference_json) {
+        if (!is_dynamic(*item)) {
+            return { "constant " + item->to_string() };
+        }
+        explain_lib::plan_node node;
+        if (item->type() == json_lib::json_type::array_json) {
+            node.label = "array";
+            const auto& items = dynamic_cast<const json_lib::json_array&>(*item);
+            for (size_t i = 0; i < items.size(); ++i) {
+                auto child = describe(items.items()[i]);
+                child.label = '[' + std::to_string(i) + "] " + child.label;
+                node.children.emplace_back(std::move(child));
+            }
+        } else {
+            node.label = "object";
+            const auto& items = dynamic_cast<const json_lib::json_object&>(*item);
+            for (const auto& [key, value] : items.items()) {
+                auto child = describe(value);
+                child.label = '"' + key + "\": " + child.label;
+                node.children.emplace_back(std::move(child));
+            }
+        }
+        return node;
+    }
+
+    const auto ref
+        = std::dynamic_pointer_cast<reference_lib::json_reference>(item);
+    explain_lib::plan_node node;
+    switch (ref->reference_type()) {
+    case reference_lib::json_reference_type::set_json: {
+        const auto set = std::dynamic_pointer_cast<reference_lib::json_set>(ref);
+        node.label = "union of "
+            + std::to_string(set->get_elements().size()) + " branches";
+        node.step = set;
+        for (const auto& element : set->get_elements()) {
+            node.children.emplace_back(describe(element));
+        }
+        break;
+    }
+    case reference_lib::json_reference_type::function_json: {
+        const auto function
+            = std::dynamic_pointer_cast<reference_lib::json_function>(ref);
+        node.label = "function " + function->get_name() + "()";
+        node.step = function;
+        for (const auto& arg : function->get_args()) {
+            node.children.emplace_back(describe(arg));
+        }
+        break;
+    }
+    case reference_lib::json_reference_type::projection_json: {
+        node.label = "each element [*]";
+        node.step = ref;
+        // The path is followed per element, without counters of its own.
+        for (const auto& accessor : ref->get_tail()) {
+            node.children.emplace_back(unprofiled(describe_step(accessor)));
+        }
+        return node;
+    }
+    default: {
+        node.label = head_label(*ref);
+        if (ref->get_head_type() == reference_lib::ref_head_type::object) {
+            auto head = describe(ref->get_head());
+            head.label = "head: " + head.label;
+            node.children.emplace_back(std::move(head));
+        }
+    }
+    }
+    for (const auto& accessor : ref->get_tail()) {
+        node.children.emplace_back(describe_step(accessor));
+    }
+    return node;
+}
+
+void render_node(
+    std::ostringstream& oss, const explain_lib::plan_node& node,
+    const size_t depth, const reference_lib::evaluation_profile* profile
+) {
+    oss << std::string(depth * 2, ' ') << node.label;
+    if (profile != nullptr && node.step != nullptr) {
+        if (const auto* step = profile->find(node.step.get())) {
+            oss << " (calls=" << step->calls << ", visited=" << step->visited
+                << ", produced=" << step->produced << ", time=" << std::fixed
+                << std::setprecision(3)
+                << static_cast<double>(step->time.count()) / 1000.0 << "us)";
+        } else {
+            oss << " (never executed)";
+        }
+    }
+    oss << '\n';
+    for (const auto& child : node.children) {
+        render_node(oss, child, depth + 1, profile);
+    }
+}
+}
+
+explain_lib::plan_node
+explain_lib::build_plan(const std::shared_ptr<json_lib::json>& expression) {
+    return describe(expression);
+}
+
+std::string explain_lib::render(
+    const plan_node& plan, const reference_lib::evaluation_profile* profile
+) {
+    std::ostringstream oss;
+    render_node(oss, plan, 0, profile);
+    return oss.str();
+}
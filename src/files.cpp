@@ -0,0 +1,266 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "files.hpp"
+#include "index.hpp"
+#include "msgpack.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+bool files_lib::glob_match(
+    const std::string_view pattern, const std::string_view name
+) {
+    // Iterative matching with backtracking to the last `*`.
+    size_t p = 0;
+    size_t n = 0;
+    size_t star = std::string_view::npos;
+    size_t resume = 0;
+    while (n < name.size()) {
+        if (p < pattern.size()
+            && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++p;
+            ++n;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = n;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+bool files_lib::is_collection(const std::filesystem::path& input) {
+    return input.filename().string().find_first_of("*?") != std::string::npos
+        || std::filesystem::is_directory(input);
+}
+
+std::vector<std::filesystem::path>
+files_lib::expand(const std::vector<std::filesystem::path>& inputs) {
+    std::vector<std::filesystem::path> result;
+    for (const auto& input : inputs) {
+        const std::string pattern = input.filename().string();
+        std::vector<std::filesystem::path> matches;
+        if (pattern.find_first_of("*?") != std::string::npos) {
+            const auto directory
+                = input.has_parent_path() ? input.parent_path() : ".";
+            for (const auto& entry :
+                 std::filesystem::directory_iterator(directory)) {
+                if (entry.is_regular_file()
+                    && glob_match(pattern, entry.path().filename().string())) {
+                    matches.emplace_back(
+                        input.has_parent_path()
+                            ? entry.path()
+                            : entry.path().filename()
+                    );
+                }
+            }
+        } else if (std::filesystem::is_directory(input)) {
+            for (const auto& entry :
+                 std::filesystem::recursive_directory_iterator(input)) {
+                if (entry.is_regular_file()
+                    && entry.path().extension() == ".json") {
+                    matches.emplace_back(entry.path());
+                }
+            }
+        } else {
+            result.emplace_back(input);
+            continue;
+        }
+        std::ranges::sort(matches);
+        result.insert(result.end(), matches.begin(), matches.end());
+    }
+    return result;
+}
+
+namespace {
+/**
+ * Run `job` for each file on a pool of workers and print the lines it
+ * returns in the order of `files`. Files are handed out one at a time, and
+ * each worker passes the same read buffer to all of its jobs. A job that
+ * throws is reported on stderr and counted as failed.
+ */
+template <typename Job>
+size_t for_each_file(
+    const std::vector<std::filesystem::path>& files, size_t threads,
+    std::ostream& out, Job job
+) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    threads = std::min(threads, std::max<size_t>(files.size(), 1));
+
+    std::atomic<size_t> next = 0;
+    std::mutex mutex;
+    std::vector<std::optional<std::string>> lines(files.size());
+    size_t printed = 0;
+    size_t failed = 0;
+
+    const auto work = [&] {
+        std::string buffer;
+        for (size_t i; (i = next.fetch_add(1)) < files.size();) {
+            std::string line;
+            try {
+                line = job(files[i], buffer);
+            } catch (const std::exception& e) {
+                const std::lock_guard lock(mutex);
+                std::cerr << files[i].string() << ": " << e.what() << '\n';
+                ++failed;
+            }
+
+            const std::lock_guard lock(mutex);
+            lines[i] = std::move(line);
+            for (; printed < lines.size() && lines[printed].has_value();
+                 ++printed) {
+                out << *lines[printed];
+                lines[printed].reset();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    out.flush();
+    return failed;
+}
+
+std::shared_ptr<json_lib::json> parse_file(
+    const std::filesystem::path& file, std::string& buffer,
+    const files_lib::file_format format
+) {
+    parser_lib::read_file(file, buffer);
+    if (format == files_lib::file_format::msgpack
+        || (format == files_lib::file_format::by_extension
+            && msgpack_lib::has_extension(file))) {
+        return msgpack_lib::decode(buffer);
+    }
+    std::shared_ptr<json_lib::json> document;
+    parser_lib::parser document_parser(buffer);
+    try {
+        document_parser.completely_parse_json(document);
+    } catch (...) {
+        // Hand the capacity back for the worker's next file.
+        buffer = document_parser.release_buffer();
+        throw;
+    }
+    buffer = document_parser.release_buffer();
+    return document;
+}
+}
+
+size_t files_lib::evaluate_files(
+    const std::vector<std::filesystem::path>& files,
+    const std::string& expression, const size_t threads, std::ostream& out,
+    bloom_lib::catalog* summaries, const file_format format
+) {
+    std::mutex mutex;
+    return for_each_file(
+        files, threads, out,
+        [&](const std::filesystem::path& file, std::string& buffer) {
+            const auto stamp = summaries != nullptr
+                ? index_lib::stamp::of(file)
+                : index_lib::stamp {};
+            const auto document = parse_file(file, buffer, format);
+            if (summaries != nullptr) {
+                auto summary = bloom_lib::summarize(*document);
+                const std::lock_guard lock(mutex);
+                summaries->record(file, stamp, std::move(summary));
+            }
+
+            std::string text = expression;
+            std::shared_ptr<json_lib::json> compiled;
+            parser_lib::parser(text).completely_parse_json(compiled, true);
+            return file.string() + '\t'
+                + reference_lib::evaluate(compiled, document)->to_string()
+                + '\n';
+        }
+    );
+}
+
+files_lib::lookup_stats files_lib::find_files(
+    const std::vector<std::filesystem::path>& files,
+    const bloom_lib::needle& item, bloom_lib::catalog& summaries,
+    const size_t threads, std::ostream& out, const file_format format
+) {
+    std::mutex mutex;
+    std::atomic<size_t> skipped = 0;
+    std::atomic<size_t> parsed = 0;
+    std::atomic<size_t> matched = 0;
+    lookup_stats result;
+    result.failed = for_each_file(
+        files, threads, out,
+        [&](const std::filesystem::path& file,
+            std::string& buffer) -> std::string {
+            const auto stamp = index_lib::stamp::of(file);
+            {
+                const std::lock_guard lock(mutex);
+                const auto* summary = summaries.find(file, stamp);
+                if (summary != nullptr
+                    && !bloom_lib::may_match(*summary, item)) {
+                    ++skipped;
+                    return {};
+                }
+            }
+            const auto document = parse_file(file, buffer, format);
+            ++parsed;
+            {
+                const std::lock_guard lock(mutex);
+                if (summaries.find(file, stamp) == nullptr) {
+                    summaries.record(
+                        file, stamp, bloom_lib::summarize(*document)
+                    );
+                }
+            }
+            if (!bloom_lib::matches(*document, item)) {
+                return {};
+            }
+            ++matched;
+            return file.string() + '\n';
+        }
+    );
+    result.skipped = skipped;
+    result.parsed = parsed;
+    result.matched = matched;
+    return result;
+}
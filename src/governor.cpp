@@ -0,0 +1,172 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "governor.hpp"
+
+#include <utility>
+
+namespace {
+constexpr size_t clock_check_interval = 64;
+
+thread_local governor_lib::query_budget* active_budget = nullptr;
+thread_local size_t polls_until_clock = 0;
+}
+
+bool governor_lib::limits::unlimited() const {
+    return max_input_bytes == 0 && max_depth == 0 && max_nodes == 0
+        && max_memory == 0 && max_steps == 0 && max_time.count() == 0;
+}
+
+governor_lib::limit_exceeded::limit_exceeded(
+    const std::string& resource, const size_t limit
+)
+    : std::runtime_error(
+          "limit exceeded: " + resource + " of " + std::to_string(limit)
+      )
+    , name(resource)
+    , value(limit) { }
+
+const std::string& governor_lib::limit_exceeded::resource() const {
+    return name;
+}
+
+size_t governor_lib::limit_exceeded::limit() const { return value; }
+
+void governor_lib::check(
+    const char* resource, const size_t value, const size_t limit
+) {
+    if (limit != 0 && value > limit) {
+        throw limit_exceeded(resource, limit);
+    }
+}
+
+governor_lib::query_budget::query_budget()
+    : budget(active_limits.load()) {
+    if (budget == nullptr
+        || (budget->max_steps == 0 && budget->max_time.count() == 0)) {
+        return;
+    }
+    previous = std::exchange(active_budget, this);
+    if (budget->max_time.count() != 0) {
+        deadline = std::chrono::steady_clock::now() + budget->max_time;
+        next_clock_check = clock_check_interval;
+    }
+}
+
+governor_lib::query_budget::~query_budget() {
+    if (active_budget == this) {
+        active_budget = previous;
+    }
+}
+
+void governor_lib::query_budget::charge(const size_t count) {
+    if (active_budget != nullptr) {
+        active_budget->take(count);
+    }
+}
+
+void governor_lib::query_budget::take(const size_t count) {
+    steps += count;
+    check("max_steps", steps, budget->max_steps);
+    if (next_clock_check != 0 && steps >= next_clock_check) {
+        next_clock_check = steps + clock_check_interval;
+        if (std::chrono::steady_clock::now() > deadline) {
+            throw limit_exceeded(
+                "max_time",
+                static_cast<size_t>(budget->max_time.count())
+            );
+        }
+    }
+}
+
+governor_lib::operation_cancelled::operation_cancelled(const bool deadline)
+    : std::runtime_error(
+          deadline ? "operation cancelled: deadline exceeded"
+                   : "operation cancelled"
+      )
+    , deadline(deadline) { }
+
+bool governor_lib::operation_cancelled::deadline_exceeded() const {
+    return deadline;
+}
+
+void governor_lib::cancellation_token::cancel() {
+    flag.store(true, std::memory_order_relaxed);
+}
+
+bool governor_lib::cancellation_token::cancelled() const {
+    return flag.load(std::memory_order_relaxed);
+}
+
+void governor_lib::cancellation_token::set_deadline(
+    const std::chrono::steady_clock::time_point deadline
+) {
+    deadline_ticks.store(
+        deadline.time_since_epoch().count(), std::memory_order_relaxed
+    );
+}
+
+void governor_lib::cancellation_token::cancel_after(
+    const std::chrono::nanoseconds timeout
+) {
+    set_deadline(
+        std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            timeout
+        )
+    );
+}
+
+void governor_lib::cancellation_token::throw_if_expired() const {
+    if (cancelled()) {
+        throw operation_cancelled(false);
+    }
+    const auto ticks = deadline_ticks.load(std::memory_order_relaxed);
+    if (ticks != 0
+        && std::chrono::steady_clock::now().time_since_epoch().count()
+            >= ticks) {
+        throw operation_cancelled(true);
+    }
+}
+
+governor_lib::token_scope::token_scope(const cancellation_token& token)
+    : previous(std::exchange(active_token, &token)) {
+    polls_until_clock = 0;
+}
+
+governor_lib::token_scope::~token_scope() { active_token = previous; }
+
+void governor_lib::poll() {
+    if (active_token == nullptr) {
+        return;
+    }
+    if (active_token->cancelled()) {
+        throw operation_cancelled(false);
+    }
+    if (polls_until_clock == 0) {
+        polls_until_clock = clock_check_interval;
+        active_token->throw_if_expired();
+    }
+    --polls_until_clock;
+}
@@ -0,0 +1,599 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "index.hpp"
+#include "binary.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using binary_lib::put_u32;
+using binary_lib::put_u64;
+
+constexpr std::string_view magic = "JIDX";
+constexpr uint32_t version = 1;
+constexpr uint64_t header_size = 56;
+constexpr uint64_t record_header_size = 5;
+constexpr uint64_t element_size = 24;
+constexpr uint64_t member_size = 32;
+
+void put_span(std::string& out, const index_lib::span& value) {
+    put_u64(out, value.begin);
+    put_u64(out, value.end);
+    put_u64(out, value.record);
+}
+
+bool is_space(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+[[noreturn]] void corrupt() {
+    throw std::runtime_error("corrupt structural index");
+}
+
+uint64_t checked_read(
+    const std::string_view data, const uint64_t offset, const size_t width
+) {
+    const auto value = binary_lib::read(data, offset, width);
+    if (!value) {
+        corrupt();
+    }
+    return *value;
+}
+
+/**
+ * Recursive scanner over the raw text. Containers within the depth limit
+ * are descended into and recorded, children first, so that every record
+ * can refer to the records below it; everything deeper is skipped with a
+ * flat bracket count.
+ */
+class builder {
+public:
+    std::string out;
+
+    builder(const std::string_view text, const size_t max_depth)
+        : text(text)
+        , max_depth(max_depth) { }
+
+    index_lib::span value(size_t& pos, const size_t depth) {
+        const size_t begin = pos;
+        uint64_t record = 0;
+        if (pos < text.size() && depth <= max_depth && text[pos] == '[') {
+            record = put_array(pos, depth);
+        } else if (pos < text.size() && depth <= max_depth
+                   && text[pos] == '{') {
+            record = put_object(pos, depth);
+        } else {
+            pos = skip(pos);
+        }
+        return { begin, pos, record };
+    }
+
+    size_t skip_space(size_t pos) const {
+        while (pos < text.size() && is_space(text[pos])) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    [[noreturn]] void malformed(const size_t pos) const {
+        throw std::runtime_error(
+            "malformed json at offset " + std::to_string(pos)
+        );
+    }
+
+private:
+    std::string_view text;
+    size_t max_depth;
+
+    /**
+     * Offset of the closing quote of the string whose contents start at
+     * `pos`. Candidates are found with `memchr`, which the C library
+     * vectorizes, and a quote counts only after an even run of backslashes.
+     */
+    size_t string_end(const size_t pos) const {
+        for (size_t from = pos; from < text.size();) {
+            const auto* found = static_cast<const char*>(
+                std::memchr(text.data() + from, '\"', text.size() - from)
+            );
+            if (found == nullptr) {
+                break;
+            }
+            const auto quote = static_cast<size_t>(found - text.data());
+            size_t escapes = 0;
+            while (quote - escapes > pos
+                   && text[quote - escapes - 1] == '\\') {
+                ++escapes;
+            }
+            if (escapes % 2 == 0) {
+                return quote;
+            }
+            from = quote + 1;
+        }
+        malformed(pos);
+    }
+
+    /**
+     * Offset of the next quote or bracket at or after `pos`. Eight bytes are
+     * tested at a time (SIMD within a register), so runs of plain content
+     * are skipped a word at a time.
+     */
+    size_t next_structural(size_t pos) const {
+        constexpr uint64_t ones = 0x0101010101010101;
+        constexpr uint64_t highs = 0x8080808080808080;
+        const auto has_byte = [&](const uint64_t word, const char c) {
+            const uint64_t x = word ^ (ones * static_cast<uint8_t>(c));
+            return ((x - ones) & ~x & highs) != 0;
+        };
+        while (text.size() - pos >= sizeof(uint64_t)) {
+            uint64_t word = 0;
+            std::memcpy(&word, text.data() + pos, sizeof(word));
+            if (has_byte(word, '\"') || has_byte(word, '[')
+                || has_byte(word, ']') || has_byte(word, '{')
+                || has_byte(word, '}')) {
+                break;
+            }
+            pos += sizeof(uint64_t);
+        }
+        while (pos < text.size() && text[pos] != '\"' && text[pos] != '['
+               && text[pos] != ']' && text[pos] != '{' && text[pos] != '}') {
+            ++pos;
+        }
+        return pos;
+    }
+
+    size_t skip(size_t pos) const {
+        if (pos >= text.size()) {
+            malformed(pos);
+        }
+        const char first = text[pos];
+        if (first == '\"') {
+            return string_end(pos + 1) + 1;
+        }
+        if (first != '[' && first != '{') {
+            const size_t begin = pos;
+            while (pos < text.size() && !is_space(text[pos])
+                   && text[pos] != ',' && text[pos] != ':' && text[pos] != ']'
+                   && text[pos] != '}') {
+                ++pos;
+            }
+            if (pos == begin) {
+                malformed(pos);
+            }
+            return pos;
+        }
+        size_t depth = 0;
+        while ((pos = next_structural(pos)) < text.size()) {
+            const char c = text[pos];
+            if (c == '\"') {
+                pos = string_end(pos + 1) + 1;
+                continue;
+            }
+            if (c == '[' || c == '{') {
+                ++depth;
+            } else if (--depth == 0) {
+                return pos + 1;
+            }
+            ++pos;
+        }
+        malformed(pos);
+    }
+
+    /**
+     * Advance past the separator after an item and report whether the
+     * container goes on.
+     */
+    bool separator(size_t& pos, const char halt) const {
+        pos = skip_space(pos);
+        if (pos < text.size() && text[pos] == ',') {
+            pos = skip_space(pos + 1);
+            return true;
+        }
+        if (pos < text.size() && text[pos] == halt) {
+            ++pos;
+            return false;
+        }
+        malformed(pos);
+    }
+
+    uint64_t put_array(size_t& pos, const size_t depth) {
+        std::vector<index_lib::span> items;
+        pos = skip_space(pos + 1);
+        if (pos < text.size() && text[pos] == ']') {
+            ++pos;
+        } else {
+            do {
+                items.emplace_back(value(pos, depth + 1));
+            } while (separator(pos, ']'));
+        }
+
+        const uint64_t offset = out.size();
+        out += '[';
+        put_u32(out, static_cast<uint32_t>(items.size()));
+        for (const auto& item : items) {
+            put_span(out, item);
+        }
+        return offset;
+    }
+
+    std::string key(size_t& pos) const {
+        if (pos >= text.size() || text[pos] != '\"') {
+            malformed(pos);
+        }
+        const size_t begin = pos;
+        const size_t end = skip(pos);
+        pos = end;
+        const std::string_view raw = text.substr(begin + 1, end - begin - 2);
+        if (raw.find('\\') == std::string_view::npos) {
+            return std::string(raw);
+        }
+        std::string quoted(text.substr(begin, end - begin));
+        std::shared_ptr<json_lib::json> decoded;
+        parser_lib::parser(quoted).completely_parse_json(decoded);
+        return std::dynamic_pointer_cast<json_lib::json_string>(decoded)
+            ->as_key();
+    }
+
+    uint64_t put_object(size_t& pos, const size_t depth) {
+        std::vector<std::pair<std::string, index_lib::span>> members;
+        pos = skip_space(pos + 1);
+        if (pos < text.size() && text[pos] == '}') {
+            ++pos;
+        } else {
+            do {
+                std::string name = key(pos);
+                pos = skip_space(pos);
+                if (pos >= text.size() || text[pos] != ':') {
+                    malformed(pos);
+                }
+                pos = skip_space(pos + 1);
+                members.emplace_back(std::move(name), value(pos, depth + 1));
+            } while (separator(pos, '}'));
+        }
+
+        std::ranges::sort(members, {}, &decltype(members)::value_type::first);
+        std::vector<uint64_t> keys;
+        keys.reserve(members.size());
+        for (size_t i = 0; i < members.size(); ++i) {
+            if (i > 0 && members[i].first == members[i - 1].first) {
+                throw std::invalid_argument(
+                    "key `" + members[i].first + "` is already set"
+                );
+            }
+            keys.emplace_back(out.size());
+            put_u32(out, static_cast<uint32_t>(members[i].first.size()));
+            out += members[i].first;
+        }
+
+        const uint64_t offset = out.size();
+        out += '{';
+        put_u32(out, static_cast<uint32_t>(members.size()));
+        for (size_t i = 0; i < members.size(); ++i) {
+            put_u64(out, keys[i]);
+            put_span(out, members[i].second);
+        }
+        return offset;
+    }
+};
+}
+
+index_lib::stamp index_lib::stamp::of(const std::filesystem::path& path) {
+    return {
+        std::filesystem::file_size(path),
+        static_cast<int64_t>(
+            std::filesystem::last_write_time(path).time_since_epoch().count()
+        ),
+    };
+}
+
+std::string index_lib::encode(
+    const std::string_view text, const size_t max_depth, const stamp source
+) {
+    builder index(text, max_depth);
+    index.out += magic;
+    put_u32(index.out, version);
+    put_u64(index.out, source.size);
+    put_u64(index.out, static_cast<uint64_t>(source.modified));
+    put_u32(index.out, static_cast<uint32_t>(max_depth));
+    put_u32(index.out, 0);
+    index.out.resize(header_size);
+
+    size_t pos = index.skip_space(0);
+    const span root = index.value(pos, 1);
+    if (index.skip_space(pos) != text.size()) {
+        index.malformed(pos);
+    }
+
+    std::string header;
+    put_span(header, root);
+    index.out.replace(header_size - header.size(), header.size(), header);
+    return std::move(index.out);
+}
+
+std::filesystem::path
+index_lib::sidecar_path(const std::filesystem::path& input) {
+    std::filesystem::path result = input;
+    result += ".idx";
+    return result;
+}
+
+void index_lib::build(
+    const std::filesystem::path& input, const size_t max_depth
+) {
+    const transport_lib::mapped_segment text(input);
+    const std::string bytes
+        = encode(text.view(), max_depth, stamp::of(input));
+    const auto path = sidecar_path(input);
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        throw std::invalid_argument(
+            "failed to open file with path: " + path.string()
+        );
+    }
+    ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+index_lib::structural_index::structural_index(
+    const std::filesystem::path& path
+)
+    : mapping(std::make_unique<transport_lib::mapped_segment>(path))
+    , data(mapping->view()) {
+    validate();
+}
+
+index_lib::structural_index::structural_index(const std::string& bytes)
+    : data(bytes) {
+    validate();
+}
+
+void index_lib::structural_index::validate() {
+    if (data.size() < header_size || !data.starts_with(magic)
+        || read_u32(4) != version) {
+        throw std::runtime_error("not a structural index");
+    }
+    const span top = root();
+    if (top.begin > top.end || top.record >= data.size()) {
+        corrupt();
+    }
+}
+
+uint8_t index_lib::structural_index::read_u8(const uint64_t offset) const {
+    return static_cast<uint8_t>(checked_read(data, offset, 1));
+}
+
+uint32_t index_lib::structural_index::read_u32(const uint64_t offset) const {
+    return static_cast<uint32_t>(checked_read(data, offset, 4));
+}
+
+uint64_t index_lib::structural_index::read_u64(const uint64_t offset) const {
+    return checked_read(data, offset, 8);
+}
+
+index_lib::span
+index_lib::structural_index::read_span(const uint64_t offset) const {
+    return { read_u64(offset), read_u64(offset + 8), read_u64(offset + 16) };
+}
+
+index_lib::stamp index_lib::structural_index::source() const {
+    return { read_u64(8), static_cast<int64_t>(read_u64(16)) };
+}
+
+size_t index_lib::structural_index::max_depth() const { return read_u32(24); }
+
+index_lib::span index_lib::structural_index::root() const {
+    return read_span(header_size - 24);
+}
+
+json_lib::json_type
+index_lib::structural_index::type(const span& value) const {
+    if (value.record == 0) {
+        return json_lib::json_type::null_json;
+    }
+    switch (read_u8(value.record)) {
+    case '[':
+        return json_lib::json_type::array_json;
+    case '{':
+        return json_lib::json_type::object_json;
+    default:
+        corrupt();
+    }
+}
+
+size_t index_lib::structural_index::size(const span& value) const {
+    return value.record == 0 ? 0 : read_u32(value.record + 1);
+}
+
+std::optional<index_lib::span> index_lib::structural_index::element(
+    const span& value, const size_t index
+) const {
+    if (type(value) != json_lib::json_type::array_json
+        || index >= size(value)) {
+        return std::nullopt;
+    }
+    return read_span(value.record + record_header_size + element_size * index);
+}
+
+std::optional<index_lib::span> index_lib::structural_index::member(
+    const span& value, const std::string_view key
+) const {
+    if (type(value) != json_lib::json_type::object_json) {
+        return std::nullopt;
+    }
+    const uint64_t entries = value.record + record_header_size;
+    const auto key_at = [&](const size_t index) {
+        const uint64_t offset = read_u64(entries + member_size * index);
+        const uint32_t length = read_u32(offset);
+        if (data.size() - offset - 4 < length) {
+            corrupt();
+        }
+        return data.substr(offset + 4, length);
+    };
+    size_t low = 0;
+    size_t high = size(value);
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (key_at(middle) < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == size(value) || key_at(low) != key) {
+        return std::nullopt;
+    }
+    return read_span(entries + member_size * low + 8);
+}
+
+namespace {
+std::shared_ptr<json_lib::json> parse(const std::string_view text) {
+    std::string buffer(text);
+    std::shared_ptr<json_lib::json> result;
+    parser_lib::parser(buffer).completely_parse_json(result);
+    return result;
+}
+
+/**
+ * Follow `path` through the index as far as it reaches. Accessors the index
+ * cannot answer (missing keys, indices out of range, mismatched types) are
+ * left unconsumed.
+ *
+ * @return The value reached and the number of accessors consumed.
+ */
+std::pair<index_lib::span, size_t> seek(
+    const index_lib::structural_index& index,
+    const std::deque<std::shared_ptr<json_lib::json>>& path
+) {
+    index_lib::span current = index.root();
+    size_t consumed = 0;
+    for (; consumed < path.size(); ++consumed) {
+        const auto& accessor = path[consumed];
+        std::optional<index_lib::span> next;
+        if (accessor->type() == json_lib::json_type::string_json) {
+            next = index.member(
+                current,
+                std::dynamic_pointer_cast<json_lib::json_string>(accessor)
+                    ->as_key()
+            );
+        } else if (index.type(current) == json_lib::json_type::array_json) {
+            int position
+                = std::dynamic_pointer_cast<json_lib::json_integer>(accessor)
+                      ->as_index();
+            if (json_lib::enable_negative_indexing && position < 0) {
+                position += static_cast<int>(index.size(current));
+            }
+            if (position >= 0) {
+                next = index.element(current, static_cast<size_t>(position));
+            }
+        }
+        if (!next) {
+            break;
+        }
+        current = *next;
+    }
+    return { current, consumed };
+}
+
+/**
+ * Parse the value `path` leads to, seeking through the index first and
+ * applying the remaining accessors to the parsed tree, so for well-formed
+ * input errors match those of a full parse. Only the located span is
+ * parsed; malformed text outside it is not reported.
+ */
+std::shared_ptr<json_lib::json> locate(
+    const index_lib::structural_index& index, const std::string_view text,
+    const std::deque<std::shared_ptr<json_lib::json>>& path
+) {
+    auto [current, consumed] = seek(index, path);
+    if (current.begin > current.end || current.end > text.size()) {
+        corrupt();
+    }
+
+    auto value = parse(text.substr(current.begin, current.end - current.begin));
+    for (; consumed < path.size(); ++consumed) {
+        value = value->by(path[consumed]);
+    }
+    return value;
+}
+
+/**
+ * `size()` of a constant path that ends in an indexed container, answered
+ * from its record without parsing.
+ */
+std::shared_ptr<json_lib::json> indexed_size(
+    const index_lib::structural_index& index,
+    const reference_lib::json_function& function
+) {
+    if (function.get_name() != "size" || function.get_args().size() != 1
+        || function.get_args()[0]->type()
+            != json_lib::json_type::reference_json) {
+        return nullptr;
+    }
+    const auto reference
+        = std::dynamic_pointer_cast<reference_lib::json_reference>(
+            function.get_args()[0]
+        );
+    if (!reference_lib::is_constant_path(*reference)) {
+        return nullptr;
+    }
+    const auto [current, consumed] = seek(index, reference->get_tail());
+    if (consumed != reference->get_tail().size() || current.record == 0) {
+        return nullptr;
+    }
+    return std::make_shared<json_lib::json_integer>(
+        static_cast<int>(index.size(current))
+    );
+}
+}
+
+std::shared_ptr<json_lib::json> index_lib::evaluate(
+    const structural_index& index, const std::string_view text,
+    const std::shared_ptr<json_lib::json>& expression
+) {
+    const auto resolved = reference_lib::resolve_paths(
+        expression,
+        [&](const reference_lib::json_reference& reference)
+            -> std::shared_ptr<json_lib::json> {
+            if (!reference_lib::is_constant_path(reference)) {
+                return nullptr;
+            }
+            return locate(index, text, reference.get_tail());
+        },
+        [&](const reference_lib::json_function& function) {
+            return indexed_size(index, function);
+        }
+    );
+    if (resolved) {
+        return reference_lib::evaluate(
+            resolved, std::make_shared<json_lib::json>()
+        );
+    }
+    return reference_lib::evaluate(expression, parse(text));
+}
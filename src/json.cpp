@@ -23,7 +23,9 @@
  */
 
 #include "json.hpp"
+#include "alloc.hpp"
 #include "reference.hpp"
+#include "trace.hpp"
 
 #include <algorithm>
 #include <ranges>
@@ -245,6 +247,8 @@ std::string json_lib::json::to_string() const {
 }
 
 std::string json_lib::json::formatted_string(const bool pretty) const {
+    const alloc_lib::phase_scope scope(alloc_lib::phase::serialize);
+    const trace_lib::span span("serialize");
     return indented_string(0, pretty);
 }
 
@@ -353,6 +357,8 @@ json_lib::json::by(const std::shared_ptr<json>& item) const {
     throw throw_message(shared_from_this(), item);
 }
 
+bool json_lib::json_boolean::as_bool() const { return value; }
+
 int json_lib::json_integer::as_index() const { return value; }
 
 std::shared_ptr<json_lib::json>
@@ -366,6 +372,8 @@ json_lib::json_integer::by(const std::shared_ptr<json>& item) const {
 
 std::string json_lib::json_string::as_key() const { return value; }
 
+size_t json_lib::json_string::size() const { return value.size(); }
+
 std::shared_ptr<json_lib::json>
 json_lib::json_string::by(const std::shared_ptr<json>& item) const {
     if (enable_symmetric_indexing && item->type() == json_type::object_json) {
@@ -377,6 +385,11 @@ json_lib::json_string::by(const std::shared_ptr<json>& item) const {
 
 size_t json_lib::json_array::size() const { return list.size(); }
 
+const std::vector<std::shared_ptr<json_lib::json>>&
+json_lib::json_array::items() const {
+    return list;
+}
+
 std::shared_ptr<json_lib::json> json_lib::json_array::at(const int index
 ) const {
     auto absolute_index = static_cast<size_t>(index);
@@ -400,6 +413,11 @@ json_lib::json_array::by(const std::shared_ptr<json>& item) const {
 
 size_t json_lib::json_object::size() const { return data.size(); }
 
+const std::vector<std::pair<std::string, std::shared_ptr<json_lib::json>>>&
+json_lib::json_object::items() const {
+    return data;
+}
+
 std::vector<std::string> json_lib::json_object::get_keys() {
     if (keys.size() != size()) {
         auto result = std::views::keys(indexes);
@@ -424,3 +442,81 @@ json_lib::json_object::by(const std::shared_ptr<json>& item) const {
     }
     return json::by(item);
 }
+
+size_t json_lib::json::node_size(const size_t object_size) {
+    // `make_shared` places the object next to its control block: a vtable
+    // pointer and the use and weak reference counts.
+    return object_size + sizeof(void*) + 2 * sizeof(int);
+}
+
+size_t json_lib::json::heap_size(const std::string& str) {
+    static const size_t inline_capacity = std::string().capacity();
+    return str.capacity() > inline_capacity ? str.capacity() + 1 : 0;
+}
+
+size_t json_lib::json::memory_usage() const {
+    std::unordered_set<const json*> counted;
+    return footprint(counted);
+}
+
+size_t json_lib::json::footprint(std::unordered_set<const json*>&) const {
+    return node_size(sizeof(json));
+}
+
+size_t
+json_lib::json_boolean::footprint(std::unordered_set<const json*>&) const {
+    return node_size(sizeof(json_boolean));
+}
+
+size_t
+json_lib::json_integer::footprint(std::unordered_set<const json*>&) const {
+    return node_size(sizeof(json_integer));
+}
+
+size_t json_lib::json_real::footprint(std::unordered_set<const json*>&) const {
+    return node_size(sizeof(json_real)) + heap_size(str_value);
+}
+
+size_t
+json_lib::json_string::footprint(std::unordered_set<const json*>&) const {
+    return node_size(sizeof(json_string)) + heap_size(value);
+}
+
+size_t json_lib::json_array::footprint(std::unordered_set<const json*>& counted
+) const {
+    if (!counted.emplace(this).second) {
+        return 0;
+    }
+    size_t result = node_size(sizeof(json_array))
+        + list.capacity() * sizeof(std::shared_ptr<json>);
+    for (const auto& child : list) {
+        result += child->footprint(counted);
+    }
+    return result;
+}
+
+size_t json_lib::json_object::footprint(
+    std::unordered_set<const json*>& counted
+) const {
+    if (!counted.emplace(this).second) {
+        return 0;
+    }
+    size_t result = node_size(sizeof(json_object))
+        + data.capacity()
+            * sizeof(std::pair<std::string, std::shared_ptr<json>>);
+    for (const auto& [key, child] : data) {
+        result += heap_size(key) + child->footprint(counted);
+    }
+    // Hash table: the bucket array plus one node per key holding the next
+    // pointer, the key-value pair and the cached hash code.
+    result += indexes.bucket_count() * sizeof(void*);
+    for (const auto& key : indexes | std::views::keys) {
+        result += sizeof(void*) + sizeof(std::pair<const std::string, size_t>)
+            + sizeof(size_t) + heap_size(key);
+    }
+    result += keys.capacity() * sizeof(std::string);
+    for (const auto& key : keys) {
+        result += heap_size(key);
+    }
+    return result;
+}
@@ -24,27 +24,515 @@
 
 #include <iostream>
 
+#include "cbor.hpp"
+#include "cli.hpp"
+#include "columnar.hpp"
+#include "dataguide.hpp"
+#include "explain.hpp"
+#include "files.hpp"
+#include "index.hpp"
+#include "metrics.hpp"
+#include "msgpack.hpp"
+#include "parallel.hpp"
 #include "parser.hpp"
+#include "projection.hpp"
+#include "schema.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+#include "transport.hpp"
 
-int main(const int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <json-file> \"<expression>\"\n";
-        return 1;
+#include <fstream>
+#include <iomanip>
+#include <optional>
+
+namespace {
+files_lib::file_format file_format(const cli_lib::options& options) {
+    if (options.format_by_extension) {
+        return files_lib::file_format::by_extension;
     }
+    return options.input_format == cli_lib::data_format::msgpack
+        ? files_lib::file_format::msgpack
+        : files_lib::file_format::json;
+}
 
+std::shared_ptr<json_lib::json>
+parse_document(std::string& buffer, const cli_lib::data_format format) {
+    if (format == cli_lib::data_format::msgpack) {
+        return msgpack_lib::decode(buffer);
+    }
     std::shared_ptr<json_lib::json> base;
-    const std::filesystem::path input_file(argv[1]);
-    parser_lib::parser prs(input_file);
+    parser_lib::parser prs(buffer);
     prs.completely_parse_json(base);
+    return base;
+}
 
+std::string
+serialize(const json_lib::json& result, const cli_lib::data_format format) {
+    switch (format) {
+    case cli_lib::data_format::msgpack:
+        return msgpack_lib::encode(result);
+    case cli_lib::data_format::cbor:
+        return cbor_lib::encode(result);
+    default:
+        return result.to_string();
+    }
+}
+
+std::shared_ptr<json_lib::json> load_document(
+    const cli_lib::options& options, stats_lib::run_stats& stats
+) {
+    stats_lib::stopwatch timer;
+    std::string buffer = parser_lib::read_file(options.input);
+    stats.bytes_read = buffer.size();
+    stats.read_time = timer.elapsed();
+
+    timer.restart();
+    auto base = parse_document(buffer, options.input_format);
+    stats.parse_time = timer.elapsed();
+    return base;
+}
+
+std::shared_ptr<json_lib::json>
+compile(std::string expression, stats_lib::run_stats& stats) {
+    const stats_lib::stopwatch timer;
     std::shared_ptr<json_lib::json> result;
-    std::string expr = argv[2];
-    prs = parser_lib::parser(expr);
+    parser_lib::parser prs(expression);
     prs.completely_parse_json(result, true);
+    stats.compile_time = timer.elapsed();
+    return result;
+}
+
+void bench(const cli_lib::options& options) {
+    const std::string buffer = parser_lib::read_file(options.input);
+    std::shared_ptr<json_lib::json> base;
+    if (!options.bench_parse) {
+        std::string document = buffer;
+        base = parse_document(document, options.input_format);
+    }
+
+    std::vector<std::chrono::nanoseconds> samples;
+    std::vector<std::chrono::nanoseconds> parse_samples;
+    samples.reserve(options.bench);
+    parse_samples.reserve(options.bench_parse ? options.bench : 0);
+    for (size_t i = 0; i < options.bench; ++i) {
+        std::string document = options.bench_parse ? buffer : std::string();
+        std::string expression = options.expression;
+        const auto start = std::chrono::steady_clock::now();
+        if (options.bench_parse) {
+            base = parse_document(document, options.input_format);
+            parse_samples.emplace_back(
+                std::chrono::steady_clock::now() - start
+            );
+        }
+        std::shared_ptr<json_lib::json> result;
+        parser_lib::parser prs(expression);
+        prs.completely_parse_json(result, true);
+        result = reference_lib::evaluate(result, base);
+        const std::string output = serialize(*result, options.output_format);
+        samples.emplace_back(std::chrono::steady_clock::now() - start);
+    }
+
+    const auto summary = stats_lib::summarize(std::move(samples));
+    std::cout << summary.to_string();
+    if (options.bench_parse) {
+        const double megabytes = static_cast<double>(buffer.size()) / 1e6;
+        const auto parsing = stats_lib::summarize(std::move(parse_samples));
+        std::cout << "parse throughput: " << std::fixed
+                  << std::setprecision(1) << parsing.throughput() * megabytes
+                  << " MB/s\n";
+    }
+}
+
+void write_shared(const std::string& target, const std::string& output) {
+    if (const auto fd = cli_lib::output_fd(target)) {
+        transport_lib::write_segment(*fd, output);
+        return;
+    }
+    transport_lib::write_segment(std::filesystem::path(target), output);
+}
+
+void print_result(
+    const cli_lib::options& options, const json_lib::json& result,
+    stats_lib::run_stats& stats
+) {
+    const stats_lib::stopwatch timer;
+    if (options.output_shm.empty()
+        && options.output_format == cli_lib::data_format::cbor) {
+        cbor_lib::write(result, std::cout);
+        std::cout.flush();
+        stats.serialize_time = timer.elapsed();
+        return;
+    }
+    const bool binary = options.output_format != cli_lib::data_format::json;
+    const std::string output = serialize(result, options.output_format);
+    if (!options.output_shm.empty()) {
+        write_shared(options.output_shm, output);
+    }
+    stats.serialize_time = timer.elapsed();
+    if (!options.output_shm.empty()) {
+        std::cout << output.size() << std::endl;
+    } else if (binary) {
+        std::cout.write(
+            output.data(), static_cast<std::streamsize>(output.size())
+        );
+        std::cout.flush();
+    } else {
+        std::cout << output << std::endl;
+    }
+}
+
+void run_snapshot(const cli_lib::options& options) {
+    stats_lib::run_stats stats;
+    stats_lib::stopwatch timer;
+    const snapshot_lib::snapshot data(options.input);
+    stats.bytes_read = data.bytes().size();
+    stats.read_time = timer.elapsed();
+
+    const auto expression = compile(options.expression, stats);
+    timer.restart();
+    const auto result = snapshot_lib::evaluate(data, expression);
+    stats.evaluate_time = timer.elapsed();
+
+    print_result(options, *result, stats);
+    if (options.stats) {
+        std::cerr << stats.to_string() << std::endl;
+    }
+}
+
+void run_columnar(const cli_lib::options& options) {
+    stats_lib::run_stats stats;
+    stats_lib::stopwatch timer;
+    const auto data = columnar_lib::table::read(options.input);
+    stats.read_time = timer.elapsed();
+
+    const auto expression = compile(options.expression, stats);
+    timer.restart();
+    const auto result = columnar_lib::evaluate(data, expression);
+    stats.evaluate_time = timer.elapsed();
+
+    print_result(options, *result, stats);
+    if (options.stats) {
+        std::cerr << stats.to_string() << std::endl;
+    }
+}
+
+void shred(const cli_lib::options& options) {
+    stats_lib::run_stats stats;
+    const auto base = load_document(options, stats);
+    const auto records
+        = reference_lib::evaluate(compile(options.expression, stats), base);
+    if (records->type() != json_lib::json_type::array_json) {
+        throw std::invalid_argument(
+            "option `--shred` expects an expression selecting an array"
+        );
+    }
+    columnar_lib::table::shred(
+        dynamic_cast<const json_lib::json_array&>(*records)
+    )
+        .write(options.shred);
+}
+
+/**
+ * Open the sidecar index of the input if there is one, it is readable and it
+ * was built from the input as it is now.
+ */
+std::unique_ptr<index_lib::structural_index>
+open_index(const std::filesystem::path& input) {
+    const auto path = index_lib::sidecar_path(input);
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error)) {
+        return nullptr;
+    }
+    std::unique_ptr<index_lib::structural_index> index;
+    try {
+        index = std::make_unique<index_lib::structural_index>(path);
+    } catch (const std::runtime_error&) {
+        return nullptr;
+    }
+    if (index->source() != index_lib::stamp::of(input)) {
+        return nullptr;
+    }
+    return index;
+}
+
+void run_indexed(
+    const cli_lib::options& options, const index_lib::structural_index& index,
+    const std::shared_ptr<json_lib::json>& expression,
+    stats_lib::run_stats& stats
+) {
+    stats_lib::stopwatch timer;
+    const transport_lib::mapped_segment text(options.input);
+    stats.read_time = timer.elapsed();
+
+    timer.restart();
+    const auto result = index_lib::evaluate(index, text.view(), expression);
+    stats.evaluate_time = timer.elapsed();
+
+    print_result(options, *result, stats);
+    if (options.stats) {
+        std::cerr << stats.to_string() << std::endl;
+    }
+}
+
+/**
+ * Read the dataguide stored with the input if there is one, it is readable
+ * and it was built from the input as it is now.
+ */
+std::optional<dataguide_lib::dataguide>
+open_guide(const std::filesystem::path& input) {
+    const auto path = dataguide_lib::sidecar_path(input);
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error)) {
+        return std::nullopt;
+    }
+    std::optional<dataguide_lib::dataguide> guide;
+    try {
+        guide = dataguide_lib::dataguide::read(path);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+    if (guide->source() != index_lib::stamp::of(input)) {
+        return std::nullopt;
+    }
+    return guide;
+}
 
-    result->set_root(base);
+/**
+ * Check the expression against the dataguide and print its result if the
+ * dataguide alone answers it.
+ */
+bool run_guided(
+    const cli_lib::options& options, const dataguide_lib::dataguide& guide,
+    const std::shared_ptr<json_lib::json>& expression,
+    stats_lib::run_stats& stats
+) {
+    const stats_lib::stopwatch timer;
+    dataguide_lib::check(guide, *expression);
+    const auto result = dataguide_lib::answer(guide, expression);
+    if (result == nullptr) {
+        return false;
+    }
+    stats.evaluate_time = timer.elapsed();
+    print_result(options, *result, stats);
+    if (options.stats) {
+        std::cerr << stats.to_string() << std::endl;
+    }
+    return true;
+}
 
-    std::cout << result->to_string() << std::endl;
+void run(const cli_lib::options& options) {
+    if (options.explain == cli_lib::explain_mode::none
+        && snapshot_lib::is_snapshot(options.input)) {
+        run_snapshot(options);
+        return;
+    }
+    if (options.explain == cli_lib::explain_mode::none
+        && columnar_lib::is_table(options.input)) {
+        run_columnar(options);
+        return;
+    }
+    // Compiled at most once, by whichever path needs it first.
+    stats_lib::run_stats stats;
+    std::shared_ptr<json_lib::json> expression;
+    const auto compiled = [&] {
+        if (expression == nullptr) {
+            expression = compile(options.expression, stats);
+        }
+        return expression;
+    };
+    if (options.explain == cli_lib::explain_mode::none
+        && options.input_format == cli_lib::data_format::json) {
+        if (const auto guide = open_guide(options.input);
+            guide && run_guided(options, *guide, compiled(), stats)) {
+            return;
+        }
+        if (const auto index = open_index(options.input)) {
+            run_indexed(options, *index, compiled(), stats);
+            return;
+        }
+    }
+    if (options.explain == cli_lib::explain_mode::plan) {
+        std::cout << explain_lib::render(explain_lib::build_plan(compiled()));
+        return;
+    }
+
+    const auto base = load_document(options, stats);
+    auto result = compiled();
+
+    explain_lib::plan_node plan;
+    reference_lib::evaluation_profile profile;
+    if (options.explain == cli_lib::explain_mode::analyze) {
+        plan = explain_lib::build_plan(result);
+        reference_lib::active_profile = &profile;
+    }
+    stats_lib::stopwatch timer;
+    result = reference_lib::evaluate(result, base);
+    stats.evaluate_time = timer.elapsed();
+    reference_lib::active_profile = nullptr;
+
+    if (options.explain == cli_lib::explain_mode::analyze) {
+        std::cout << explain_lib::render(plan, &profile)
+                  << "evaluate: " << stats.evaluate_time.count() << "us"
+                  << std::endl;
+    } else {
+        print_result(options, *result, stats);
+    }
 
-    return 0;
+    if (options.stats) {
+        stats.document.collect(*base);
+        stats.document_memory = base->memory_usage();
+        std::cerr << stats.to_string() << std::endl;
+    }
+}
+
+int find(const cli_lib::options& options) {
+    auto summaries = options.catalog.empty()
+        ? bloom_lib::catalog()
+        : bloom_lib::catalog::read(options.catalog);
+    const auto files = files_lib::expand(options.inputs);
+    const auto result = files_lib::find_files(
+        files, *options.find, summaries, options.threads, std::cout,
+        file_format(options)
+    );
+    if (!options.catalog.empty() && summaries.modified()) {
+        summaries.write(options.catalog);
+    }
+    if (options.stats) {
+        std::cerr << R"({"files": )" << files.size()
+                  << R"(, "skipped": )" << result.skipped
+                  << R"(, "parsed": )" << result.parsed
+                  << R"(, "matched": )" << result.matched
+                  << R"(, "failed": )" << result.failed << '}' << std::endl;
+    }
+    return result.failed == 0 ? 0 : 1;
+}
+
+void export_metrics(
+    const std::string& target, const metrics_lib::registry& registry
+) {
+    constexpr std::string_view socket_prefix = "unix:";
+    if (target.starts_with(socket_prefix)) {
+        registry.write_socket(target.substr(socket_prefix.size()));
+    } else {
+        registry.write_file(target);
+    }
+}
+}
+
+int main(const int argc, char* argv[]) {
+    cli_lib::options options;
+    try {
+        options = cli_lib::parse_options(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << '\n' << cli_lib::usage(argv[0]);
+        return 1;
+    }
+
+    if (!options.compile.empty()) {
+        stats_lib::run_stats stats;
+        snapshot_lib::write(
+            *load_document(options, stats), options.compile
+        );
+        return 0;
+    }
+
+    if (!options.shred.empty()) {
+        shred(options);
+        return 0;
+    }
+
+    if (options.build_guide) {
+        dataguide_lib::build(options.input);
+        return 0;
+    }
+
+    if (options.build_index > 0) {
+        index_lib::build(options.input, options.build_index);
+        return 0;
+    }
+
+    if (options.find) {
+        return find(options);
+    }
+
+    if (options.infer_schema) {
+        std::cout << schema_lib::infer(
+                         files_lib::expand(options.inputs), options.threads
+                     )
+                         .to_string()
+                  << std::endl;
+        return 0;
+    }
+
+    if (options.inputs.size() > 1 || files_lib::is_collection(options.input)) {
+        auto summaries = bloom_lib::catalog::read(options.catalog);
+        const size_t failed = files_lib::evaluate_files(
+            files_lib::expand(options.inputs), options.expression,
+            options.threads, std::cout,
+            options.catalog.empty() ? nullptr : &summaries,
+            file_format(options)
+        );
+        if (summaries.modified()) {
+            summaries.write(options.catalog);
+        }
+        return failed == 0 ? 0 : 1;
+    }
+
+    if (options.parallel > 0) {
+        return parallel_lib::run(
+            options.input, options.expression, options.parallel, std::cout
+        );
+    }
+
+    if (!options.limits.unlimited()) {
+        governor_lib::active_limits = &options.limits;
+    }
+
+    metrics_lib::registry registry;
+    if (!options.metrics.empty()) {
+        metrics_lib::active_registry = &registry;
+    }
+
+    projection_lib::cache columns(options.column_cache);
+    if (options.column_cache > 0) {
+        projection_lib::active_cache = &columns;
+    }
+
+    governor_lib::cancellation_token token;
+    if (options.timeout.count() != 0) {
+        token.cancel_after(options.timeout);
+    }
+    const governor_lib::token_scope token_scope(token);
+
+    int status = 0;
+    try {
+        if (options.bench > 0) {
+            bench(options);
+        } else if (options.trace.empty()) {
+            run(options);
+        } else {
+            trace_lib::recorder recorder(options.trace_elements);
+            trace_lib::active_recorder = &recorder;
+            run(options);
+            trace_lib::active_recorder = nullptr;
+            std::ofstream ofs(options.trace);
+            recorder.write(ofs);
+        }
+    } catch (const governor_lib::limit_exceeded& e) {
+        trace_lib::active_recorder = nullptr;
+        std::cerr << e.what() << std::endl;
+        status = 2;
+    } catch (const governor_lib::operation_cancelled& e) {
+        trace_lib::active_recorder = nullptr;
+        std::cerr << e.what() << std::endl;
+        status = 2;
+    }
+
+    if (!options.metrics.empty()) {
+        metrics_lib::active_registry = nullptr;
+        export_metrics(options.metrics, registry);
+    }
+    projection_lib::active_cache = nullptr;
+    return status;
 }
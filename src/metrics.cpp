@@ -0,0 +1,292 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "metrics.hpp"
+
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+void render_counter(
+    std::ostringstream& oss, const std::string& name, const std::string& help,
+    const metrics_lib::counter& value
+) {
+    oss << "# HELP " << name << ' ' << help << '\n'
+        << "# TYPE " << name << " counter\n"
+        << name << ' ' << value.value() << '\n';
+}
+
+void render_series(
+    std::ostringstream& oss, const std::string& name,
+    const std::string& labels, const metrics_lib::histogram& value
+) {
+    const std::string prefix = labels.empty() ? "" : labels + ',';
+    const std::string suffix = labels.empty() ? "" : '{' + labels + '}';
+    for (double decade = 1e-6; decade < 10.5; decade *= 10) {
+        for (const double step : { 1.0, 2.5, 5.0 }) {
+            const double bound = decade * step;
+            if (bound > 10.5) {
+                break;
+            }
+            const auto limit = std::chrono::nanoseconds(
+                static_cast<std::int64_t>(std::llround(bound * 1e9))
+            );
+            oss << name << "_bucket{" << prefix << "le=\"" << bound << "\"} "
+                << value.count_below(limit) << '\n';
+        }
+    }
+    oss << name << "_bucket{" << prefix << "le=\"+Inf\"} " << value.count()
+        << '\n'
+        << name << "_sum" << suffix << ' '
+        << static_cast<double>(value.sum().count()) / 1e9 << '\n'
+        << name << "_count" << suffix << ' ' << value.count() << '\n';
+}
+
+void render_histogram(
+    std::ostringstream& oss, const std::string& name, const std::string& help,
+    const metrics_lib::histogram& value
+) {
+    oss << "# HELP " << name << ' ' << help << '\n'
+        << "# TYPE " << name << " histogram\n";
+    render_series(oss, name, "", value);
+}
+}
+
+void metrics_lib::counter::add(const uint64_t amount) {
+    total.fetch_add(amount, std::memory_order_relaxed);
+}
+
+uint64_t metrics_lib::counter::value() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+size_t metrics_lib::histogram::index_of(const uint64_t value) {
+    if (value < sub_bucket_count) {
+        return static_cast<size_t>(value);
+    }
+    const auto exponent = static_cast<size_t>(std::bit_width(value)) - 1;
+    const size_t shift = exponent - (sub_bucket_bits - 1);
+    const auto sub_index = static_cast<size_t>(value >> shift);
+    return (shift + 1) * sub_bucket_half + sub_index - sub_bucket_half;
+}
+
+uint64_t metrics_lib::histogram::lowest_of(const size_t index) {
+    if (index < sub_bucket_count) {
+        return index;
+    }
+    const size_t shift = index / sub_bucket_half - 1;
+    const uint64_t sub_index = index % sub_bucket_half + sub_bucket_half;
+    return sub_index << shift;
+}
+
+uint64_t metrics_lib::histogram::highest_of(const size_t index) {
+    if (index < sub_bucket_count) {
+        return index;
+    }
+    const size_t shift = index / sub_bucket_half - 1;
+    const uint64_t sub_index = index % sub_bucket_half + sub_bucket_half;
+    return ((sub_index + 1) << shift) - 1;
+}
+
+void metrics_lib::histogram::record(const std::chrono::nanoseconds latency) {
+    const auto value = static_cast<uint64_t>(std::max<std::int64_t>(
+        latency.count(), 0
+    ));
+    buckets[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    total_ns.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t metrics_lib::histogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds metrics_lib::histogram::sum() const {
+    return std::chrono::nanoseconds(
+        static_cast<std::int64_t>(total_ns.load(std::memory_order_relaxed))
+    );
+}
+
+uint64_t metrics_lib::histogram::count_below(
+    const std::chrono::nanoseconds limit
+) const {
+    if (limit.count() < 0) {
+        return 0;
+    }
+    const auto bound = static_cast<uint64_t>(limit.count());
+    uint64_t result = 0;
+    for (size_t i = 0; i < bucket_count && highest_of(i) <= bound; ++i) {
+        result += buckets[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+std::chrono::nanoseconds
+metrics_lib::histogram::percentile(const double percent) const {
+    const uint64_t recorded = count();
+    if (recorded == 0) {
+        return {};
+    }
+    const double clamped = std::min(std::max(percent, 0.0), 100.0);
+    const auto target = std::max<uint64_t>(
+        static_cast<uint64_t>(
+            std::ceil(clamped / 100.0 * static_cast<double>(recorded))
+        ),
+        1
+    );
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::chrono::nanoseconds(
+                static_cast<std::int64_t>(highest_of(i))
+            );
+        }
+    }
+    return std::chrono::nanoseconds(
+        static_cast<std::int64_t>(highest_of(bucket_count - 1) >> 1)
+    );
+}
+
+std::string metrics_lib::registry::render() const {
+    std::ostringstream oss;
+    render_histogram(
+        oss, "json_eval_parse_seconds", "Time spent parsing JSON documents.",
+        parse
+    );
+    render_histogram(
+        oss, "json_eval_compile_seconds", "Time spent parsing expressions.",
+        compile
+    );
+    render_histogram(
+        oss, "json_eval_evaluate_seconds",
+        "Time spent evaluating expressions.", evaluate
+    );
+    oss << "# HELP json_eval_queue_seconds Time queries waited for an "
+           "executor worker.\n"
+        << "# TYPE json_eval_queue_seconds histogram\n";
+    render_series(
+        oss, "json_eval_queue_seconds", "lane=\"cheap\"", cheap_queue
+    );
+    render_series(
+        oss, "json_eval_queue_seconds", "lane=\"expensive\"", expensive_queue
+    );
+    render_counter(
+        oss, "json_eval_cache_hits_total", "Lookups answered from a cache.",
+        cache_hits
+    );
+    render_counter(
+        oss, "json_eval_documents_loaded_total",
+        "JSON documents parsed successfully.", documents_loaded
+    );
+    render_counter(
+        oss, "json_eval_bytes_parsed_total",
+        "Input bytes of successfully parsed documents.", bytes_parsed
+    );
+    render_counter(
+        oss, "json_eval_errors_total", "Failed parses and evaluations.", errors
+    );
+    return oss.str();
+}
+
+void metrics_lib::registry::write_file(const std::filesystem::path& path
+) const {
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream ofs(temporary);
+        if (!ofs.is_open()) {
+            throw std::invalid_argument(
+                "failed to open file with path: " + temporary.string()
+            );
+        }
+        ofs << render();
+    }
+    std::filesystem::rename(temporary, path);
+}
+
+void metrics_lib::registry::write_socket(const std::filesystem::path& path
+) const {
+#if defined(__unix__) || defined(__APPLE__)
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    const std::string name = path.string();
+    if (name.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("socket path is too long: " + name);
+    }
+    name.copy(address.sun_path, name.size());
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("failed to create socket");
+    }
+    const auto* target = reinterpret_cast<const sockaddr*>(&address);
+    if (connect(fd, target, sizeof(address)) != 0) {
+        close(fd);
+        throw std::runtime_error("failed to connect to socket: " + name);
+    }
+    const std::string text = render();
+    for (size_t sent = 0; sent < text.size();) {
+        const auto written = write(fd, text.data() + sent, text.size() - sent);
+        if (written <= 0) {
+            close(fd);
+            throw std::runtime_error("failed to write to socket: " + name);
+        }
+        sent += static_cast<size_t>(written);
+    }
+    close(fd);
+#else
+    throw std::runtime_error(
+        "local sockets are not supported: " + path.string()
+    );
+#endif
+}
+
+metrics_lib::timer::timer(histogram registry::* target)
+    : owner(active_registry)
+    , target(target) {
+    if (owner != nullptr) {
+        exceptions = std::uncaught_exceptions();
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+metrics_lib::timer::~timer() {
+    if (owner == nullptr) {
+        return;
+    }
+    if (std::uncaught_exceptions() > exceptions) {
+        owner->errors.add();
+    } else {
+        (owner->*target).record(std::chrono::steady_clock::now() - start);
+    }
+}
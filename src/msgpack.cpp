@@ -0,0 +1,415 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "msgpack.hpp"
+#include "alloc.hpp"
+#include "governor.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+/**
+ * Shortest text that reads back as `value`, with a fraction or exponent so
+ * that it stays a real number.
+ */
+template <typename Float> std::string real_text(const Float value) {
+    if (!std::isfinite(value)) {
+        throw std::runtime_error("MessagePack float is not a JSON number");
+    }
+    char buffer[32];
+    const auto [end, error] = std::to_chars(buffer, buffer + 32, value);
+    std::string text(buffer, end);
+    if (text.find_first_of(".e") == std::string::npos) {
+        text += ".0";
+    }
+    return text;
+}
+
+class decoder {
+public:
+    explicit decoder(const std::string_view bytes)
+        : bytes(bytes) { }
+
+    std::shared_ptr<json_lib::json> value() {
+        ++nodes;
+        governor_lib::poll();
+        if (const auto* limits = governor_lib::active_limits.load()) {
+            governor_lib::check("max_nodes", nodes, limits->max_nodes);
+            governor_lib::check(
+                "max_memory", nodes * sizeof(json_lib::json),
+                limits->max_memory
+            );
+        }
+
+        const uint8_t head = byte();
+        if (head <= 0x7F) {
+            return std::make_shared<json_lib::json_integer>(head);
+        }
+        if (head >= 0xE0) {
+            return std::make_shared<json_lib::json_integer>(
+                static_cast<int8_t>(head)
+            );
+        }
+        if ((head & 0xF0) == 0x80) {
+            return map(head & 0x0Fu);
+        }
+        if ((head & 0xF0) == 0x90) {
+            return array(head & 0x0Fu);
+        }
+        if ((head & 0xE0) == 0xA0) {
+            return string(head & 0x1Fu);
+        }
+        switch (head) {
+        case 0xC0:
+            return std::make_shared<json_lib::json>();
+        case 0xC2:
+            return std::make_shared<json_lib::json_boolean>(false);
+        case 0xC3:
+            return std::make_shared<json_lib::json_boolean>(true);
+        case 0xCA: {
+            const auto bits = static_cast<uint32_t>(number(4));
+            float real = 0;
+            std::memcpy(&real, &bits, sizeof(real));
+            return std::make_shared<json_lib::json_real>(real_text(real));
+        }
+        case 0xCB: {
+            const uint64_t bits = number(8);
+            double real = 0;
+            std::memcpy(&real, &bits, sizeof(real));
+            return std::make_shared<json_lib::json_real>(real_text(real));
+        }
+        case 0xCC:
+        case 0xCD:
+        case 0xCE:
+        case 0xCF:
+            return unsigned_integer(number(size_t { 1 } << (head - 0xCC)));
+        case 0xD0:
+            return signed_integer(static_cast<int8_t>(number(1)));
+        case 0xD1:
+            return signed_integer(static_cast<int16_t>(number(2)));
+        case 0xD2:
+            return signed_integer(static_cast<int32_t>(number(4)));
+        case 0xD3:
+            return signed_integer(static_cast<int64_t>(number(8)));
+        case 0xD9:
+        case 0xDA:
+        case 0xDB:
+            return string(number(size_t { 1 } << (head - 0xD9)));
+        case 0xDC:
+        case 0xDD:
+            return array(number(size_t { 2 } << (head - 0xDC)));
+        case 0xDE:
+        case 0xDF:
+            return map(number(size_t { 2 } << (head - 0xDE)));
+        default:
+            throw std::runtime_error(
+                "MessagePack type 0x" + hex(head) + " has no JSON equivalent"
+            );
+        }
+    }
+
+    [[nodiscard]] bool done() const { return pos == bytes.size(); }
+
+private:
+    std::string_view bytes;
+    size_t pos = 0;
+    size_t depth = 0;
+    size_t nodes = 0;
+
+    static std::string hex(const uint8_t value) {
+        constexpr std::string_view digits = "0123456789abcdef";
+        return { digits[value >> 4], digits[value & 0x0F] };
+    }
+
+    void need(const uint64_t count) const {
+        if (bytes.size() - pos < count) {
+            throw std::runtime_error("truncated MessagePack document");
+        }
+    }
+
+    uint8_t byte() {
+        need(1);
+        return static_cast<uint8_t>(bytes[pos++]);
+    }
+
+    /**
+     * Big-endian unsigned integer of `width` bytes.
+     */
+    uint64_t number(const size_t width) {
+        need(width);
+        uint64_t value = 0;
+        for (size_t i = 0; i < width; ++i) {
+            value = value << 8 | static_cast<uint8_t>(bytes[pos++]);
+        }
+        return value;
+    }
+
+    static std::shared_ptr<json_lib::json>
+    signed_integer(const int64_t value) {
+        if (value < std::numeric_limits<int>::min()
+            || value > std::numeric_limits<int>::max()) {
+            throw std::out_of_range("MessagePack integer out of range");
+        }
+        return std::make_shared<json_lib::json_integer>(
+            static_cast<int>(value)
+        );
+    }
+
+    static std::shared_ptr<json_lib::json>
+    unsigned_integer(const uint64_t value) {
+        if (value > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+            throw std::out_of_range("MessagePack integer out of range");
+        }
+        return std::make_shared<json_lib::json_integer>(
+            static_cast<int>(value)
+        );
+    }
+
+    std::string text(const uint64_t length) {
+        need(length);
+        std::string result(bytes.substr(pos, length));
+        pos += length;
+        return result;
+    }
+
+    std::shared_ptr<json_lib::json> string(const uint64_t length) {
+        return std::make_shared<json_lib::json_string>(text(length));
+    }
+
+    void descend() {
+        ++depth;
+        if (const auto* limits = governor_lib::active_limits.load()) {
+            governor_lib::check("max_depth", depth, limits->max_depth);
+        }
+    }
+
+    std::shared_ptr<json_lib::json> array(const uint64_t count) {
+        // Every element takes at least one byte, which bounds the
+        // reservation for corrupt counts.
+        need(count);
+        descend();
+        std::vector<std::shared_ptr<json_lib::json>> items;
+        items.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            items.emplace_back(value());
+        }
+        --depth;
+        return std::make_shared<json_lib::json_array>(items);
+    }
+
+    std::shared_ptr<json_lib::json> map(const uint64_t count) {
+        need(count);
+        descend();
+        std::vector<std::pair<std::string, std::shared_ptr<json_lib::json>>>
+            items;
+        items.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string name = key();
+            items.emplace_back(std::move(name), value());
+        }
+        --depth;
+        return std::make_shared<json_lib::json_object>(items);
+    }
+
+    std::string key() {
+        const uint8_t head = byte();
+        if ((head & 0xE0) == 0xA0) {
+            return text(head & 0x1Fu);
+        }
+        if (head >= 0xD9 && head <= 0xDB) {
+            return text(number(size_t { 1 } << (head - 0xD9)));
+        }
+        throw std::runtime_error("MessagePack map key is not a string");
+    }
+};
+
+class encoder {
+public:
+    std::string out;
+
+    void put(const json_lib::json& value) {
+        switch (value.type()) {
+        case json_lib::json_type::null_json:
+            out += '\xC0';
+            break;
+        case json_lib::json_type::boolean_json:
+            out += dynamic_cast<const json_lib::json_boolean&>(value).as_bool()
+                ? '\xC3'
+                : '\xC2';
+            break;
+        case json_lib::json_type::integer_json:
+            put_integer(
+                dynamic_cast<const json_lib::json_integer&>(value).as_index()
+            );
+            break;
+        case json_lib::json_type::real_json: {
+            const double real = std::strtod(value.to_string().c_str(), nullptr);
+            uint64_t bits = 0;
+            std::memcpy(&bits, &real, sizeof(bits));
+            put_head(0xCB, bits, 8);
+            break;
+        }
+        case json_lib::json_type::string_json:
+            put_string(
+                dynamic_cast<const json_lib::json_string&>(value).as_key()
+            );
+            break;
+        case json_lib::json_type::array_json: {
+            const auto& items
+                = dynamic_cast<const json_lib::json_array&>(value).items();
+            put_length(0x90, 0xDC, items.size());
+            for (const auto& item : items) {
+                put(*item);
+            }
+            break;
+        }
+        case json_lib::json_type::object_json: {
+            const auto& items
+                = dynamic_cast<const json_lib::json_object&>(value).items();
+            put_length(0x80, 0xDE, items.size());
+            for (const auto& [key, item] : items) {
+                put_string(key);
+                put(*item);
+            }
+            break;
+        }
+        default:
+            throw std::invalid_argument(
+                "cannot encode a "
+                + json_lib::json_type_to_string(value.type())
+                + " as MessagePack"
+            );
+        }
+    }
+
+private:
+    /**
+     * A head byte followed by `width` big-endian bytes of `value`.
+     */
+    void put_head(const uint8_t head, const uint64_t value, const int width) {
+        out += static_cast<char>(head);
+        for (int shift = 8 * (width - 1); shift >= 0; shift -= 8) {
+            out += static_cast<char>((value >> shift) & 0xFF);
+        }
+    }
+
+    void put_integer(const int value) {
+        if (value >= 0) {
+            const auto magnitude = static_cast<uint64_t>(value);
+            if (magnitude <= 0x7F) {
+                out += static_cast<char>(magnitude);
+            } else if (magnitude <= 0xFF) {
+                put_head(0xCC, magnitude, 1);
+            } else if (magnitude <= 0xFFFF) {
+                put_head(0xCD, magnitude, 2);
+            } else {
+                put_head(0xCE, magnitude, 4);
+            }
+            return;
+        }
+        const auto bits = static_cast<uint64_t>(static_cast<int64_t>(value));
+        if (value >= -32) {
+            out += static_cast<char>(bits & 0xFF);
+        } else if (value >= std::numeric_limits<int8_t>::min()) {
+            put_head(0xD0, bits, 1);
+        } else if (value >= std::numeric_limits<int16_t>::min()) {
+            put_head(0xD1, bits, 2);
+        } else {
+            put_head(0xD2, bits, 4);
+        }
+    }
+
+    /**
+     * Length of a string (`fix` = 0xA0) or count of a container, in the
+     * short form, or the 16- or 32-bit form starting at `wide`.
+     */
+    void put_length(const uint8_t fix, const uint8_t wide, const size_t size) {
+        const size_t fix_limit = fix == 0xA0 ? 31 : 15;
+        if (size <= fix_limit) {
+            out += static_cast<char>(fix | size);
+        } else if (size <= 0xFFFF) {
+            put_head(wide, size, 2);
+        } else if (size <= 0xFFFFFFFF) {
+            put_head(static_cast<uint8_t>(wide + 1), size, 4);
+        } else {
+            throw std::invalid_argument("value too large for MessagePack");
+        }
+    }
+
+    void put_string(const std::string& text) {
+        if (text.size() > 31 && text.size() <= 0xFF) {
+            put_head(0xD9, text.size(), 1);
+        } else {
+            put_length(0xA0, 0xDA, text.size());
+        }
+        out += text;
+    }
+};
+}
+
+std::shared_ptr<json_lib::json>
+msgpack_lib::decode(const std::string_view bytes) {
+    const alloc_lib::phase_scope scope(alloc_lib::phase::parse);
+    const trace_lib::span span("parse");
+    const metrics_lib::timer timer(&metrics_lib::registry::parse);
+    const auto* limits = governor_lib::active_limits.load();
+    if (limits != nullptr) {
+        governor_lib::check(
+            "max_input_bytes", bytes.size(), limits->max_input_bytes
+        );
+    }
+    decoder input(bytes);
+    auto result = input.value();
+    if (!input.done()) {
+        throw std::runtime_error("trailing data after MessagePack document");
+    }
+    if (limits != nullptr && limits->max_memory != 0) {
+        governor_lib::check(
+            "max_memory", result->memory_usage(), limits->max_memory
+        );
+    }
+    if (metrics_lib::active_registry != nullptr) {
+        metrics_lib::active_registry->documents_loaded.add();
+        metrics_lib::active_registry->bytes_parsed.add(bytes.size());
+    }
+    return result;
+}
+
+std::string msgpack_lib::encode(const json_lib::json& value) {
+    encoder output;
+    output.put(value);
+    return std::move(output.out);
+}
+
+bool msgpack_lib::has_extension(const std::filesystem::path& path) {
+    const auto extension = path.extension();
+    return extension == ".msgpack" || extension == ".mpk";
+}
@@ -0,0 +1,428 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "parallel.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+#include "transport.hpp"
+
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+bool is_space(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+size_t skip_space(const std::string_view text, size_t pos) {
+    while (pos < text.size() && is_space(text[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+/**
+ * Scan the value starting at `pos` and return the offset just past it. For
+ * a top-level array, the offsets of its separating commas are passed to
+ * `on_comma`.
+ */
+template <typename OnComma>
+size_t scan_value(const std::string_view text, size_t pos, OnComma on_comma) {
+    const char first = text[pos];
+    if (first != '[' && first != '{' && first != '\"') {
+        while (pos < text.size() && !is_space(text[pos]) && text[pos] != ','
+               && text[pos] != ']' && text[pos] != '}') {
+            ++pos;
+        }
+        return pos;
+    }
+    size_t depth = 0;
+    bool in_string = false;
+    for (; pos < text.size(); ++pos) {
+        const char c = text[pos];
+        if (in_string) {
+            if (c == '\\') {
+                ++pos;
+            } else if (c == '\"') {
+                in_string = false;
+                if (depth == 0) {
+                    return pos + 1;
+                }
+            }
+        } else if (c == '\"') {
+            in_string = true;
+        } else if (c == '[' || c == '{') {
+            ++depth;
+        } else if (c == ']' || c == '}') {
+            if (--depth == 0) {
+                return pos + 1;
+            }
+        } else if (c == ',' && depth == 1 && first == '[') {
+            on_comma(pos);
+        }
+    }
+    throw std::runtime_error("unterminated json value");
+}
+
+std::string evaluate_record(std::string record, const std::string& expression) {
+    std::shared_ptr<json_lib::json> document;
+    parser_lib::parser(record).completely_parse_json(document);
+    std::string text = expression;
+    std::shared_ptr<json_lib::json> compiled;
+    parser_lib::parser(text).completely_parse_json(compiled, true);
+    return reference_lib::evaluate(compiled, document)->to_string();
+}
+}
+
+parallel_lib::partition
+parallel_lib::split(const std::string_view text, size_t parts) {
+    parts = std::max<size_t>(parts, 1);
+    partition result;
+    const size_t begin = skip_space(text, 0);
+    if (begin == text.size()) {
+        return result;
+    }
+
+    const bool is_array = text[begin] == '[';
+    std::vector<size_t> commas;
+    size_t next_target = text.size() / parts;
+    const size_t end = scan_value(text, begin, [&](const size_t comma) {
+        if (is_array && comma >= next_target) {
+            commas.emplace_back(comma);
+            next_target = comma + text.size() / parts;
+        }
+    });
+
+    if (skip_space(text, end) != text.size()) {
+        result.layout = input_layout::lines;
+        size_t start = 0;
+        for (size_t i = 1; i <= parts && start < text.size(); ++i) {
+            size_t stop = i == parts ? text.size() : text.size() * i / parts;
+            if (stop < start) {
+                continue;
+            }
+            stop = std::min(text.find('\n', stop), text.size());
+            if (stop < text.size()) {
+                ++stop;
+            }
+            result.ranges.emplace_back(start, stop);
+            start = stop;
+        }
+        return result;
+    }
+
+    if (!is_array) {
+        result.ranges.emplace_back(begin, end);
+        return result;
+    }
+    result.layout = input_layout::array;
+    size_t start = begin + 1;
+    for (const size_t comma : commas) {
+        result.ranges.emplace_back(start, comma);
+        start = comma + 1;
+    }
+    result.ranges.emplace_back(start, end - 1);
+    return result;
+}
+
+std::string parallel_lib::evaluate_range(
+    const std::string_view text, const input_layout layout,
+    const std::pair<size_t, size_t> range, const std::string& expression
+) {
+    std::string output;
+    evaluate_range(
+        text, layout, range, expression,
+        [&output](const std::string_view result) { output += result; }
+    );
+    return output;
+}
+
+void parallel_lib::evaluate_range(
+    const std::string_view text, const input_layout layout,
+    const std::pair<size_t, size_t> range, const std::string& expression,
+    const std::function<void(std::string_view)>& emit
+) {
+    const auto slice = text.substr(range.first, range.second - range.first);
+    switch (layout) {
+    case input_layout::single: {
+        emit(evaluate_record(std::string(slice), expression) + '\n');
+        break;
+    }
+    case input_layout::lines: {
+        for (size_t start = 0; start < slice.size();) {
+            const size_t stop = std::min(slice.find('\n', start), slice.size());
+            const auto line = slice.substr(start, stop - start);
+            if (skip_space(line, 0) != line.size()) {
+                emit(evaluate_record(std::string(line), expression) + '\n');
+            }
+            start = stop + 1;
+        }
+        break;
+    }
+    case input_layout::array: {
+        if (skip_space(slice, 0) == slice.size()) {
+            break;
+        }
+        std::shared_ptr<json_lib::json> elements;
+        std::string buffer = '[' + std::string(slice) + ']';
+        parser_lib::parser(buffer).completely_parse_json(elements);
+        for (const auto& element :
+             std::dynamic_pointer_cast<json_lib::json_array>(elements)
+                 ->items()) {
+            std::string text = expression;
+            std::shared_ptr<json_lib::json> compiled;
+            parser_lib::parser(text).completely_parse_json(compiled, true);
+            emit(
+                reference_lib::evaluate(compiled, element)->to_string() + '\n'
+            );
+        }
+        break;
+    }
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+namespace {
+[[noreturn]] void throw_system_error(const std::string& action) {
+    throw std::runtime_error(action + ": " + std::strerror(errno));
+}
+
+bool write_all(const int fd, const std::string_view data) {
+    for (size_t sent = 0; sent < data.size();) {
+        const auto written = write(fd, data.data() + sent, data.size() - sent);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+[[noreturn]] void run_worker(
+    const int fd, const std::string_view text,
+    const parallel_lib::partition& partition, const size_t index,
+    const std::string& expression
+) {
+    int status = 0;
+    try {
+        parallel_lib::evaluate_range(
+            text, partition.layout, partition.ranges[index], expression,
+            [fd](const std::string_view result) {
+                if (!write_all(fd, result)) {
+                    throw std::runtime_error("failed to write results");
+                }
+            }
+        );
+    } catch (const std::exception& e) {
+        const std::string message
+            = "worker " + std::to_string(index) + ": " + e.what() + '\n';
+        write_all(STDERR_FILENO, message);
+        status = 1;
+    }
+    close(fd);
+    _exit(status);
+}
+
+/**
+ * Forked workers and the read ends of their pipes. Unless all workers were
+ * reaped, unwinding closes the pipes still open and kills and reaps the
+ * workers, so a failure part-way through leaks neither.
+ */
+class worker_set {
+public:
+    worker_set() = default;
+    worker_set(const worker_set&) = delete;
+    worker_set& operator=(const worker_set&) = delete;
+
+    ~worker_set() {
+        for (const int fd : pipes) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        for (const pid_t child : children) {
+            kill(child, SIGKILL);
+            while (waitpid(child, nullptr, 0) < 0 && errno == EINTR) { }
+        }
+    }
+
+    void add(const pid_t child, const int pipe) {
+        children.emplace_back(child);
+        pipes.emplace_back(pipe);
+    }
+
+    [[nodiscard]] size_t size() const { return pipes.size(); }
+    [[nodiscard]] int pipe(const size_t index) const { return pipes[index]; }
+
+    void close_pipe(const size_t index) {
+        close(pipes[index]);
+        pipes[index] = -1;
+    }
+
+    /**
+     * Wait for all workers; `1` if any of them failed, `0` otherwise.
+     */
+    int reap() {
+        int result = 0;
+        for (const pid_t child : children) {
+            int status = 0;
+            while (waitpid(child, &status, 0) < 0 && errno == EINTR) { }
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                result = 1;
+            }
+        }
+        children.clear();
+        return result;
+    }
+
+private:
+    std::vector<pid_t> children;
+    std::vector<int> pipes;
+};
+}
+
+int parallel_lib::run(
+    const std::filesystem::path& input, const std::string& expression,
+    const size_t workers, std::ostream& out
+) {
+    const int file = open(input.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        throw std::invalid_argument(
+            "failed to open file with path: " + input.string()
+        );
+    }
+    std::unique_ptr<transport_lib::mapped_segment> mapping;
+    try {
+        mapping = std::make_unique<transport_lib::mapped_segment>(file);
+    } catch (...) {
+        close(file);
+        throw;
+    }
+    close(file);
+    const std::string_view text = mapping->view();
+    const partition parts = split(text, workers);
+    if (parts.ranges.empty()) {
+        throw std::runtime_error("json is empty");
+    }
+
+    out.flush();
+    std::cerr.flush();
+    worker_set spawned;
+    for (size_t i = 0; i < parts.ranges.size(); ++i) {
+        int ends[2];
+        if (pipe(ends) != 0) {
+            throw_system_error("failed to create pipe");
+        }
+        const pid_t child = fork();
+        if (child < 0) {
+            const int error = errno;
+            close(ends[0]);
+            close(ends[1]);
+            errno = error;
+            throw_system_error("failed to fork");
+        }
+        if (child == 0) {
+            close(ends[0]);
+            for (size_t j = 0; j < spawned.size(); ++j) {
+                close(spawned.pipe(j));
+            }
+            run_worker(ends[1], text, parts, i, expression);
+        }
+        close(ends[1]);
+        spawned.add(child, ends[0]);
+    }
+
+    // Stream the first unfinished worker, buffer the ones after it.
+    std::vector<std::string> pending(spawned.size());
+    std::vector<bool> finished(spawned.size(), false);
+    size_t current = 0;
+    std::array<char, 1 << 16> chunk {};
+    while (current < spawned.size()) {
+        std::vector<pollfd> polled;
+        std::vector<size_t> owners;
+        for (size_t i = current; i < spawned.size(); ++i) {
+            if (!finished[i]) {
+                polled.push_back({ spawned.pipe(i), POLLIN, 0 });
+                owners.emplace_back(i);
+            }
+        }
+        if (poll(polled.data(), polled.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_system_error("failed to poll workers");
+        }
+        for (size_t j = 0; j < polled.size(); ++j) {
+            if (polled[j].revents == 0) {
+                continue;
+            }
+            const size_t i = owners[j];
+            const auto count
+                = read(spawned.pipe(i), chunk.data(), chunk.size());
+            if (count > 0) {
+                const std::string_view data(
+                    chunk.data(), static_cast<size_t>(count)
+                );
+                if (i == current) {
+                    out << data;
+                } else {
+                    pending[i] += data;
+                }
+            } else if (count == 0 || errno != EINTR) {
+                finished[i] = true;
+                spawned.close_pipe(i);
+            }
+        }
+        while (current < spawned.size() && finished[current]) {
+            if (++current < spawned.size()) {
+                out << pending[current];
+                pending[current].clear();
+            }
+        }
+    }
+    out.flush();
+    return spawned.reap();
+}
+#else
+int parallel_lib::run(
+    const std::filesystem::path&, const std::string&, size_t, std::ostream&
+) {
+    throw std::runtime_error("parallel evaluation requires fork()");
+}
+#endif
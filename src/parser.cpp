@@ -23,6 +23,10 @@
  */
 
 #include "parser.hpp"
+#include "alloc.hpp"
+#include "governor.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
 
 #include <cassert>
 #include <ranges>
@@ -56,12 +60,14 @@ std::runtime_error parser_lib::parser::throw_message(
 parser_lib::parser::parser(std::string& buffer)
     : buffer(std::move(buffer))
     , pos(0)
-    , line(0) { }
+    , line(0)
+    , bytes_read(this->buffer.size()) { }
 
 parser_lib::parser::parser(const std::stringstream& ss)
     : buffer(ss.str())
     , pos(0)
-    , line(0) { }
+    , line(0)
+    , bytes_read(buffer.size()) { }
 
 parser_lib::parser::parser(std::ifstream& is)
     : ifs(move(is)) {
@@ -78,9 +84,64 @@ parser_lib::parser::parser(const std::filesystem::path& path) {
     read_line();
 }
 
+std::string parser_lib::read_file(const std::filesystem::path& path) {
+    std::string buffer;
+    read_file(path, buffer);
+    return buffer;
+}
+
+void parser_lib::read_file(
+    const std::filesystem::path& path, std::string& buffer
+) {
+    const alloc_lib::phase_scope scope(alloc_lib::phase::read);
+    const trace_lib::span span("read", "io");
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        throw std::invalid_argument(
+            "failed to open file with path: " + path.string()
+        );
+    }
+    ifs.seekg(0, std::ios::end);
+    if (const std::streamoff size = ifs.tellg(); size >= 0) {
+        if (const auto* limits = governor_lib::active_limits.load()) {
+            governor_lib::check(
+                "max_input_bytes", static_cast<size_t>(size),
+                limits->max_input_bytes
+            );
+        }
+        buffer.resize(static_cast<size_t>(size));
+        ifs.seekg(0, std::ios::beg);
+        ifs.read(buffer.data(), static_cast<std::streamsize>(size));
+    } else {
+        ifs.clear();
+        std::ostringstream oss;
+        oss << ifs.rdbuf();
+        buffer = oss.str();
+        if (const auto* limits = governor_lib::active_limits.load()) {
+            governor_lib::check(
+                "max_input_bytes", buffer.size(), limits->max_input_bytes
+            );
+        }
+    }
+}
+
 void parser_lib::parser::completely_parse_json(
     std::shared_ptr<json_lib::json>& result, const bool dynamic
 ) {
+    const alloc_lib::phase_scope scope(
+        dynamic ? alloc_lib::phase::compile : alloc_lib::phase::parse
+    );
+    const trace_lib::span span(dynamic ? "compile" : "parse");
+    const metrics_lib::timer timer(
+        dynamic ? &metrics_lib::registry::compile
+                : &metrics_lib::registry::parse
+    );
+    const auto* limits = governor_lib::active_limits.load();
+    if (limits != nullptr) {
+        governor_lib::check(
+            "max_input_bytes", bytes_read, limits->max_input_bytes
+        );
+    }
     parse_json(result, dynamic);
     nonessential();
     if (result == nullptr) {
@@ -89,6 +150,20 @@ void parser_lib::parser::completely_parse_json(
     if (valid()) {
         throw throw_message("invalid json");
     }
+    if (limits != nullptr && limits->max_memory != 0 && !dynamic) {
+        governor_lib::check(
+            "max_memory", result->memory_usage(), limits->max_memory
+        );
+    }
+    if (metrics_lib::active_registry != nullptr && !dynamic) {
+        metrics_lib::active_registry->documents_loaded.add();
+        metrics_lib::active_registry->bytes_parsed.add(bytes_read);
+    }
+}
+
+std::string parser_lib::parser::release_buffer() {
+    pos = -1;
+    return std::move(buffer);
 }
 
 size_t parser_lib::parser::get_pos() const {
@@ -120,7 +195,37 @@ void parser_lib::parser::read_line() {
     }
     std::getline(ifs, buffer);
     buffer += '\n';
+    bytes_read += buffer.size();
     pos = 0;
+    if (const auto* limits = governor_lib::active_limits.load()) {
+        governor_lib::check(
+            "max_input_bytes", bytes_read, limits->max_input_bytes
+        );
+    }
+}
+
+void parser_lib::parser::descend() {
+    ++depth;
+    if (const auto* limits = governor_lib::active_limits.load()) {
+        governor_lib::check("max_depth", depth, limits->max_depth);
+    }
+}
+
+void parser_lib::parser::count_value(const bool dynamic) {
+    ++nodes;
+    governor_lib::poll();
+    const auto* limits = governor_lib::active_limits.load();
+    if (limits == nullptr) {
+        return;
+    }
+    governor_lib::check("max_nodes", nodes, limits->max_nodes);
+    if (!dynamic) {
+        // Every value takes at least a bare node; the exact usage is checked
+        // once the document is complete.
+        governor_lib::check(
+            "max_memory", nodes * sizeof(json_lib::json), limits->max_memory
+        );
+    }
 }
 
 char parser_lib::parser::peek() const { return buffer[get_pos()]; }
@@ -297,12 +402,26 @@ std::tuple<std::string, bool> parser_lib::parser::parse_number() {
     return { number, is_float };
 }
 
+bool parser_lib::parser::traced_element(const bool dynamic) const {
+    return trace_lib::active_recorder != nullptr && !dynamic && depth == 1
+        && trace_lib::active_recorder->elements();
+}
+
 void parser_lib::parser::parse_array_item(
     std::vector<std::shared_ptr<json_lib::json>>& children, const bool dynamic
 ) {
+    const bool traced = traced_element(dynamic);
+    const auto start = traced ? trace_lib::clock::now()
+                              : trace_lib::clock::time_point {};
     std::shared_ptr<json_lib::json> child;
     parse_json(child, dynamic);
     children.emplace_back(child);
+    if (traced) {
+        trace_lib::active_recorder->complete(
+            "element", '[' + std::to_string(children.size() - 1) + ']', start,
+            trace_lib::clock::now()
+        );
+    }
 }
 
 void parser_lib::parser::parse_set_item(
@@ -330,8 +449,16 @@ void parser_lib::parser::parse_object_item(
     if (!separator(':')) {
         throw throw_message("expected key-value separator for json object");
     }
+    const bool traced = traced_element(dynamic);
+    const auto start = traced ? trace_lib::clock::now()
+                              : trace_lib::clock::time_point {};
     std::shared_ptr<json_lib::json> value;
     parse_json(value, dynamic);
+    if (traced) {
+        trace_lib::active_recorder->complete(
+            "element", key, start, trace_lib::clock::now()
+        );
+    }
     children.emplace_back(key, value);
 }
 
@@ -364,10 +491,24 @@ bool parser_lib::parser::parse_accessor(
         }
     } else if (peek() == '[') {
         next();
+        nonessential();
+        if (valid() && peek() == '*') {
+            next();
+            if (!separator(']')) {
+                throw throw_message("expected `]` after `[*`");
+            }
+            const auto projection
+                = std::make_shared<reference_lib::json_projection>();
+            parse_tail(projection);
+            accessor = projection;
+            return true;
+        }
+        descend();
         auto keys
             = parse_collection<std::vector<std::shared_ptr<json_lib::json>>>(
                 true, ']', &parser::parse_array_item
             );
+        --depth;
         if (keys.size() == 1) {
             accessor = keys[0];
         } else {
@@ -386,10 +527,12 @@ bool parser_lib::parser::parse_accessor(
         }
     } else if (peek() == '{') {
         next();
+        descend();
         auto accessors = parse_collection<
             std::vector<std::shared_ptr<reference_lib::json_reference>>>(
             true, '}', &parser::parse_set_item
         );
+        --depth;
         accessor = std::make_shared<reference_lib::json_set>(accessors);
     } else {
         return false;
@@ -426,6 +569,7 @@ void parser_lib::parser::parse_json(
     if (!valid()) {
         return;
     }
+    count_value(dynamic);
     if (dynamic && peek() == '@') {
         result = std::make_shared<reference_lib::json_reference>(
             reference_lib::ref_head_type::local
@@ -478,20 +622,24 @@ void parser_lib::parser::parse_json(
         result = std::make_shared<json_lib::json_string>(parse_string());
     } else if (peek() == '[') {
         next();
+        descend();
         auto children
             = parse_collection<std::vector<std::shared_ptr<json_lib::json>>>(
                 dynamic, ']', &parser::parse_array_item
             );
+        --depth;
         result = std::make_shared<json_lib::json_array>(children);
         if (dynamic) {
             result->touch();
         }
     } else if (peek() == '{') {
         next();
+        descend();
         auto children = parse_collection<std::vector<
             std::pair<std::string, std::shared_ptr<json_lib::json>>>>(
             dynamic, '}', &parser::parse_object_item
         );
+        --depth;
         result = std::make_shared<json_lib::json_object>(children);
         if (dynamic) {
             result->touch();
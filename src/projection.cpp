@@ -0,0 +1,115 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "projection.hpp"
+#include "metrics.hpp"
+
+#include <cstdint>
+
+projection_lib::cache::cache(const size_t memory_limit)
+    : limit(memory_limit) { }
+
+std::string projection_lib::cache::key_of(
+    const json_lib::json* source, const std::string& path
+) {
+    return std::to_string(reinterpret_cast<std::uintptr_t>(source)) + ':'
+        + path;
+}
+
+void projection_lib::cache::drop(const std::list<entry>::iterator position) {
+    used -= position->memory;
+    index.erase(position->key);
+    recent.erase(position);
+}
+
+std::shared_ptr<const projection_lib::column> projection_lib::cache::find(
+    const std::shared_ptr<json_lib::json>& source, const std::string& path
+) {
+    const std::lock_guard lock(mutex);
+    const auto found = index.find(key_of(source.get(), path));
+    if (found == index.end()) {
+        return nullptr;
+    }
+    // The address may belong to a new array if the original one was
+    // released; the expired weak reference tells the two apart.
+    if (found->second->source.lock() != source) {
+        drop(found->second);
+        return nullptr;
+    }
+    recent.splice(recent.begin(), recent, found->second);
+    ++counters.hits;
+    if (metrics_lib::active_registry != nullptr) {
+        metrics_lib::active_registry->cache_hits.add();
+    }
+    return found->second->gathered;
+}
+
+void projection_lib::cache::insert(
+    const std::shared_ptr<json_lib::json>& source, const std::string& path,
+    std::shared_ptr<const column> gathered
+) {
+    const size_t memory = gathered->values->memory_usage()
+        + gathered->positions.capacity() * sizeof(size_t);
+    std::string key = key_of(source.get(), path);
+
+    const std::lock_guard lock(mutex);
+    ++counters.builds;
+    if (const auto found = index.find(key); found != index.end()) {
+        drop(found->second);
+    }
+    if (memory > limit) {
+        return;
+    }
+    recent.emplace_front(key, source, std::move(gathered), memory);
+    index.emplace(std::move(key), recent.begin());
+    used += memory;
+    while (used > limit) {
+        drop(std::prev(recent.end()));
+        ++counters.evictions;
+    }
+}
+
+void projection_lib::cache::clear() {
+    const std::lock_guard lock(mutex);
+    index.clear();
+    recent.clear();
+    used = 0;
+}
+
+size_t projection_lib::cache::size() const {
+    const std::lock_guard lock(mutex);
+    return index.size();
+}
+
+size_t projection_lib::cache::memory_usage() const {
+    const std::lock_guard lock(mutex);
+    return used;
+}
+
+size_t projection_lib::cache::memory_limit() const { return limit; }
+
+projection_lib::cache_stats projection_lib::cache::stats() const {
+    const std::lock_guard lock(mutex);
+    return counters;
+}
@@ -23,9 +23,120 @@
  */
 
 #include "reference.hpp"
+#include "alloc.hpp"
+#include "governor.hpp"
+#include "metrics.hpp"
+#include "projection.hpp"
+#include "trace.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <ranges>
 
+namespace {
+bool instrumented() {
+    return reference_lib::active_profile != nullptr
+        || trace_lib::active_recorder != nullptr;
+}
+
+template <typename Label>
+void report_step(
+    const json_lib::json* step, Label label, const size_t visited,
+    const size_t produced, const std::chrono::steady_clock::time_point start
+) {
+    const auto end = std::chrono::steady_clock::now();
+    if (reference_lib::active_profile != nullptr) {
+        reference_lib::active_profile->record(
+            step, visited, produced, end - start
+        );
+    }
+    if (trace_lib::active_recorder != nullptr) {
+        trace_lib::active_recorder->complete("step", label(), start, end);
+    }
+}
+
+projection_lib::column collect(
+    const json_lib::json_array& source,
+    const std::deque<std::shared_ptr<json_lib::json>>& path
+);
+
+std::shared_ptr<json_lib::json> follow(
+    std::shared_ptr<json_lib::json> value,
+    const std::deque<std::shared_ptr<json_lib::json>>& path
+) {
+    for (const auto& accessor : path) {
+        if (accessor->type() == json_lib::json_type::reference_json) {
+            // Only nested projections are accepted after `[*]`, and they
+            // consume the rest of the path.
+            if (value->type() != json_lib::json_type::array_json) {
+                return nullptr;
+            }
+            const auto nested
+                = std::dynamic_pointer_cast<reference_lib::json_reference>(
+                    accessor
+                );
+            return collect(
+                       dynamic_cast<const json_lib::json_array&>(*value),
+                       nested->get_tail()
+            )
+                .values;
+        }
+        const bool fits = accessor->type() == json_lib::json_type::string_json
+            ? value->type() == json_lib::json_type::object_json
+            : value->type() == json_lib::json_type::array_json;
+        if (!fits) {
+            return nullptr;
+        }
+        try {
+            value = value->by(accessor);
+        } catch (const std::out_of_range&) {
+            return nullptr;
+        }
+    }
+    return value;
+}
+
+projection_lib::column collect(
+    const json_lib::json_array& source,
+    const std::deque<std::shared_ptr<json_lib::json>>& path
+) {
+    projection_lib::column result;
+    std::vector<std::shared_ptr<json_lib::json>> values;
+    const auto& items = source.items();
+    values.reserve(items.size());
+    result.positions.reserve(items.size());
+    governor_lib::query_budget::charge(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        governor_lib::poll();
+        if (auto value = follow(items[i], path)) {
+            values.emplace_back(std::move(value));
+            result.positions.emplace_back(i);
+        }
+    }
+    result.values = std::make_shared<json_lib::json_array>(values);
+    return result;
+}
+}
+
+void reference_lib::evaluation_profile::record(
+    const json_lib::json* step, const size_t visited, const size_t produced,
+    const std::chrono::nanoseconds time
+) {
+    auto& profile = steps[step];
+    ++profile.calls;
+    profile.visited += visited;
+    profile.produced += produced;
+    profile.time += time;
+}
+
+const reference_lib::step_profile*
+reference_lib::evaluation_profile::find(const json_lib::json* step) const {
+    if (const auto it = steps.find(step); it != steps.end()) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
 reference_lib::json_reference::json_reference(const ref_head_type type)
     : head_type(type) { }
 
@@ -41,6 +152,11 @@ reference_lib::json_set::json_set(
     set_head_type(ref_head_type::accessor);
 }
 
+reference_lib::json_projection::json_projection()
+    : json_reference(ref_head_type::accessor) {
+    _reference_type = json_reference_type::projection_json;
+}
+
 reference_lib::json_function::json_function(std::string name)
     : name(std::move(name)) {
     _reference_type = json_reference_type::function_json;
@@ -101,14 +217,21 @@ std::string reference_lib::json_function::indented_string(size_t, bool) const {
     return result;
 }
 
+std::string
+reference_lib::json_projection::indented_string(size_t, bool) const {
+    return "[*]" + tail_to_string();
+}
+
 std::string reference_lib::json_reference::tail_to_string() const {
     std::string result;
     for (const auto& accessor : tail) {
         std::string suffix = accessor->to_string();
         if (accessor->type() == json_lib::json_type::reference_json) {
-            if (std::dynamic_pointer_cast<json_reference>(accessor)
-                    ->reference_type()
-                == json_reference_type::set_json) {
+            if (const auto reference_type
+                = std::dynamic_pointer_cast<json_reference>(accessor)
+                      ->reference_type();
+                reference_type == json_reference_type::set_json
+                || reference_type == json_reference_type::projection_json) {
                 result += suffix;
                 continue;
             }
@@ -172,6 +295,44 @@ void reference_lib::json_reference::emplace_back(
     }
 }
 
+void reference_lib::json_projection::emplace_back(
+    const std::shared_ptr<json>& accessor
+) {
+    const bool constant = accessor->type() == json_lib::json_type::string_json
+        || accessor->type() == json_lib::json_type::integer_json;
+    if (!constant
+        && (accessor->type() != json_lib::json_type::reference_json
+            || std::dynamic_pointer_cast<json_reference>(accessor)
+                    ->reference_type()
+                != json_reference_type::projection_json)) {
+        throw std::invalid_argument(
+            "only keys, indices and `[*]` may follow `[*]`"
+        );
+    }
+    json_reference::emplace_back(accessor);
+}
+
+std::shared_ptr<json_lib::json>
+reference_lib::json_projection::gather(const std::shared_ptr<json>& source
+) const {
+    if (source->type() != json_lib::json_type::array_json) {
+        throw std::invalid_argument("`[*]` expects an array");
+    }
+    const auto& array = dynamic_cast<const json_lib::json_array&>(*source);
+    auto* const cache = projection_lib::active_cache;
+    if (cache == nullptr) {
+        return collect(array, get_tail()).values;
+    }
+    const std::string path = tail_to_string();
+    if (const auto cached = cache->find(source, path)) {
+        return cached->values;
+    }
+    const auto gathered
+        = std::make_shared<projection_lib::column>(collect(array, get_tail()));
+    cache->insert(source, path, gathered);
+    return gathered->values;
+}
+
 void reference_lib::json_set::emplace_back(const std::shared_ptr<json>& item) {
     for (const auto& element : elements) {
         element->emplace_back(item);
@@ -195,7 +356,54 @@ void reference_lib::json_function::set_args(
 }
 
 std::shared_ptr<json_lib::json> reference_lib::json_function::value() {
-    if (name == "size") {
+    if (!instrumented()) {
+        return compute();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    auto result = compute();
+    size_t visited = args.size();
+    if (args.size() == 1
+        && args[0]->type() == json_lib::json_type::array_json) {
+        visited = std::dynamic_pointer_cast<json_lib::json_array>(args[0])
+                      ->size();
+    }
+    report_step(
+        this, [this] { return name + "()"; }, visited,
+        result.get() == this ? 0 : 1, start
+    );
+    return result;
+}
+
+const std::string& reference_lib::json_function::get_name() const {
+    return name;
+}
+
+const std::vector<std::shared_ptr<json_lib::json>>&
+reference_lib::json_function::get_args() const {
+    return args;
+}
+
+std::shared_ptr<json_lib::json> reference_lib::json_function::compute() {
+    governor_lib::poll();
+    governor_lib::query_budget::charge();
+    if (name == "memsize") {
+        if (args.size() != 1) {
+            throw std::invalid_argument("`memsize()` expects one argument");
+        }
+        if (args[0]->type() == json_lib::json_type::reference_json) {
+            args[0]
+                = std::dynamic_pointer_cast<json_reference>(args[0])->value();
+        }
+        if (args[0]->type() == json_lib::json_type::reference_json) {
+            return shared_from_this();
+        }
+        const size_t usage = args[0]->memory_usage();
+        if (usage > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            throw std::out_of_range("`memsize()` exceeds the integer range");
+        }
+        return std::make_shared<json_lib::json_integer>(static_cast<int>(usage)
+        );
+    } else if (name == "size") {
         if (args.size() != 1) {
             return std::make_shared<json_lib::json_integer>(args.size());
         }
@@ -240,7 +448,9 @@ std::shared_ptr<json_lib::json> reference_lib::json_function::value() {
                         "trying to calculate `" + name + "()` of empty array"
                     );
                 }
+                governor_lib::query_budget::charge(arr->size());
                 for (int i = 0; i < sz; ++i) {
+                    governor_lib::poll();
                     auto item = arr->at(i);
                     if (item->type() == json_lib::json_type::reference_json) {
                         item = std::dynamic_pointer_cast<json_reference>(item)
@@ -342,7 +552,12 @@ reference_lib::json_reference::get_head_type() const {
 }
 
 void reference_lib::json_reference::simplify() {
+    const bool traced = instrumented();
+    const json* pending = nullptr;
+    std::chrono::steady_clock::time_point start;
     while (head_type == ref_head_type::object && length() > 0) {
+        governor_lib::poll();
+        governor_lib::query_budget::charge();
         auto accessor = tail.front();
         if (head->type() == json_lib::json_type::reference_json) {
             tail.pop_front();
@@ -351,6 +566,9 @@ void reference_lib::json_reference::simplify() {
             ref_head->emplace_back(accessor);
             head = ref_head->value();
         } else {
+            if (traced && pending == nullptr) {
+                start = std::chrono::steady_clock::now();
+            }
             if (accessor->type() == json_lib::json_type::reference_json) {
                 const auto ref_accessor
                     = std::dynamic_pointer_cast<json_reference>(accessor);
@@ -361,19 +579,52 @@ void reference_lib::json_reference::simplify() {
                     }
                     ref_accessor->set_parent(head);
                     tail.front() = ref_accessor->value();
+                    pending = ref_accessor.get();
                     break;
                 }
                 case json_reference_type::set_json: {
-                    std::dynamic_pointer_cast<json_set>(ref_accessor)
-                        ->set_parent(head);
+                    const auto set
+                        = std::dynamic_pointer_cast<json_set>(ref_accessor);
+                    set->set_parent(head);
                     head = ref_accessor->value();
                     tail.pop_front();
+                    if (traced) {
+                        report_step(
+                            set.get(), [] { return std::string("union"); }, 1,
+                            set->get_elements().size(), start
+                        );
+                    }
                     break;
                 }
                 case json_reference_type::function_json: {
                     // todo
                     return;
                 }
+                case json_reference_type::projection_json: {
+                    const auto projection
+                        = std::dynamic_pointer_cast<json_projection>(
+                            ref_accessor
+                        );
+                    const auto source = head;
+                    head = projection->gather(source);
+                    tail.pop_front();
+                    if (traced) {
+                        report_step(
+                            projection.get(),
+                            [] { return std::string("[*]"); },
+                            std::dynamic_pointer_cast<json_lib::json_array>(
+                                source
+                            )
+                                ->size(),
+                            std::dynamic_pointer_cast<json_lib::json_array>(
+                                head
+                            )
+                                ->size(),
+                            start
+                        );
+                    }
+                    break;
+                }
                 default: {
                     throw std::runtime_error("unsupported accessor type");
                 }
@@ -381,11 +632,179 @@ void reference_lib::json_reference::simplify() {
             } else {
                 head = head->by(accessor);
                 tail.pop_front();
+                if (traced) {
+                    report_step(
+                        pending != nullptr ? pending : accessor.get(),
+                        [&accessor] {
+                            return '[' + accessor->indented_string(0, false)
+                                + ']';
+                        },
+                        1, 1, start
+                    );
+                }
+                pending = nullptr;
             }
         }
     }
 }
 
+std::shared_ptr<json_lib::json> reference_lib::json_reference::get_head(
+) const {
+    return head;
+}
+
+const std::deque<std::shared_ptr<json_lib::json>>&
+reference_lib::json_reference::get_tail() const {
+    return tail;
+}
+
+const std::vector<std::shared_ptr<reference_lib::json_reference>>&
+reference_lib::json_set::get_elements() const {
+    return elements;
+}
+
+size_t reference_lib::json_reference::footprint(
+    std::unordered_set<const json*>& counted
+) const {
+    if (!counted.emplace(this).second) {
+        return 0;
+    }
+    size_t result = node_size(sizeof(json_reference))
+        + tail.size() * sizeof(std::shared_ptr<json>);
+    if (head != nullptr) {
+        result += head->footprint(counted);
+    }
+    for (const auto& accessor : tail) {
+        result += accessor->footprint(counted);
+    }
+    return result;
+}
+
+size_t
+reference_lib::json_set::footprint(std::unordered_set<const json*>& counted
+) const {
+    size_t result = json_reference::footprint(counted);
+    if (result == 0) {
+        return 0;
+    }
+    result += sizeof(json_set) - sizeof(json_reference)
+        + elements.capacity() * sizeof(std::shared_ptr<json_reference>);
+    for (const auto& element : elements) {
+        result += element->footprint(counted);
+    }
+    return result;
+}
+
+size_t reference_lib::json_function::footprint(
+    std::unordered_set<const json*>& counted
+) const {
+    size_t result = json_reference::footprint(counted);
+    if (result == 0) {
+        return 0;
+    }
+    result += sizeof(json_function) - sizeof(json_reference) + heap_size(name)
+        + args.capacity() * sizeof(std::shared_ptr<json>);
+    for (const auto& arg : args) {
+        result += arg->footprint(counted);
+    }
+    return result;
+}
+
 void reference_lib::json_reference::set_head_type(const ref_head_type type) {
     head_type = type;
 }
+
+std::shared_ptr<json_lib::json> reference_lib::evaluate(
+    const std::shared_ptr<json_lib::json>& expression,
+    const std::shared_ptr<json_lib::json>& root
+) {
+    const alloc_lib::phase_scope scope(alloc_lib::phase::evaluate);
+    const trace_lib::span span("evaluate");
+    const metrics_lib::timer timer(&metrics_lib::registry::evaluate);
+    const governor_lib::query_budget budget;
+    expression->set_root(root);
+    if (expression->type() == json_lib::json_type::reference_json) {
+        return std::dynamic_pointer_cast<json_reference>(expression)->value();
+    }
+    return expression;
+}
+
+bool reference_lib::is_constant_path(const json_reference& reference) {
+    if (reference.reference_type() != json_reference_type::reference_json
+        || reference.get_head_type() != ref_head_type::root) {
+        return false;
+    }
+    return std::ranges::all_of(reference.get_tail(), [](const auto& accessor) {
+        return accessor->type() == json_lib::json_type::string_json
+            || accessor->type() == json_lib::json_type::integer_json;
+    });
+}
+
+std::shared_ptr<json_lib::json> reference_lib::resolve_paths(
+    const std::shared_ptr<json_lib::json>& expression,
+    const std::function<std::shared_ptr<json_lib::json>(const json_reference&)>&
+        locate,
+    const std::function<std::shared_ptr<json_lib::json>(const json_function&)>&
+        shortcut
+) {
+    switch (expression->type()) {
+    case json_lib::json_type::reference_json:
+        break;
+    case json_lib::json_type::array_json: {
+        std::vector<std::shared_ptr<json_lib::json>> resolved;
+        for (const auto& item :
+             std::dynamic_pointer_cast<json_lib::json_array>(expression)
+                 ->items()) {
+            resolved.emplace_back(resolve_paths(item, locate, shortcut));
+            if (resolved.back() == nullptr) {
+                return nullptr;
+            }
+        }
+        return std::make_shared<json_lib::json_array>(resolved);
+    }
+    case json_lib::json_type::object_json: {
+        std::vector<std::pair<std::string, std::shared_ptr<json_lib::json>>>
+            resolved;
+        for (const auto& [key, item] :
+             std::dynamic_pointer_cast<json_lib::json_object>(expression)
+                 ->items()) {
+            resolved.emplace_back(key, resolve_paths(item, locate, shortcut));
+            if (resolved.back().second == nullptr) {
+                return nullptr;
+            }
+        }
+        return std::make_shared<json_lib::json_object>(resolved);
+    }
+    default:
+        return expression;
+    }
+
+    const auto reference
+        = std::dynamic_pointer_cast<json_reference>(expression);
+    switch (reference->reference_type()) {
+    case json_reference_type::reference_json:
+        return locate(*reference);
+    case json_reference_type::function_json: {
+        const auto function
+            = std::dynamic_pointer_cast<json_function>(expression);
+        if (shortcut) {
+            if (auto result = shortcut(*function)) {
+                return result;
+            }
+        }
+        std::vector<std::shared_ptr<json_lib::json>> args;
+        for (const auto& arg : function->get_args()) {
+            args.emplace_back(resolve_paths(arg, locate, shortcut));
+            if (args.back() == nullptr) {
+                return nullptr;
+            }
+        }
+        const auto result
+            = std::make_shared<json_function>(function->get_name());
+        result->set_args(args);
+        return result;
+    }
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,497 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "schema.hpp"
+#include "governor.hpp"
+#include "parser.hpp"
+#include "transport.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+constexpr std::array<std::string_view, schema_lib::type_count> type_names {
+    "null", "boolean", "integer", "real", "string", "array", "object"
+};
+
+size_t type_index(const json_lib::json_type type) {
+    return static_cast<size_t>(type);
+}
+
+bool is_space(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+std::string number_text(const double value) {
+    char buffer[32];
+    const auto [end, error] = std::to_chars(buffer, buffer + 32, value);
+    return { buffer, end };
+}
+
+/**
+ * Recursive scanner over the raw text that adds every value to the schema
+ * of its place instead of building it, so memory use follows the nesting
+ * and the schema, not the size of the text.
+ */
+class scanner {
+public:
+    explicit scanner(const std::string_view text)
+        : text(text) { }
+
+    void value(schema_lib::node& schema) {
+        pos = skip_space(pos);
+        if (pos >= text.size()) {
+            malformed();
+        }
+        ++schema.count;
+        switch (text[pos]) {
+        case '{':
+            ++schema.types[type_index(json_lib::json_type::object_json)];
+            object(schema);
+            break;
+        case '[':
+            ++schema.types[type_index(json_lib::json_type::array_json)];
+            array(schema);
+            break;
+        case '\"':
+            ++schema.types[type_index(json_lib::json_type::string_json)];
+            schema.lengths.add(string().size());
+            break;
+        case 't':
+            literal("true", json_lib::json_type::boolean_json, schema);
+            break;
+        case 'f':
+            literal("false", json_lib::json_type::boolean_json, schema);
+            break;
+        case 'n':
+            literal("null", json_lib::json_type::null_json, schema);
+            break;
+        default:
+            number(schema);
+        }
+    }
+
+    /**
+     * Advance past the separator after an item and report whether the
+     * container goes on.
+     */
+    bool separator(const char halt) {
+        pos = skip_space(pos);
+        if (pos < text.size() && text[pos] == ',') {
+            ++pos;
+            return true;
+        }
+        if (pos < text.size() && text[pos] == halt) {
+            ++pos;
+            return false;
+        }
+        malformed();
+    }
+
+    /**
+     * Advance past the comma after a record of a range of array elements
+     * and report whether another record follows.
+     */
+    bool next_record() {
+        if (at_end()) {
+            return false;
+        }
+        if (text[pos] != ',') {
+            malformed();
+        }
+        ++pos;
+        return true;
+    }
+
+    [[nodiscard]] bool at_end() {
+        pos = skip_space(pos);
+        return pos == text.size();
+    }
+
+    [[noreturn]] void malformed() const {
+        throw std::runtime_error(
+            "malformed json at offset " + std::to_string(pos)
+        );
+    }
+
+private:
+    std::string_view text;
+    size_t pos = 0;
+    size_t depth = 0;
+    std::string decoded;
+
+    size_t skip_space(size_t from) const {
+        while (from < text.size() && is_space(text[from])) {
+            ++from;
+        }
+        return from;
+    }
+
+    void descend() {
+        ++depth;
+        if (const auto* limits = governor_lib::active_limits.load()) {
+            governor_lib::check("max_depth", depth, limits->max_depth);
+        }
+    }
+
+    /**
+     * Contents of the string starting at `pos`, decoded only if it has
+     * escapes. The view is valid until the next call.
+     */
+    std::string_view string() {
+        if (pos >= text.size() || text[pos] != '\"') {
+            malformed();
+        }
+        const size_t begin = pos;
+        size_t end = begin + 1;
+        for (;;) {
+            const auto* found = static_cast<const char*>(
+                std::memchr(text.data() + end, '\"', text.size() - end)
+            );
+            if (found == nullptr) {
+                malformed();
+            }
+            end = static_cast<size_t>(found - text.data());
+            size_t escapes = 0;
+            while (text[end - escapes - 1] == '\\') {
+                ++escapes;
+            }
+            if (escapes % 2 == 0) {
+                break;
+            }
+            ++end;
+        }
+        pos = end + 1;
+        const std::string_view raw = text.substr(begin + 1, end - begin - 1);
+        if (raw.find('\\') == std::string_view::npos) {
+            return raw;
+        }
+        std::string quoted(text.substr(begin, pos - begin));
+        std::shared_ptr<json_lib::json> value;
+        parser_lib::parser(quoted).completely_parse_json(value);
+        decoded = std::dynamic_pointer_cast<json_lib::json_string>(value)
+                      ->as_key();
+        return decoded;
+    }
+
+    void literal(
+        const std::string_view word, const json_lib::json_type type,
+        schema_lib::node& schema
+    ) {
+        if (text.substr(pos, word.size()) != word) {
+            malformed();
+        }
+        pos += word.size();
+        ++schema.types[type_index(type)];
+    }
+
+    void number(schema_lib::node& schema) {
+        const size_t begin = pos;
+        bool real = false;
+        while (pos < text.size()
+               && (std::isdigit(static_cast<unsigned char>(text[pos]))
+                   || text[pos] == '-' || text[pos] == '+' || text[pos] == '.'
+                   || text[pos] == 'e' || text[pos] == 'E')) {
+            if (text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E') {
+                real = true;
+            }
+            ++pos;
+        }
+        double value = 0;
+        const auto [end, error]
+            = std::from_chars(text.data() + begin, text.data() + pos, value);
+        if (pos == begin || end != text.data() + pos
+            || (error != std::errc {} && error != std::errc::result_out_of_range
+            )) {
+            pos = begin;
+            malformed();
+        }
+        ++schema.types[type_index(
+            real ? json_lib::json_type::real_json
+                 : json_lib::json_type::integer_json
+        )];
+        if (error == std::errc {}) {
+            schema.numbers.add(value);
+        }
+    }
+
+    void array(schema_lib::node& schema) {
+        descend();
+        ++pos;
+        uint64_t size = 0;
+        pos = skip_space(pos);
+        if (pos < text.size() && text[pos] == ']') {
+            ++pos;
+        } else {
+            do {
+                value(schema.element());
+                ++size;
+            } while (separator(']'));
+        }
+        schema.sizes.add(size);
+        --depth;
+    }
+
+    void object(schema_lib::node& schema) {
+        descend();
+        ++pos;
+        pos = skip_space(pos);
+        if (pos < text.size() && text[pos] == '}') {
+            ++pos;
+        } else {
+            do {
+                pos = skip_space(pos);
+                auto& member = schema.property(string());
+                pos = skip_space(pos);
+                if (pos >= text.size() || text[pos] != ':') {
+                    malformed();
+                }
+                ++pos;
+                value(member);
+            } while (separator('}'));
+        }
+        --depth;
+    }
+};
+
+void put_bounds(
+    std::ostringstream& out, const std::string_view name,
+    const std::string& min, const std::string& max
+) {
+    out << ", \"" << name << "\": [" << min << ", " << max << ']';
+}
+}
+
+uint64_t schema_lib::node::of(const json_lib::json_type type) const {
+    const size_t index = type_index(type);
+    return index < type_count ? types[index] : 0;
+}
+
+schema_lib::node& schema_lib::node::property(const std::string_view key) {
+    if (const auto found = properties.find(key); found != properties.end()) {
+        return *found->second;
+    }
+    if (properties.size() < max_properties) {
+        return *properties.emplace(key, std::make_unique<node>())
+                    .first->second;
+    }
+    if (others == nullptr) {
+        others = std::make_unique<node>();
+    }
+    return *others;
+}
+
+schema_lib::node& schema_lib::node::element() {
+    if (elements == nullptr) {
+        elements = std::make_unique<node>();
+    }
+    return *elements;
+}
+
+void schema_lib::node::merge(const node& other) {
+    count += other.count;
+    for (size_t i = 0; i < type_count; ++i) {
+        types[i] += other.types[i];
+    }
+    numbers.merge(other.numbers);
+    lengths.merge(other.lengths);
+    sizes.merge(other.sizes);
+    if (other.elements != nullptr) {
+        element().merge(*other.elements);
+    }
+    for (const auto& [key, child] : other.properties) {
+        property(key).merge(*child);
+    }
+    if (other.others != nullptr) {
+        if (others == nullptr) {
+            others = std::make_unique<node>();
+        }
+        others->merge(*other.others);
+    }
+}
+
+std::string schema_lib::node::to_string() const {
+    std::ostringstream out;
+    out << "{\"count\": " << count << ", \"types\": {";
+    bool first = true;
+    for (size_t i = 0; i < type_count; ++i) {
+        if (types[i] > 0) {
+            out << (first ? "" : ", ") << '"' << type_names[i]
+                << "\": " << types[i];
+            first = false;
+        }
+    }
+    out << '}';
+    if (numbers.observed) {
+        put_bounds(
+            out, "range", number_text(numbers.min), number_text(numbers.max)
+        );
+    }
+    if (lengths.observed) {
+        put_bounds(
+            out, "length", std::to_string(lengths.min),
+            std::to_string(lengths.max)
+        );
+    }
+    if (sizes.observed) {
+        put_bounds(
+            out, "size", std::to_string(sizes.min), std::to_string(sizes.max)
+        );
+    }
+    if (elements != nullptr) {
+        out << ", \"elements\": " << elements->to_string();
+    }
+    const uint64_t objects = of(json_lib::json_type::object_json);
+    if (objects > 0) {
+        std::vector<std::string> optional;
+        out << ", \"properties\": {";
+        first = true;
+        for (const auto& [key, child] : properties) {
+            const std::string name = json_lib::json_string(key).to_string();
+            out << (first ? "" : ", ") << name << ": " << child->to_string();
+            if (child->count < objects) {
+                optional.emplace_back(name);
+            }
+            first = false;
+        }
+        out << "}, \"optional\": [";
+        for (size_t i = 0; i < optional.size(); ++i) {
+            out << (i == 0 ? "" : ", ") << optional[i];
+        }
+        out << ']';
+        if (others != nullptr) {
+            out << ", \"other\": " << others->to_string();
+        }
+    }
+    out << '}';
+    return out.str();
+}
+
+void schema_lib::observe(const std::string_view text, node& schema) {
+    scanner scan(text);
+    scan.value(schema);
+    if (!scan.at_end()) {
+        scan.malformed();
+    }
+}
+
+schema_lib::node schema_lib::infer_range(
+    const std::string_view text, const parallel_lib::input_layout layout,
+    const std::pair<size_t, size_t> range
+) {
+    const auto slice = text.substr(range.first, range.second - range.first);
+    node result;
+    switch (layout) {
+    case parallel_lib::input_layout::single:
+        observe(slice, result);
+        break;
+    case parallel_lib::input_layout::lines:
+        for (size_t start = 0; start < slice.size();) {
+            const size_t stop = std::min(slice.find('\n', start), slice.size());
+            const auto line = slice.substr(start, stop - start);
+            if (!std::ranges::all_of(line, is_space)) {
+                observe(line, result);
+            }
+            start = stop + 1;
+        }
+        break;
+    case parallel_lib::input_layout::array: {
+        scanner scan(slice);
+        if (scan.at_end()) {
+            break;
+        }
+        do {
+            scan.value(result);
+        } while (scan.next_record());
+        break;
+    }
+    }
+    return result;
+}
+
+schema_lib::node schema_lib::infer(
+    const std::vector<std::filesystem::path>& files, size_t threads
+) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    node result;
+    for (const auto& file : files) {
+        const transport_lib::mapped_segment mapping(file);
+        const std::string_view text = mapping.view();
+        const auto parts = parallel_lib::split(text, threads);
+        if (parts.ranges.empty()) {
+            throw std::runtime_error("json is empty: " + file.string());
+        }
+
+        std::vector<node> chunks(parts.ranges.size());
+        std::vector<std::exception_ptr> errors(parts.ranges.size());
+        const auto work = [&](const size_t index) {
+            try {
+                chunks[index]
+                    = infer_range(text, parts.layout, parts.ranges[index]);
+            } catch (...) {
+                errors[index] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(parts.ranges.size() - 1);
+        for (size_t i = 1; i < parts.ranges.size(); ++i) {
+            workers.emplace_back(work, i);
+        }
+        work(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        node records;
+        for (const auto& chunk : chunks) {
+            records.merge(chunk);
+        }
+        if (parts.layout != parallel_lib::input_layout::array) {
+            result.merge(records);
+            continue;
+        }
+        node document;
+        document.count = 1;
+        ++document.types[type_index(json_lib::json_type::array_json)];
+        document.sizes.add(records.count);
+        if (records.count > 0) {
+            document.element().merge(records);
+        }
+        result.merge(document);
+    }
+    return result;
+}
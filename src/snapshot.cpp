@@ -0,0 +1,507 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "snapshot.hpp"
+#include "binary.hpp"
+#include "reference.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+using binary_lib::put_u32;
+using binary_lib::put_u64;
+using binary_lib::set_u64;
+
+constexpr std::string_view magic = "JBIN";
+constexpr uint32_t version = 1;
+constexpr uint64_t header_size = 32;
+
+enum tag : uint8_t {
+    null_tag,
+    false_tag,
+    true_tag,
+    integer_tag,
+    real_tag,
+    string_tag,
+    array_tag,
+    object_tag
+};
+
+class encoder {
+public:
+    std::string out;
+
+    uint64_t put(const json_lib::json& value) {
+        switch (value.type()) {
+        case json_lib::json_type::null_json:
+            return put_tag(null_tag);
+        case json_lib::json_type::boolean_json:
+            return put_tag(
+                dynamic_cast<const json_lib::json_boolean&>(value).as_bool()
+                    ? true_tag
+                    : false_tag
+            );
+        case json_lib::json_type::integer_json: {
+            const auto& integer
+                = dynamic_cast<const json_lib::json_integer&>(value);
+            const uint64_t offset = put_tag(integer_tag);
+            put_u32(out, static_cast<uint32_t>(integer.as_index()));
+            return offset;
+        }
+        case json_lib::json_type::real_json: {
+            const uint64_t offset = put_tag(real_tag);
+            put_u32(out, intern(value.to_string()));
+            return offset;
+        }
+        case json_lib::json_type::string_json: {
+            const auto& string
+                = dynamic_cast<const json_lib::json_string&>(value);
+            const uint64_t offset = put_tag(string_tag);
+            put_u32(out, intern(string.as_key()));
+            return offset;
+        }
+        case json_lib::json_type::array_json:
+            return put_array(dynamic_cast<const json_lib::json_array&>(value));
+        case json_lib::json_type::object_json:
+            return put_object(
+                dynamic_cast<const json_lib::json_object&>(value)
+            );
+        default:
+            throw std::invalid_argument(
+                "cannot encode a "
+                + json_lib::json_type_to_string(value.type())
+                + " in a snapshot"
+            );
+        }
+    }
+
+    uint64_t put_strings() {
+        const uint64_t offset = out.size();
+        put_u32(out, static_cast<uint32_t>(strings.size()));
+        uint64_t bytes = offset + 4 + 12 * strings.size();
+        for (const auto* string : strings) {
+            put_u64(out, bytes);
+            put_u32(out, static_cast<uint32_t>(string->size()));
+            bytes += string->size();
+        }
+        for (const auto* string : strings) {
+            out += *string;
+        }
+        return offset;
+    }
+
+private:
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<const std::string*> strings;
+
+    uint64_t put_tag(const tag type) {
+        const uint64_t offset = out.size();
+        out += static_cast<char>(type);
+        return offset;
+    }
+
+    uint32_t intern(const std::string& text) {
+        const auto [found, inserted]
+            = ids.try_emplace(text, static_cast<uint32_t>(strings.size()));
+        if (inserted) {
+            strings.emplace_back(&found->first);
+        }
+        return found->second;
+    }
+
+    uint64_t put_array(const json_lib::json_array& array) {
+        std::vector<uint64_t> children;
+        children.reserve(array.size());
+        for (const auto& item : array.items()) {
+            children.emplace_back(put(*item));
+        }
+        const uint64_t offset = put_tag(array_tag);
+        put_u32(out, static_cast<uint32_t>(children.size()));
+        for (const uint64_t child : children) {
+            put_u64(out, child);
+        }
+        return offset;
+    }
+
+    uint64_t put_object(const json_lib::json_object& object) {
+        const auto& items = object.items();
+        std::vector<uint64_t> children;
+        children.reserve(items.size());
+        for (const auto& item : items) {
+            children.emplace_back(put(*item.second));
+        }
+        std::vector<uint32_t> directory(items.size());
+        for (uint32_t i = 0; i < directory.size(); ++i) {
+            directory[i] = i;
+        }
+        std::ranges::stable_sort(directory, [&](const auto a, const auto b) {
+            return items[a].first < items[b].first;
+        });
+
+        const uint64_t offset = put_tag(object_tag);
+        put_u32(out, static_cast<uint32_t>(items.size()));
+        for (size_t i = 0; i < items.size(); ++i) {
+            put_u32(out, intern(items[i].first));
+            put_u64(out, children[i]);
+        }
+        for (const uint32_t index : directory) {
+            put_u32(out, index);
+        }
+        return offset;
+    }
+};
+
+[[noreturn]] void corrupt() {
+    throw std::runtime_error("corrupt snapshot");
+}
+
+uint64_t checked_read(
+    const std::string_view data, const uint64_t offset, const size_t width
+) {
+    const auto value = binary_lib::read(data, offset, width);
+    if (!value) {
+        corrupt();
+    }
+    return *value;
+}
+
+/**
+ * Children are encoded before their parents, so a child offset at or past
+ * the parent's can only come from a corrupt snapshot and could make a walk
+ * loop forever.
+ */
+uint64_t child_offset(const uint64_t parent, const uint64_t child) {
+    if (child >= parent) {
+        corrupt();
+    }
+    return child;
+}
+
+constexpr uint64_t entry_size = 12;
+}
+
+std::string snapshot_lib::encode(const json_lib::json& document) {
+    encoder writer;
+    writer.out.assign(header_size, '\0');
+    const uint64_t root = writer.put(document);
+    const uint64_t strings = writer.put_strings();
+    std::string& out = writer.out;
+    out.replace(0, magic.size(), magic);
+    for (size_t i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<char>((version >> (8 * i)) & 0xFF);
+    }
+    set_u64(out, 8, root);
+    set_u64(out, 16, strings);
+    set_u64(out, 24, out.size());
+    return std::move(out);
+}
+
+void snapshot_lib::write(
+    const json_lib::json& document, const std::filesystem::path& path
+) {
+    const std::string bytes = encode(document);
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs.is_open()) {
+        throw std::invalid_argument(
+            "failed to open file with path: " + path.string()
+        );
+    }
+    ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+bool snapshot_lib::is_snapshot(const std::filesystem::path& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    std::string head(magic.size(), '\0');
+    return ifs.read(head.data(), static_cast<std::streamsize>(head.size()))
+        && head == magic;
+}
+
+snapshot_lib::snapshot::snapshot(const std::filesystem::path& path)
+    : mapping(std::make_unique<transport_lib::mapped_segment>(path))
+    , data(mapping->view()) {
+    validate();
+}
+
+snapshot_lib::snapshot::snapshot(const std::string& bytes)
+    : data(bytes) {
+    validate();
+}
+
+void snapshot_lib::snapshot::validate() {
+    if (data.size() < header_size || !data.starts_with(magic)
+        || read_u32(4) != version || read_u64(24) != data.size()) {
+        throw std::runtime_error("not a json snapshot");
+    }
+    root_offset = read_u64(8);
+    strings_offset = read_u64(16);
+    string_count = read_u32(strings_offset);
+    if (root_offset >= strings_offset
+        || strings_offset + 4 + entry_size * string_count > data.size()) {
+        corrupt();
+    }
+}
+
+uint8_t snapshot_lib::snapshot::read_u8(const uint64_t offset) const {
+    return static_cast<uint8_t>(checked_read(data, offset, 1));
+}
+
+uint32_t snapshot_lib::snapshot::read_u32(const uint64_t offset) const {
+    return static_cast<uint32_t>(checked_read(data, offset, 4));
+}
+
+uint64_t snapshot_lib::snapshot::read_u64(const uint64_t offset) const {
+    return checked_read(data, offset, 8);
+}
+
+snapshot_lib::node snapshot_lib::snapshot::root() const {
+    return { *this, root_offset };
+}
+
+std::string_view snapshot_lib::snapshot::string_at(const uint32_t id) const {
+    if (id >= string_count) {
+        corrupt();
+    }
+    const uint64_t entry = strings_offset + 4 + entry_size * id;
+    const uint64_t offset = read_u64(entry);
+    const uint32_t length = read_u32(entry + 8);
+    if (offset > data.size() || data.size() - offset < length) {
+        corrupt();
+    }
+    return data.substr(offset, length);
+}
+
+std::string_view snapshot_lib::snapshot::bytes() const { return data; }
+
+snapshot_lib::node::node(const snapshot& owner, const uint64_t offset)
+    : owner(&owner)
+    , position(offset)
+    , tag(owner.read_u8(offset)) {
+    if (tag > object_tag) {
+        corrupt();
+    }
+}
+
+json_lib::json_type snapshot_lib::node::type() const {
+    switch (tag) {
+    case false_tag:
+    case true_tag:
+        return json_lib::json_type::boolean_json;
+    case integer_tag:
+        return json_lib::json_type::integer_json;
+    case real_tag:
+        return json_lib::json_type::real_json;
+    case string_tag:
+        return json_lib::json_type::string_json;
+    case array_tag:
+        return json_lib::json_type::array_json;
+    case object_tag:
+        return json_lib::json_type::object_json;
+    default:
+        return json_lib::json_type::null_json;
+    }
+}
+
+size_t snapshot_lib::node::size() const {
+    if (tag != array_tag && tag != object_tag) {
+        return 0;
+    }
+    return owner->read_u32(position + 1);
+}
+
+snapshot_lib::node snapshot_lib::node::at(const size_t index) const {
+    if (tag != array_tag || index >= size()) {
+        throw std::out_of_range("index out of range");
+    }
+    return { *owner,
+             child_offset(
+                 position, owner->read_u64(position + 5 + 8 * index)
+             ) };
+}
+
+std::optional<snapshot_lib::node>
+snapshot_lib::node::find(const std::string_view key) const {
+    if (tag != object_tag) {
+        return std::nullopt;
+    }
+    const size_t count = size();
+    const uint64_t directory = position + 5 + entry_size * count;
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        const uint32_t index = owner->read_u32(directory + 4 * middle);
+        if (index >= count) {
+            corrupt();
+        }
+        const auto candidate = key_at(index);
+        if (candidate < key) {
+            low = middle + 1;
+        } else if (key < candidate) {
+            high = middle;
+        } else {
+            return value_at(index);
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view snapshot_lib::node::key_at(const size_t index) const {
+    if (tag != object_tag || index >= size()) {
+        throw std::out_of_range("index out of range");
+    }
+    return owner->string_at(
+        owner->read_u32(position + 5 + entry_size * index)
+    );
+}
+
+snapshot_lib::node snapshot_lib::node::value_at(const size_t index) const {
+    if (tag != object_tag || index >= size()) {
+        throw std::out_of_range("index out of range");
+    }
+    return { *owner,
+             child_offset(
+                 position, owner->read_u64(position + 9 + entry_size * index)
+             ) };
+}
+
+std::string_view snapshot_lib::node::text() const {
+    if (tag != string_tag && tag != real_tag) {
+        return {};
+    }
+    return owner->string_at(owner->read_u32(position + 1));
+}
+
+int snapshot_lib::node::integer() const {
+    return tag == integer_tag
+        ? static_cast<int>(owner->read_u32(position + 1))
+        : 0;
+}
+
+bool snapshot_lib::node::boolean() const { return tag == true_tag; }
+
+uint64_t snapshot_lib::node::offset() const { return position; }
+
+std::shared_ptr<json_lib::json> snapshot_lib::node::materialize() const {
+    switch (tag) {
+    case false_tag:
+    case true_tag:
+        return std::make_shared<json_lib::json_boolean>(boolean());
+    case integer_tag:
+        return std::make_shared<json_lib::json_integer>(integer());
+    case real_tag:
+        return std::make_shared<json_lib::json_real>(std::string(text()));
+    case string_tag:
+        return std::make_shared<json_lib::json_string>(std::string(text()));
+    case array_tag: {
+        std::vector<std::shared_ptr<json_lib::json>> items;
+        items.reserve(size());
+        for (size_t i = 0; i < size(); ++i) {
+            items.emplace_back(at(i).materialize());
+        }
+        return std::make_shared<json_lib::json_array>(items);
+    }
+    case object_tag: {
+        std::vector<std::pair<std::string, std::shared_ptr<json_lib::json>>>
+            items;
+        items.reserve(size());
+        for (size_t i = 0; i < size(); ++i) {
+            items.emplace_back(key_at(i), value_at(i).materialize());
+        }
+        return std::make_shared<json_lib::json_object>(items);
+    }
+    default:
+        return std::make_shared<json_lib::json>();
+    }
+}
+
+namespace {
+snapshot_lib::node step(
+    const snapshot_lib::node& current,
+    const std::shared_ptr<json_lib::json>& accessor
+) {
+    if (accessor->type() == json_lib::json_type::string_json
+        && current.type() == json_lib::json_type::object_json) {
+        const auto key
+            = std::dynamic_pointer_cast<json_lib::json_string>(accessor)
+                  ->as_key();
+        if (const auto found = current.find(key)) {
+            return *found;
+        }
+        throw std::out_of_range("key not found");
+    }
+    if (accessor->type() == json_lib::json_type::integer_json
+        && current.type() == json_lib::json_type::array_json) {
+        int index = std::dynamic_pointer_cast<json_lib::json_integer>(accessor)
+                        ->as_index();
+        if (json_lib::enable_negative_indexing && index < 0) {
+            index += static_cast<int>(current.size());
+        }
+        if (index < 0) {
+            throw std::out_of_range("index out of range");
+        }
+        return current.at(static_cast<size_t>(index));
+    }
+    // Mismatched types: let the tree report the error as it would after a
+    // full parse. Containers are replaced by empty ones to avoid decoding
+    // them.
+    std::shared_ptr<json_lib::json> value;
+    if (current.type() == json_lib::json_type::array_json) {
+        value = std::make_shared<json_lib::json_array>();
+    } else if (current.type() == json_lib::json_type::object_json) {
+        value = std::make_shared<json_lib::json_object>();
+    } else {
+        value = current.materialize();
+    }
+    value->by(accessor);
+    throw std::invalid_argument("invalid accessor");
+}
+}
+
+std::shared_ptr<json_lib::json> snapshot_lib::evaluate(
+    const snapshot& data, const std::shared_ptr<json_lib::json>& expression
+) {
+    const auto resolved = reference_lib::resolve_paths(
+        expression,
+        [&](const reference_lib::json_reference& reference)
+            -> std::shared_ptr<json_lib::json> {
+            if (!reference_lib::is_constant_path(reference)) {
+                return nullptr;
+            }
+            auto current = data.root();
+            for (const auto& accessor : reference.get_tail()) {
+                current = step(current, accessor);
+            }
+            return current.materialize();
+        }
+    );
+    if (resolved) {
+        return reference_lib::evaluate(
+            resolved, std::make_shared<json_lib::json>()
+        );
+    }
+    return reference_lib::evaluate(expression, data.root().materialize());
+}
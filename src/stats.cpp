@@ -0,0 +1,195 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "stats.hpp"
+
+#include "alloc.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+std::string type_key(const json_lib::json_type type) {
+    switch (type) {
+    case json_lib::json_type::null_json:
+        return "null";
+    case json_lib::json_type::boolean_json:
+        return "boolean";
+    case json_lib::json_type::integer_json:
+        return "integer";
+    case json_lib::json_type::real_json:
+        return "real";
+    case json_lib::json_type::string_json:
+        return "string";
+    case json_lib::json_type::array_json:
+        return "array";
+    case json_lib::json_type::object_json:
+        return "object";
+    default:
+        return "unknown";
+    }
+}
+}
+
+stats_lib::stopwatch::stopwatch()
+    : start(std::chrono::steady_clock::now()) { }
+
+void stats_lib::stopwatch::restart() {
+    start = std::chrono::steady_clock::now();
+}
+
+std::chrono::microseconds stats_lib::stopwatch::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start
+    );
+}
+
+void stats_lib::document_stats::collect(
+    const json_lib::json& item, const size_t depth
+) {
+    const auto type = item.type();
+    if (static_cast<size_t>(type) >= type_count) {
+        return;
+    }
+    ++nodes[static_cast<size_t>(type)];
+    max_depth = std::max(max_depth, depth);
+    if (type == json_lib::json_type::string_json) {
+        string_bytes += dynamic_cast<const json_lib::json_string&>(item).size();
+    } else if (type == json_lib::json_type::array_json) {
+        for (const auto& child :
+             dynamic_cast<const json_lib::json_array&>(item).items()) {
+            collect(*child, depth + 1);
+        }
+    } else if (type == json_lib::json_type::object_json) {
+        for (const auto& [key, child] :
+             dynamic_cast<const json_lib::json_object&>(item).items()) {
+            string_bytes += key.size();
+            collect(*child, depth + 1);
+        }
+    }
+}
+
+size_t stats_lib::document_stats::total_nodes() const {
+    size_t total = 0;
+    for (const size_t count : nodes) {
+        total += count;
+    }
+    return total;
+}
+
+std::string stats_lib::run_stats::to_string() const {
+    std::ostringstream oss;
+    oss << "{\"bytes_read\": " << bytes_read << ", \"time_us\": {"
+        << "\"read\": " << read_time.count()
+        << ", \"parse\": " << parse_time.count()
+        << ", \"compile\": " << compile_time.count()
+        << ", \"evaluate\": " << evaluate_time.count()
+        << ", \"serialize\": " << serialize_time.count() << "}, \"nodes\": {";
+    for (size_t i = 0; i < document_stats::type_count; ++i) {
+        oss << '"' << type_key(static_cast<json_lib::json_type>(i))
+            << "\": " << document.nodes[i] << ", ";
+    }
+    oss << "\"total\": " << document.total_nodes()
+        << "}, \"max_depth\": " << document.max_depth
+        << ", \"string_bytes\": " << document.string_bytes
+        << ", \"document_memory\": " << document_memory
+        << ", \"peak_rss\": " << peak_rss() << ", \"allocations\": {";
+    if constexpr (alloc_lib::enabled) {
+        for (size_t i = 0; i < alloc_lib::phase_count; ++i) {
+            const auto type = static_cast<alloc_lib::phase>(i);
+            const auto counters = alloc_lib::allocations(type);
+            oss << '"' << alloc_lib::phase_to_string(type) << "\": {\"count\": "
+                << counters.count << ", \"bytes\": " << counters.bytes
+                << "}, ";
+        }
+    }
+    const auto total = alloc_lib::total();
+    oss << "\"total\": {\"count\": " << total.count
+        << ", \"bytes\": " << total.bytes << "}}}";
+    return oss.str();
+}
+
+double stats_lib::latency_summary::throughput() const {
+    if (total.count() == 0) {
+        return 0;
+    }
+    return static_cast<double>(count) * 1e9
+        / static_cast<double>(total.count());
+}
+
+std::string stats_lib::latency_summary::to_string() const {
+    const auto us = [](const std::chrono::nanoseconds time) {
+        return static_cast<double>(time.count()) / 1000.0;
+    };
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3) << "iterations: " << count
+        << "\nmin: " << us(min) << "us\nmedian: " << us(median)
+        << "us\np99: " << us(p99) << "us\nmax: " << us(max)
+        << "us\nthroughput: " << std::setprecision(1) << throughput()
+        << " ops/s\n";
+    return oss.str();
+}
+
+stats_lib::latency_summary
+stats_lib::summarize(std::vector<std::chrono::nanoseconds> samples) {
+    latency_summary result;
+    if (samples.empty()) {
+        return result;
+    }
+    std::ranges::sort(samples);
+    const auto rank = [&samples](const size_t percent) {
+        const size_t index = (samples.size() * percent + 99) / 100;
+        return samples[std::max<size_t>(index, 1) - 1];
+    };
+    result.count = samples.size();
+    result.min = samples.front();
+    result.median = rank(50);
+    result.p99 = rank(99);
+    result.max = samples.back();
+    for (const auto sample : samples) {
+        result.total += sample;
+    }
+    return result;
+}
+
+size_t stats_lib::peak_rss() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,120 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "trace.hpp"
+
+#include <atomic>
+#include <iomanip>
+
+namespace {
+void write_string(std::ostream& os, const std::string& value) {
+    os << '"';
+    for (const char ch : value) {
+        switch (ch) {
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        case '\n':
+            os << "\\n";
+            break;
+        case '\t':
+            os << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                   << static_cast<int>(ch) << std::dec;
+            } else {
+                os << ch;
+            }
+        }
+    }
+    os << '"';
+}
+
+double to_us(const std::chrono::nanoseconds time) {
+    return static_cast<double>(time.count()) / 1000.0;
+}
+}
+
+trace_lib::recorder::recorder(const bool elements)
+    : origin(clock::now())
+    , per_element(elements) { }
+
+void trace_lib::recorder::complete(
+    const std::string& category, const std::string& name,
+    const clock::time_point start, const clock::time_point end
+) {
+    const std::lock_guard lock(mutex);
+    events.push_back({ category, name, start - origin, end - start,
+                       thread_id() });
+}
+
+bool trace_lib::recorder::elements() const { return per_element; }
+
+size_t trace_lib::recorder::size() const {
+    const std::lock_guard lock(mutex);
+    return events.size();
+}
+
+void trace_lib::recorder::write(std::ostream& os) const {
+    const std::lock_guard lock(mutex);
+    os << "{\"traceEvents\": [";
+    os << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const auto& [category, name, start, duration, thread] = events[i];
+        os << (i == 0 ? "\n" : ",\n") << "{\"name\": ";
+        write_string(os, name);
+        os << ", \"cat\": ";
+        write_string(os, category);
+        os << ", \"ph\": \"X\", \"ts\": " << to_us(start)
+           << ", \"dur\": " << to_us(duration) << ", \"pid\": 1, \"tid\": "
+           << thread << '}';
+    }
+    os << "\n], \"displayTimeUnit\": \"ns\"}\n";
+}
+
+size_t trace_lib::thread_id() {
+    static std::atomic<size_t> next { 1 };
+    thread_local const size_t id = next.fetch_add(1);
+    return id;
+}
+
+trace_lib::span::span(const char* name, const char* category)
+    : target(active_recorder)
+    , name(name)
+    , category(category) {
+    if (target != nullptr) {
+        start = clock::now();
+    }
+}
+
+trace_lib::span::~span() {
+    if (target != nullptr) {
+        target->complete(category, name, start, clock::now());
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "transport.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+namespace {
+[[noreturn]] void throw_system_error(const std::string& action) {
+    throw std::runtime_error(action + ": " + std::strerror(errno));
+}
+}
+
+int transport_lib::create_memfd(const std::string& name) {
+#ifdef __linux__
+    // No MFD_CLOEXEC: the descriptor is meant to survive the exec of the
+    // process that writes into it.
+    const int fd = memfd_create(name.c_str(), 0);
+    if (fd < 0) {
+        throw_system_error("failed to create memfd `" + name + '`');
+    }
+    return fd;
+#else
+    throw std::runtime_error(
+        "anonymous shared memory is not supported: " + name
+    );
+#endif
+}
+
+void transport_lib::write_segment(const int fd, const std::string_view text) {
+    if (ftruncate(fd, static_cast<off_t>(text.size())) != 0) {
+        throw_system_error("failed to resize shared memory");
+    }
+    if (text.empty()) {
+        return;
+    }
+    void* address
+        = mmap(nullptr, text.size(), PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        throw_system_error("failed to map shared memory");
+    }
+    std::memcpy(address, text.data(), text.size());
+    munmap(address, text.size());
+}
+
+void transport_lib::write_segment(
+    const std::filesystem::path& path, const std::string_view text
+) {
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        throw_system_error("failed to open `" + path.string() + '`');
+    }
+    try {
+        write_segment(fd, text);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+}
+
+transport_lib::mapped_segment::mapped_segment(const int fd) { map(fd); }
+
+void transport_lib::mapped_segment::map(const int fd) {
+    struct stat status {};
+    if (fstat(fd, &status) != 0) {
+        throw_system_error("failed to inspect shared memory");
+    }
+    length = static_cast<size_t>(status.st_size);
+    if (length == 0) {
+        return;
+    }
+    address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        address = nullptr;
+        throw_system_error("failed to map shared memory");
+    }
+}
+
+transport_lib::mapped_segment::mapped_segment(
+    const std::filesystem::path& path
+) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::invalid_argument(
+            "failed to open file with path: " + path.string()
+        );
+    }
+    try {
+        map(fd);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+}
+
+transport_lib::mapped_segment::~mapped_segment() {
+    if (address != nullptr) {
+        munmap(address, length);
+    }
+}
+#else
+int transport_lib::create_memfd(const std::string& name) {
+    throw std::runtime_error(
+        "anonymous shared memory is not supported: " + name
+    );
+}
+
+void transport_lib::write_segment(int, std::string_view) {
+    throw std::runtime_error("shared memory is not supported");
+}
+
+void transport_lib::write_segment(
+    const std::filesystem::path&, std::string_view
+) {
+    throw std::runtime_error("shared memory is not supported");
+}
+
+transport_lib::mapped_segment::mapped_segment(int) {
+    throw std::runtime_error("shared memory is not supported");
+}
+
+transport_lib::mapped_segment::mapped_segment(
+    const std::filesystem::path& path
+) {
+    throw std::runtime_error("mapping is not supported: " + path.string());
+}
+
+transport_lib::mapped_segment::~mapped_segment() = default;
+#endif
+
+std::string_view transport_lib::mapped_segment::view() const {
+    return { static_cast<const char*>(address), length };
+}
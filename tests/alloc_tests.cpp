@@ -0,0 +1,128 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "alloc.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <new>
+#include <thread>
+#include <vector>
+
+TEST(AllocTest, PhaseToStringTest) {
+    EXPECT_EQ(alloc_lib::phase_to_string(alloc_lib::phase::other), "other");
+    EXPECT_EQ(alloc_lib::phase_to_string(alloc_lib::phase::read), "read");
+    EXPECT_EQ(alloc_lib::phase_to_string(alloc_lib::phase::parse), "parse");
+    EXPECT_EQ(
+        alloc_lib::phase_to_string(alloc_lib::phase::compile), "compile"
+    );
+    EXPECT_EQ(
+        alloc_lib::phase_to_string(alloc_lib::phase::evaluate), "evaluate"
+    );
+    EXPECT_EQ(
+        alloc_lib::phase_to_string(alloc_lib::phase::serialize), "serialize"
+    );
+}
+
+TEST(AllocTest, PhaseCountersTest) {
+    alloc_lib::reset();
+    std::shared_ptr<json_lib::json> base;
+    std::string buffer
+        = R"({"a": [1, 2, {"b": "a long enough string value"}]})";
+    parser_lib::parser p(buffer);
+    p.completely_parse_json(base);
+
+    std::shared_ptr<json_lib::json> result;
+    buffer = "a[2].b";
+    p = parser_lib::parser(buffer);
+    p.completely_parse_json(result, true);
+    result = reference_lib::evaluate(result, base);
+    EXPECT_EQ(result->to_string(), "\"a long enough string value\"");
+
+    const auto parse = alloc_lib::allocations(alloc_lib::phase::parse);
+    const auto compile = alloc_lib::allocations(alloc_lib::phase::compile);
+    const auto serialize = alloc_lib::allocations(alloc_lib::phase::serialize);
+    if constexpr (alloc_lib::enabled) {
+        EXPECT_GT(parse.count, compile.count);
+        EXPECT_GT(compile.count, 0);
+        EXPECT_GT(serialize.count, 0);
+        EXPECT_GE(parse.bytes, parse.count);
+        EXPECT_GE(alloc_lib::total().count, parse.count + compile.count);
+        {
+            const alloc_lib::phase_scope scope(alloc_lib::phase::read);
+            const auto before = alloc_lib::allocations(alloc_lib::phase::read);
+            const auto item = std::make_shared<json_lib::json_integer>(1);
+            EXPECT_EQ(
+                alloc_lib::allocations(alloc_lib::phase::read).count,
+                before.count + 1
+            );
+        }
+    } else {
+        EXPECT_EQ(parse.count, 0);
+        EXPECT_EQ(compile.count, 0);
+        EXPECT_EQ(serialize.count, 0);
+        EXPECT_GT(alloc_lib::total().count, 0);
+        EXPECT_EQ(
+            alloc_lib::allocations(alloc_lib::phase::other).count,
+            alloc_lib::total().count
+        );
+    }
+    alloc_lib::reset();
+    EXPECT_EQ(alloc_lib::total().count, 0);
+}
+
+TEST(AllocTest, ThreadCountersTest) {
+    const auto before = alloc_lib::total().count;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 100; ++i) {
+                static_cast<void>(std::make_unique<int>(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_GE(alloc_lib::total().count, before + 400);
+}
+
+namespace {
+bool handler_called = false;
+}
+
+TEST(AllocTest, NewHandlerTest) {
+    std::set_new_handler([] {
+        handler_called = true;
+        std::set_new_handler(nullptr);
+    });
+    EXPECT_THROW(
+        ::operator delete(
+            ::operator new(std::numeric_limits<size_t>::max() / 2)
+        ),
+        std::bad_alloc
+    );
+    EXPECT_TRUE(handler_called);
+    std::set_new_handler(nullptr);
+}
@@ -0,0 +1,120 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "batch.hpp"
+#include "governor.hpp"
+#include "helpers.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using test_lib::parse;
+
+TEST(BatchTest, CoalescedPathsTest) {
+    const auto document = parse(
+        R"({"a": {"b": [10, 20, 30], "c": "text"}, "d": [1, 2, 3]})"
+    );
+    batch_lib::coalescer coalescer(document, std::chrono::milliseconds(20));
+    auto first = coalescer.submit("a.b[1]");
+    auto second = coalescer.submit("a.b[2]");
+    auto third = coalescer.submit("$.a.c");
+    auto whole = coalescer.submit("$");
+    auto function = coalescer.submit("max(d)");
+    auto missing = coalescer.submit("a.x.y");
+    auto out_of_range = coalescer.submit("d[7]");
+
+    EXPECT_EQ(first.get()->to_string(), "20");
+    EXPECT_EQ(second.get()->to_string(), "30");
+    EXPECT_EQ(third.get()->to_string(), "\"text\"");
+    EXPECT_EQ(whole.get(), document);
+    EXPECT_EQ(function.get()->to_string(), "3");
+    EXPECT_THROW(missing.get(), std::out_of_range);
+    EXPECT_THROW(out_of_range.get(), std::out_of_range);
+
+    const auto stats = coalescer.stats();
+    EXPECT_EQ(stats.batches, 1);
+    EXPECT_EQ(stats.queries, 7);
+    EXPECT_EQ(stats.coalesced, 6);
+    // a, a.b, a.b[1], a.b[2], a.c, a.x, d, d[7]
+    EXPECT_EQ(stats.steps, 8);
+    EXPECT_THROW(coalescer.submit("a.b["), std::runtime_error);
+}
+
+TEST(BatchTest, ConcurrentSubmitTest) {
+    const auto document = parse(R"({"items": [0, 1, 2, 3, 4, 5, 6, 7]})");
+    // A window long enough for the other clients to submit while a batch is
+    // open, so that queries are actually coalesced.
+    batch_lib::coalescer coalescer(document, std::chrono::milliseconds(2));
+    std::vector<std::thread> clients;
+    std::vector<int> mismatches(4, 0);
+    for (size_t t = 0; t < mismatches.size(); ++t) {
+        clients.emplace_back([&, t] {
+            for (int i = 0; i < 200; ++i) {
+                const int index = i % 8;
+                const auto result
+                    = coalescer.submit("items[" + std::to_string(index) + "]")
+                          .get();
+                if (result->to_string() != std::to_string(index)) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    for (const int count : mismatches) {
+        EXPECT_EQ(count, 0);
+    }
+    const auto stats = coalescer.stats();
+    EXPECT_EQ(stats.queries, 800);
+    EXPECT_LT(stats.batches, stats.queries);
+}
+
+TEST(BatchTest, StepBudgetTest) {
+    const auto document = parse(R"({"a": {"b": {"c": 1}}})");
+    governor_lib::limits limits;
+    limits.max_steps = 2;
+    governor_lib::active_limits = &limits;
+    {
+        batch_lib::coalescer coalescer(document, std::chrono::milliseconds(20));
+        auto shallow = coalescer.submit("a.b");
+        auto deep = coalescer.submit("a.b.c");
+        EXPECT_EQ(shallow.get()->to_string(), R"({"c": 1})");
+        EXPECT_THROW(deep.get(), governor_lib::limit_exceeded);
+        EXPECT_EQ(coalescer.stats().batches, 1);
+    }
+    governor_lib::active_limits = nullptr;
+}
+
+TEST(BatchTest, CancellationTest) {
+    const auto document = parse(R"({"a": 1})");
+    governor_lib::cancellation_token token;
+    const governor_lib::token_scope scope(token);
+    batch_lib::coalescer coalescer(document, std::chrono::milliseconds(20));
+    auto result = coalescer.submit("a");
+    token.cancel();
+    EXPECT_THROW(result.get(), governor_lib::operation_cancelled);
+}
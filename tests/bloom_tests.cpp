@@ -0,0 +1,125 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bloom.hpp"
+#include "helpers.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+using test_lib::parse;
+
+TEST(BloomTest, FilterTest) {
+    bloom_lib::filter filter(1000);
+    EXPECT_GT(filter.hashes(), 1);
+    for (int i = 0; i < 1000; ++i) {
+        filter.add("item-" + std::to_string(i));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(filter.may_contain("item-" + std::to_string(i)));
+    }
+    int false_positives = 0;
+    for (int i = 0; i < 10000; ++i) {
+        false_positives += filter.may_contain("other-" + std::to_string(i));
+    }
+    EXPECT_LT(false_positives, 300);
+
+    const bloom_lib::filter copy(filter.words(), filter.hashes());
+    EXPECT_TRUE(copy.may_contain("item-7"));
+    EXPECT_THROW(bloom_lib::filter({}, 3), std::invalid_argument);
+    EXPECT_THROW(bloom_lib::filter({ 1 }, 0), std::invalid_argument);
+    EXPECT_THROW(bloom_lib::filter(10, 1.0), std::invalid_argument);
+}
+
+TEST(BloomTest, SummaryTest) {
+    const auto document = parse(
+        R"({"user": {"name": "Alice", "age": 30}, "tags": ["x", true, null],
+            "score": 2.5})"
+    );
+    const auto summary = bloom_lib::summarize(*document);
+    using bloom_lib::target;
+    for (const auto& item : std::vector<bloom_lib::needle> {
+             { target::key, "user" },
+             { target::key, "name" },
+             { target::value, "Alice" },
+             { target::value, "30" },
+             { target::value, "x" },
+             { target::value, "true" },
+             { target::value, "null" },
+             { target::value, "2.5" } }) {
+        EXPECT_TRUE(bloom_lib::may_match(summary, item)) << item.text;
+        EXPECT_TRUE(bloom_lib::matches(*document, item)) << item.text;
+    }
+    EXPECT_FALSE(bloom_lib::matches(*document, { target::key, "Alice" }));
+    EXPECT_FALSE(bloom_lib::matches(*document, { target::value, "name" }));
+    EXPECT_FALSE(bloom_lib::matches(*document, { target::value, "Bob" }));
+}
+
+TEST(BloomTest, CatalogTest) {
+    const auto directory = test_lib::temp_path("bloom_tests");
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto file = directory / "a.json";
+    std::ofstream(file) << R"({"id": 1})";
+    const auto stamp = index_lib::stamp::of(file);
+
+    auto catalog = bloom_lib::catalog::read(directory / "missing.jblm");
+    EXPECT_EQ(catalog.size(), 0);
+    EXPECT_FALSE(catalog.modified());
+    catalog.record(file, stamp, bloom_lib::summarize(*parse(R"({"id": 1})")));
+    EXPECT_TRUE(catalog.modified());
+    catalog.write(directory / "files.jblm");
+
+    const auto loaded = bloom_lib::catalog::read(directory / "files.jblm");
+    EXPECT_EQ(loaded.size(), 1);
+    EXPECT_FALSE(loaded.modified());
+    const auto* summary = loaded.find(file, stamp);
+    ASSERT_NE(summary, nullptr);
+    EXPECT_TRUE(
+        bloom_lib::may_match(*summary, { bloom_lib::target::key, "id" })
+    );
+    auto changed = stamp;
+    ++changed.size;
+    EXPECT_EQ(loaded.find(file, changed), nullptr);
+    EXPECT_EQ(loaded.find(directory / "b.json", stamp), nullptr);
+
+    std::ofstream(directory / "bad.jblm") << "JBLM\x01";
+    EXPECT_THROW(
+        bloom_lib::catalog::read(directory / "bad.jblm"), std::runtime_error
+    );
+    // One entry claiming 2^32 - 1 filter words, with none following.
+    std::string huge("JBLM\x01\0\0\0\x01\0\0\0\x01\0\0\0a", 17);
+    huge += std::string(16, '\0');
+    huge += std::string("\x03\0\0\0\xff\xff\xff\xff", 8);
+    std::ofstream(directory / "huge.jblm", std::ios::binary) << huge;
+    EXPECT_THROW(
+        bloom_lib::catalog::read(directory / "huge.jblm"), std::runtime_error
+    );
+    std::ofstream(directory / "other.jblm") << "JIDX";
+    EXPECT_THROW(
+        bloom_lib::catalog::read(directory / "other.jblm"), std::runtime_error
+    );
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,110 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "catalog.hpp"
+#include "helpers.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+namespace {
+class CatalogTest : public testing::Test {
+protected:
+    void SetUp() override {
+        directory = test_lib::temp_path("catalog_tests");
+        std::filesystem::create_directories(directory);
+        for (const auto* name : { "a", "b", "c" }) {
+            write(
+                name, R"({"name": ")" + std::string(name) + R"(", "v": [1]})"
+            );
+        }
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    void write(const std::string& name, const std::string& content) const {
+        std::ofstream(directory / (name + ".json")) << content;
+    }
+
+    std::filesystem::path path(const std::string& name) const {
+        return directory / (name + ".json");
+    }
+
+    std::filesystem::path directory;
+};
+}
+
+TEST_F(CatalogTest, LoadAndHitTest) {
+    catalog_lib::catalog catalog(1 << 20);
+    const auto first = catalog.get(path("a"));
+    const auto second = catalog.get(directory / "." / "a.json");
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(catalog.size(), 1);
+    EXPECT_EQ(catalog.memory_usage(), first->memory_usage());
+    EXPECT_EQ(catalog.stats().loads, 1);
+    EXPECT_EQ(catalog.stats().hits, 1);
+
+    catalog.erase(path("a"));
+    EXPECT_FALSE(catalog.contains(path("a")));
+    EXPECT_EQ(catalog.memory_usage(), 0);
+    EXPECT_THROW(catalog.get(path("missing")), std::invalid_argument);
+    write("broken", "[1, 2");
+    EXPECT_THROW(catalog.get(path("broken")), std::runtime_error);
+    EXPECT_EQ(catalog.size(), 0);
+}
+
+TEST_F(CatalogTest, EvictionTest) {
+    const size_t one = catalog_lib::catalog(1 << 20).get(path("a"))
+                           ->memory_usage();
+    catalog_lib::catalog catalog(2 * one);
+    catalog.get(path("a"));
+    catalog.get(path("b"));
+    catalog.get(path("a"));
+    catalog.get(path("c"));
+    EXPECT_TRUE(catalog.contains(path("a")));
+    EXPECT_FALSE(catalog.contains(path("b")));
+    EXPECT_TRUE(catalog.contains(path("c")));
+    EXPECT_LE(catalog.memory_usage(), catalog.memory_limit());
+    EXPECT_EQ(catalog.stats().evictions, 1);
+
+    catalog_lib::catalog tiny(one - 1);
+    EXPECT_EQ(tiny.get(path("a"))->to_string(), R"({"name": "a", "v": [1]})");
+    EXPECT_EQ(tiny.size(), 0);
+}
+
+TEST_F(CatalogTest, ReloadModifiedTest) {
+    catalog_lib::catalog catalog(1 << 20);
+    const auto before = catalog.get(path("a"));
+    write("a", "[1, 2, 3]");
+    std::filesystem::last_write_time(
+        path("a"),
+        std::filesystem::last_write_time(path("a")) + std::chrono::seconds(1)
+    );
+    const auto after = catalog.get(path("a"));
+    EXPECT_EQ(after->to_string(), "[1, 2, 3]");
+    EXPECT_EQ(before->to_string(), R"({"name": "a", "v": [1]})");
+    EXPECT_EQ(catalog.stats().loads, 2);
+    EXPECT_EQ(catalog.size(), 1);
+}
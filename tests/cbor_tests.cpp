@@ -0,0 +1,102 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cbor.hpp"
+#include "helpers.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+using test_lib::parse;
+
+std::string hex(const std::string& bytes) {
+    constexpr std::string_view digits = "0123456789abcdef";
+    std::string result;
+    for (const char c : bytes) {
+        const auto byte = static_cast<unsigned char>(c);
+        result += digits[byte >> 4];
+        result += digits[byte & 0x0F];
+    }
+    return result;
+}
+
+std::string encode(const std::string& text) {
+    return hex(cbor_lib::encode(*parse(text)));
+}
+}
+
+TEST(CborTest, ScalarTest) {
+    // Examples from RFC 8949, appendix A.
+    EXPECT_EQ(encode("0"), "00");
+    EXPECT_EQ(encode("23"), "17");
+    EXPECT_EQ(encode("24"), "1818");
+    EXPECT_EQ(encode("1000"), "1903e8");
+    EXPECT_EQ(encode("1000000"), "1a000f4240");
+    EXPECT_EQ(encode("-1"), "20");
+    EXPECT_EQ(encode("-100"), "3863");
+    EXPECT_EQ(encode("-1000"), "3903e7");
+    EXPECT_EQ(encode("-2147483648"), "3a7fffffff");
+    EXPECT_EQ(encode("1.5"), "fa3fc00000");
+    EXPECT_EQ(encode("100000.0"), "fa47c35000");
+    EXPECT_EQ(encode("1.1"), "fb3ff199999999999a");
+    EXPECT_EQ(encode("1.0e+30"), "fb46293e5939a08cea");
+    EXPECT_EQ(encode("false"), "f4");
+    EXPECT_EQ(encode("true"), "f5");
+    EXPECT_EQ(encode("null"), "f6");
+    EXPECT_EQ(encode("\"\""), "60");
+    EXPECT_EQ(encode("\"IETF\""), "6449455446");
+    EXPECT_EQ(encode("\"\\u00fc\""), "62c3bc");
+}
+
+TEST(CborTest, ContainerTest) {
+    EXPECT_EQ(encode("[]"), "80");
+    EXPECT_EQ(encode("[1, [2, 3], [4, 5]]"), "8301820203820405");
+    EXPECT_EQ(encode("{}"), "a0");
+    EXPECT_EQ(encode(R"({"a": 1, "b": [2, 3]})"), "a26161016162820203");
+    EXPECT_EQ(encode(R"(["a", {"b": "c"}])"), "826161a161626163");
+
+    std::string items = "[0";
+    for (int i = 1; i < 25; ++i) {
+        items += ", " + std::to_string(i);
+    }
+    EXPECT_TRUE(encode(items + "]").starts_with("98190001"));
+
+    EXPECT_THROW(cbor_lib::encode(*parse("a.b", true)), std::invalid_argument);
+}
+
+TEST(CborTest, StreamTest) {
+    // Larger than one output chunk.
+    std::string text = "[\"" + std::string(40, 'x') + "\"";
+    for (int i = 1; i < 5000; ++i) {
+        text += ", \"" + std::string(40, 'x') + "\"";
+    }
+    text += "]";
+    const auto document = parse(text);
+    std::ostringstream oss;
+    cbor_lib::write(*document, oss);
+    const std::string bytes = oss.str();
+    EXPECT_EQ(bytes.size(), 3 + 5000 * 42);
+    EXPECT_EQ(hex(bytes.substr(0, 5)), "991388" "7828");
+    EXPECT_EQ(bytes, cbor_lib::encode(*document));
+}
@@ -0,0 +1,184 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cli.hpp"
+#include <gtest/gtest.h>
+
+TEST(CliTest, ParseOptionsTest) {
+    const char* argv1[] = { "json_eval", "test.json", "a.b[1]" };
+    auto options = cli_lib::parse_options(3, argv1);
+    EXPECT_EQ(options.input, "test.json");
+    EXPECT_EQ(options.expression, "a.b[1]");
+    EXPECT_FALSE(options.stats);
+
+    const char* argv2[] = { "json_eval", "--stats", "test.json", "a" };
+    options = cli_lib::parse_options(4, argv2);
+    EXPECT_EQ(options.input, "test.json");
+    EXPECT_EQ(options.expression, "a");
+    EXPECT_TRUE(options.stats);
+
+    const char* argv3[] = { "json_eval", "test.json", "a", "--stats" };
+    options = cli_lib::parse_options(4, argv3);
+    EXPECT_TRUE(options.stats);
+
+    const char* argv4[] = { "json_eval", "test.json" };
+    EXPECT_THROW(cli_lib::parse_options(2, argv4), std::invalid_argument);
+
+    const char* argv5[] = { "json_eval", "--unknown", "test.json", "a" };
+    EXPECT_THROW(cli_lib::parse_options(4, argv5), std::invalid_argument);
+
+    const char* argv6[]
+        = { "json_eval", "one.json", "--threads", "2", "logs", "b" };
+    options = cli_lib::parse_options(6, argv6);
+    EXPECT_EQ(options.input, "one.json");
+    EXPECT_EQ(
+        options.inputs,
+        std::vector<std::filesystem::path>({ "one.json", "logs" })
+    );
+    EXPECT_EQ(options.expression, "b");
+    EXPECT_EQ(options.threads, 2);
+}
+
+TEST(CliTest, ParseValueOptionsTest) {
+    const char* argv1[] = { "json_eval", "--bench",     "100",
+                            "--bench-parse", "--trace", "out.json",
+                            "test.json", "a" };
+    auto options = cli_lib::parse_options(8, argv1);
+    EXPECT_EQ(options.bench, 100);
+    EXPECT_TRUE(options.bench_parse);
+    EXPECT_EQ(options.trace, "out.json");
+    EXPECT_EQ(options.input, "test.json");
+
+    const char* argv4[]
+        = { "json_eval", "test.json", "a", "--metrics", "unix:/tmp/m.sock" };
+    options = cli_lib::parse_options(5, argv4);
+    EXPECT_EQ(options.metrics, "unix:/tmp/m.sock");
+
+    const char* argv5[] = { "json_eval", "--max-depth", "64", "--max-time",
+                            "250",       "test.json",   "a" };
+    options = cli_lib::parse_options(7, argv5);
+    EXPECT_EQ(options.limits.max_depth, 64);
+    EXPECT_EQ(options.limits.max_time, std::chrono::milliseconds(250));
+    EXPECT_EQ(options.limits.max_nodes, 0);
+    EXPECT_EQ(options.timeout.count(), 0);
+
+    const char* argv6[]
+        = { "json_eval", "--output-shm", "fd:3", "test.json", "a" };
+    EXPECT_EQ(cli_lib::parse_options(5, argv6).output_shm, "fd:3");
+    for (const char* target :
+         { "fd:", "fd:-1", "fd:3x", "fd:+3", "fd:99999999999999999999" }) {
+        const char* argv7[]
+            = { "json_eval", "--output-shm", target, "test.json", "a" };
+        EXPECT_THROW(cli_lib::parse_options(5, argv7), std::invalid_argument)
+            << target;
+    }
+    EXPECT_EQ(cli_lib::output_fd("fd:7"), 7);
+    EXPECT_EQ(cli_lib::output_fd("result.bin"), std::nullopt);
+    EXPECT_THROW(
+        static_cast<void>(cli_lib::output_fd("fd:2147483648")),
+        std::invalid_argument
+    );
+
+    const char* argv8[] = { "json_eval", "--build-index", "3", "test.json" };
+    options = cli_lib::parse_options(4, argv8);
+    EXPECT_EQ(options.build_index, 3);
+    EXPECT_EQ(options.input, "test.json");
+    EXPECT_THROW(cli_lib::parse_options(3, argv8), std::invalid_argument);
+
+    const char* argv9[]
+        = { "json_eval", "test.mpk", "a", "--output", "msgpack" };
+    options = cli_lib::parse_options(5, argv9);
+    EXPECT_EQ(options.input_format, cli_lib::data_format::msgpack);
+    EXPECT_EQ(options.output_format, cli_lib::data_format::msgpack);
+    const char* argv10[]
+        = { "json_eval", "--input-format", "json", "test.msgpack", "a" };
+    options = cli_lib::parse_options(5, argv10);
+    EXPECT_EQ(options.input_format, cli_lib::data_format::json);
+    EXPECT_EQ(options.output_format, cli_lib::data_format::json);
+    const char* argv11[]
+        = { "json_eval", "--parallel", "2", "test.msgpack", "a" };
+    EXPECT_THROW(cli_lib::parse_options(5, argv11), std::invalid_argument);
+    const std::vector<std::vector<const char*>> single_document_options {
+        { "--max-depth", "1" }, { "--timeout", "10" },
+        { "--metrics", "m.prom" }, { "--trace", "t.json" },
+        { "--stats" }, { "--bench", "3" },
+        { "--explain" }, { "--output-shm", "fd:3" },
+        { "--output", "cbor" },
+    };
+    for (const auto& extra : single_document_options) {
+        std::vector<const char*> argv
+            = { "json_eval", "--parallel", "2", "test.json", "a" };
+        argv.insert(argv.end(), extra.begin(), extra.end());
+        EXPECT_THROW(
+            cli_lib::parse_options(static_cast<int>(argv.size()), argv.data()),
+            std::invalid_argument
+        ) << extra.front();
+        argv = { "json_eval", "a.json", "b.json", "a" };
+        argv.insert(argv.end(), extra.begin(), extra.end());
+        EXPECT_THROW(
+            cli_lib::parse_options(static_cast<int>(argv.size()), argv.data()),
+            std::invalid_argument
+        ) << extra.front();
+    }
+    const char* argv18[]
+        = { "json_eval", "--parallel", "2", "a.json", "b.json", "a" };
+    EXPECT_THROW(cli_lib::parse_options(6, argv18), std::invalid_argument);
+    EXPECT_EQ(cli_lib::parse_format("cbor"), cli_lib::data_format::cbor);
+    EXPECT_THROW(cli_lib::parse_format("xml"), std::invalid_argument);
+    const char* argv12[]
+        = { "json_eval", "--input-format", "cbor", "test.json", "a" };
+    EXPECT_THROW(cli_lib::parse_options(5, argv12), std::invalid_argument);
+
+    const char* argv13[]
+        = { "json_eval", "test.json", "items", "--shred", "items.jcol" };
+    options = cli_lib::parse_options(5, argv13);
+    EXPECT_EQ(options.shred, "items.jcol");
+    EXPECT_EQ(options.expression, "items");
+
+    const char* argv14[] = { "json_eval", "--column-cache", "1048576",
+                             "test.json", "items[*].id" };
+    options = cli_lib::parse_options(5, argv14);
+    EXPECT_EQ(options.column_cache, 1048576);
+    EXPECT_EQ(options.expression, "items[*].id");
+
+    const char* argv15[]
+        = { "json_eval", "--infer-schema", "a.json", "--threads", "4" };
+    options = cli_lib::parse_options(5, argv15);
+    EXPECT_TRUE(options.infer_schema);
+    EXPECT_EQ(options.inputs.size(), 1);
+    EXPECT_TRUE(options.expression.empty());
+    const char* argv16[] = { "json_eval", "--infer-schema", "a.msgpack" };
+    EXPECT_THROW(cli_lib::parse_options(3, argv16), std::invalid_argument);
+    const char* argv17[] = { "json_eval", "--infer-schema" };
+    EXPECT_THROW(cli_lib::parse_options(2, argv17), std::invalid_argument);
+
+    const char* argv2[] = { "json_eval", "test.json", "a", "--bench" };
+    EXPECT_THROW(cli_lib::parse_options(4, argv2), std::invalid_argument);
+
+    for (const char* count : { "0", "-1", "ten", "10x", "" }) {
+        const char* argv3[]
+            = { "json_eval", "--bench", count, "test.json", "a" };
+        EXPECT_THROW(cli_lib::parse_options(5, argv3), std::invalid_argument)
+            << count;
+    }
+}
@@ -0,0 +1,186 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "columnar.hpp"
+#include "helpers.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+using test_lib::parse;
+
+const std::string records = R"([
+    {"id": 1, "item": {"name": "a", "rating": 2.5}, "tags": [1, 2],
+     "live": true, "note": null, "mixed": 1},
+    {"item": {"rating": 4.0, "name": "b"}, "id": 7, "tags": [],
+     "live": false, "mixed": "one"},
+    {"id": 3, "item": {"name": "a"}, "tags": [5, null], "live": true,
+     "note": "x", "mixed": [1, {"deep": true}]},
+    {"id": 2, "item": null, "live": false, "mixed": null}
+])";
+
+columnar_lib::table shred(const std::string& text) {
+    const auto array = parse(text);
+    return columnar_lib::table::shred(
+        dynamic_cast<const json_lib::json_array&>(*array)
+    );
+}
+}
+
+TEST(ColumnarTest, ShredTest) {
+    const auto data = shred(records);
+    EXPECT_EQ(data.rows(), 4);
+    const auto type = [&](const std::vector<std::string>& path) {
+        return data.find(path)->type;
+    };
+    EXPECT_EQ(type({}), columnar_lib::column_type::object);
+    EXPECT_EQ(type({ "id" }), columnar_lib::column_type::integer);
+    EXPECT_EQ(type({ "item" }), columnar_lib::column_type::object);
+    EXPECT_EQ(type({ "item", "name" }), columnar_lib::column_type::string);
+    EXPECT_EQ(type({ "item", "rating" }), columnar_lib::column_type::real);
+    EXPECT_EQ(type({ "tags" }), columnar_lib::column_type::list);
+    EXPECT_EQ(
+        data.find({ "tags" })->element, columnar_lib::column_type::integer
+    );
+    EXPECT_EQ(type({ "live" }), columnar_lib::column_type::boolean);
+    EXPECT_EQ(type({ "note" }), columnar_lib::column_type::string);
+    EXPECT_EQ(type({ "mixed" }), columnar_lib::column_type::json);
+    EXPECT_EQ(data.find({ "missing" }), nullptr);
+
+    const auto* names = data.find({ "item", "name" });
+    EXPECT_EQ(names->dictionary.size(), 2);
+    EXPECT_EQ(names->codes.size(), 4);
+    EXPECT_TRUE(names->present[2]);
+    EXPECT_FALSE(names->present[3]);
+    const auto* tags = data.find({ "tags" });
+    EXPECT_EQ(tags->repetition, (std::vector<uint8_t> { 0, 1, 0, 0, 1 }));
+    EXPECT_EQ(tags->integers.size(), 5);
+
+    const auto original = parse(records);
+    EXPECT_EQ(data.materialize()->to_string(), original->to_string());
+    EXPECT_EQ(
+        data.record(1)->to_string(), original->by(parse("1"))->to_string()
+    );
+
+    EXPECT_EQ(shred("[1, 2, 3]").materialize()->to_string(), "[1, 2, 3]");
+    EXPECT_EQ(shred("[]").materialize()->to_string(), "[]");
+    EXPECT_EQ(
+        shred(R"([{"r": 2.50}, {"r": 1e2}, {"r": -0.0}, {"r": 2.50}])")
+            .materialize()
+            ->to_string(),
+        R"([{"r": 2.50}, {"r": 1e2}, {"r": -0.0}, {"r": 2.50}])"
+    );
+    EXPECT_EQ(
+        shred("[[true], null, [false, true]]").materialize()->to_string(),
+        "[[true], null, [false, true]]"
+    );
+}
+
+TEST(ColumnarTest, PersistTest) {
+    const auto data = shred(records);
+    const std::string bytes = data.encode();
+    EXPECT_EQ(
+        columnar_lib::table::decode(bytes).materialize()->to_string(),
+        data.materialize()->to_string()
+    );
+
+    const auto path = test_lib::temp_path("test.jcol");
+    data.write(path);
+    EXPECT_TRUE(columnar_lib::is_table(path));
+    EXPECT_EQ(
+        columnar_lib::table::read(path).record(1)->to_string(),
+        data.record(1)->to_string()
+    );
+    std::filesystem::remove(path);
+
+    EXPECT_THROW(columnar_lib::table::decode("JCO"), std::runtime_error);
+    EXPECT_THROW(
+        columnar_lib::table::decode(bytes.substr(0, bytes.size() - 1)),
+        std::runtime_error
+    );
+    std::string damaged = bytes;
+    damaged[8] = '\x05';
+    EXPECT_THROW(columnar_lib::table::decode(damaged), std::runtime_error);
+}
+
+TEST(ColumnarTest, EvaluateTest) {
+    const auto data = shred(records);
+    const auto query = [&](const std::string& expression) {
+        return columnar_lib::evaluate(data, parse(expression, true))
+            ->to_string();
+    };
+    const auto reference = [&](const std::string& expression) {
+        return reference_lib::evaluate(parse(expression, true), parse(records))
+            ->to_string();
+    };
+    for (const auto* expression :
+         { "size($)", "$[1].item.name", "$[0].tags[1]", "$[2].tags[1]",
+           "$[1].tags", "$[0].item", "$[3].item", "$[2].mixed[1].deep",
+           "[$[0].id, $[1].id]", "{\"x\": $[0].live}", "max($[0].tags)",
+           "size($[2].tags)", "$[1]{.id, .live}", "$" }) {
+        EXPECT_EQ(query(expression), reference(expression)) << expression;
+    }
+    EXPECT_THROW(query("$[4]"), std::out_of_range);
+    EXPECT_THROW(query("$[1].tags[0]"), std::out_of_range);
+    EXPECT_THROW(query("$[0].missing"), std::out_of_range);
+    EXPECT_THROW(query("$[3].item.name"), std::invalid_argument);
+    EXPECT_THROW(query("$[0].id.x"), std::invalid_argument);
+    EXPECT_THROW(query("$.id"), std::invalid_argument);
+}
+
+TEST(ColumnarTest, ProjectTest) {
+    const auto data = shred(records);
+    EXPECT_EQ(data.project({ "id" })->to_string(), "[1, 7, 3, 2]");
+    EXPECT_EQ(
+        data.project({ "item", "name" })->to_string(), R"(["a", "b", "a"])"
+    );
+    EXPECT_EQ(data.project({ "note" })->to_string(), R"([null, "x"])");
+    EXPECT_EQ(data.project({ "missing" })->to_string(), "[]");
+
+    EXPECT_EQ(data.extreme({ "id" }, true), 7);
+    EXPECT_EQ(data.extreme({ "id" }, false), 1);
+    EXPECT_FALSE(data.extreme({ "item", "name" }, true).has_value());
+    EXPECT_FALSE(shred(R"([{"a": 1}, {"a": null}])").extreme({ "a" }, true));
+    EXPECT_FALSE(shred(R"([{"b": 1}])").extreme({ "a" }, true));
+}
+
+TEST(ColumnarTest, ProjectionQueryTest) {
+    const auto data = shred(records);
+    const auto query = [&](const std::string& expression) {
+        return columnar_lib::evaluate(data, parse(expression, true))
+            ->to_string();
+    };
+    const auto reference = [&](const std::string& expression) {
+        return reference_lib::evaluate(parse(expression, true), parse(records))
+            ->to_string();
+    };
+    for (const auto* expression :
+         { "$[*].id", "$[*].item.name", "$[*].note", "$[*].tags",
+           "$[*].mixed", "$[*].missing", "max($[*].id)", "min($[*].id)",
+           "size($[*].item.rating)", "[max($[*].id), $[*].live]" }) {
+        EXPECT_EQ(query(expression), reference(expression)) << expression;
+    }
+    EXPECT_THROW(query("max($[*].item.name)"), std::invalid_argument);
+}
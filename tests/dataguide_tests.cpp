@@ -0,0 +1,178 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "dataguide.hpp"
+#include "helpers.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+using test_lib::parse;
+
+const std::string document = R"({
+    "name": "shop",
+    "items": [
+        {"id": 1, "rating": 4, "tags": ["a", "b"], "price": 2.5},
+        {"id": 2, "rating": 9, "tags": ["c", "d"]},
+        {"id": 3, "rating": -2, "tags": ["e", "f"], "price": 10}
+    ],
+    "owner": {"name": "Alice", "age": 42},
+    "mixed": [1, "two", null]
+})";
+
+/**
+ * Name of the exception `run` throws, or `"none"`.
+ */
+template <typename Run> std::string outcome(Run run) {
+    try {
+        run();
+    } catch (const std::out_of_range&) {
+        return "out_of_range";
+    } catch (const std::invalid_argument&) {
+        return "invalid_argument";
+    }
+    return "none";
+}
+}
+
+TEST(DataguideTest, BuildTest) {
+    const auto guide = dataguide_lib::dataguide::build(*parse(document));
+    const auto* root = guide.find("$");
+    ASSERT_NE(root, nullptr);
+    EXPECT_TRUE(root->only(json_lib::json_type::object_json));
+    EXPECT_EQ(root->min_size, 4);
+
+    const auto* ids = guide.find(R"($["items"][*]["id"])");
+    ASSERT_NE(ids, nullptr);
+    EXPECT_EQ(ids->count, 3);
+    EXPECT_TRUE(ids->only(json_lib::json_type::integer_json));
+    EXPECT_EQ(ids->min_number, 1);
+    EXPECT_EQ(ids->max_number, 3);
+
+    const auto* prices = guide.find(R"($["items"][*]["price"])");
+    ASSERT_NE(prices, nullptr);
+    EXPECT_EQ(prices->count, 2);
+    EXPECT_EQ(prices->of(json_lib::json_type::real_json), 1);
+    EXPECT_EQ(prices->of(json_lib::json_type::integer_json), 1);
+    EXPECT_EQ(prices->min_number, 2.5);
+    EXPECT_EQ(prices->max_number, 10);
+
+    const auto* tags = guide.find(R"($["items"][*]["tags"])");
+    ASSERT_NE(tags, nullptr);
+    EXPECT_EQ(tags->min_size, 2);
+    EXPECT_EQ(tags->max_size, 2);
+    EXPECT_EQ(guide.find(R"($["items"][*]["tags"][*])")->count, 6);
+
+    const auto* mixed = guide.find(R"($["mixed"][*])");
+    ASSERT_NE(mixed, nullptr);
+    EXPECT_EQ(mixed->of(json_lib::json_type::null_json), 1);
+    EXPECT_FALSE(mixed->only(json_lib::json_type::integer_json));
+    EXPECT_EQ(guide.find(R"($["items"][0])"), nullptr);
+    EXPECT_EQ(guide.paths().size(), 14);
+}
+
+TEST(DataguideTest, PersistTest) {
+    auto guide = dataguide_lib::dataguide::build(*parse(document));
+    guide.set_source({ 12, 34 });
+    const auto decoded = dataguide_lib::dataguide::decode(guide.encode());
+    EXPECT_EQ(decoded.source(), guide.source());
+    ASSERT_EQ(decoded.paths().size(), guide.paths().size());
+    for (const auto& [path, stats] : guide.paths()) {
+        const auto* copy = decoded.find(path);
+        ASSERT_NE(copy, nullptr) << path;
+        EXPECT_EQ(copy->count, stats.count);
+        EXPECT_EQ(copy->types, stats.types);
+        EXPECT_EQ(copy->min_number, stats.min_number);
+        EXPECT_EQ(copy->max_number, stats.max_number);
+        EXPECT_EQ(copy->max_size, stats.max_size);
+    }
+    const std::string bytes = guide.encode();
+    EXPECT_THROW(
+        dataguide_lib::dataguide::decode(bytes.substr(0, bytes.size() - 1)),
+        std::runtime_error
+    );
+    EXPECT_THROW(dataguide_lib::dataguide::decode("JIDX"), std::runtime_error);
+}
+
+TEST(DataguideTest, CheckTest) {
+    const auto base = parse(document);
+    const auto guide = dataguide_lib::dataguide::build(*base);
+    const auto checked = [&](const std::string& expression) {
+        return outcome([&] {
+            dataguide_lib::check(guide, *parse(expression, true));
+        });
+    };
+    const auto evaluated = [&](const std::string& expression) {
+        return outcome([&] {
+            reference_lib::evaluate(parse(expression, true), base);
+        });
+    };
+    for (const auto* expression :
+         { "missing", "name.first", "items.id", "items[3]", "items[0].missing",
+           "items[0].tags[2]", "owner.age[0]", "[1, owner.nickname]",
+           "max(items[1].tags.x)", "items[*].id", "items[0].price.x",
+           "mixed[1].x", "items[5].id", "$[owner.name]", "{\"a\": missing}" }) {
+        const std::string result = checked(expression);
+        if (result != "none") {
+            EXPECT_EQ(result, evaluated(expression)) << expression;
+        }
+    }
+    EXPECT_EQ(checked("missing"), "out_of_range");
+    EXPECT_EQ(checked("name.first"), "invalid_argument");
+    EXPECT_EQ(checked("items[3]"), "out_of_range");
+    EXPECT_EQ(checked("items[0].missing"), "out_of_range");
+    EXPECT_EQ(checked("items[0].tags[2]"), "out_of_range");
+    EXPECT_EQ(checked("[1, owner.nickname]"), "out_of_range");
+    EXPECT_EQ(checked("{\"a\": missing}"), "out_of_range");
+    // Only two of the three items have a price, so `items[1].price` may be
+    // missing while the path exists.
+    EXPECT_EQ(checked("items[1].price"), "none");
+    EXPECT_EQ(checked("mixed[1].x"), "invalid_argument");
+    EXPECT_EQ(checked("owner.name"), "none");
+}
+
+TEST(DataguideTest, AnswerTest) {
+    const auto base = parse(document);
+    const auto guide = dataguide_lib::dataguide::build(*base);
+    for (const auto* expression :
+         { "size(items)", "size(owner)", "size(items[2].tags)",
+           "max(items[*].id)", "min(items[*].rating)", "size($)" }) {
+        const auto answered
+            = dataguide_lib::answer(guide, parse(expression, true));
+        ASSERT_NE(answered, nullptr) << expression;
+        EXPECT_EQ(
+            answered->to_string(),
+            reference_lib::evaluate(parse(expression, true), base)->to_string()
+        ) << expression;
+    }
+    for (const auto* expression :
+         { "items", "size(name)", "max(items[*].price)", "max(mixed)",
+           "min(items[0].tags)", "max(items[*].tags[0])", "size(items, owner)",
+           "max(items[*].missing)" }) {
+        EXPECT_EQ(
+            dataguide_lib::answer(guide, parse(expression, true)), nullptr
+        ) << expression;
+    }
+}
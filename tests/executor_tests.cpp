@@ -0,0 +1,87 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "executor.hpp"
+#include "helpers.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+using test_lib::parse;
+
+TEST(ExecutorTest, ClassifyTest) {
+    for (const auto* expression :
+         { "a.b[1]", "$.a", "$", "size(a.b)", "[a.b, {\"x\": c}]", "42" }) {
+        EXPECT_EQ(
+            executor_lib::classify(*parse(expression, true)),
+            executor_lib::lane::cheap
+        ) << expression;
+    }
+    for (const auto* expression :
+         { "max(a.b)", "a.b[a.c]", "a{.b, .c}", "size(a.b[max(a.b)])",
+           "[1, min(a.b)]" }) {
+        EXPECT_EQ(
+            executor_lib::classify(*parse(expression, true)),
+            executor_lib::lane::expensive
+        ) << expression;
+    }
+}
+
+TEST(ExecutorTest, MixedLoadTest) {
+    const auto document = parse(R"({"a": {"b": [4, 0, 9, 2], "c": 1}})");
+    metrics_lib::registry registry;
+    metrics_lib::active_registry = &registry;
+    {
+        executor_lib::executor executor(document, 3, 1);
+        EXPECT_EQ(executor.threads(), 3);
+        std::vector<std::future<std::shared_ptr<json_lib::json>>> cheap;
+        std::vector<std::future<std::shared_ptr<json_lib::json>>> expensive;
+        for (int i = 0; i < 50; ++i) {
+            expensive.emplace_back(executor.submit("max(a.b)"));
+            cheap.emplace_back(executor.submit("a.b[2]"));
+        }
+        auto failing = executor.submit("a.b[a.c][0]");
+        for (auto& result : cheap) {
+            EXPECT_EQ(result.get()->to_string(), "9");
+        }
+        for (auto& result : expensive) {
+            EXPECT_EQ(result.get()->to_string(), "9");
+        }
+        EXPECT_ANY_THROW(failing.get());
+        EXPECT_EQ(
+            executor.queue_latency(executor_lib::lane::cheap).count(), 50
+        );
+        EXPECT_EQ(
+            executor.queue_latency(executor_lib::lane::expensive).count(), 51
+        );
+    }
+    metrics_lib::active_registry = nullptr;
+    EXPECT_EQ(registry.cheap_queue.count(), 50);
+    EXPECT_EQ(registry.expensive_queue.count(), 51);
+    EXPECT_NE(
+        registry.render().find(
+            "json_eval_queue_seconds_count{lane=\"cheap\"} 50\n"
+        ),
+        std::string::npos
+    );
+}
@@ -0,0 +1,126 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "explain.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+TEST(ExplainTest, BuildPlanTest) {
+    std::shared_ptr<json_lib::json> result;
+    std::string buffer = "a.b[a.b[1]].c";
+    parser_lib::parser p(buffer);
+    p.completely_parse_json(result, true);
+    EXPECT_EQ(
+        explain_lib::render(explain_lib::build_plan(result)),
+        "path $\n"
+        "  step [\"a\"]\n"
+        "  step [\"b\"]\n"
+        "  subscript\n"
+        "    path $\n"
+        "      step [\"a\"]\n"
+        "      step [\"b\"]\n"
+        "      step [1]\n"
+        "  step [\"c\"]\n"
+    );
+
+    buffer = "max(a{.b, .c}, [1, 2, 3][1])";
+    p = parser_lib::parser(buffer);
+    p.completely_parse_json(result, true);
+    EXPECT_EQ(
+        explain_lib::render(explain_lib::build_plan(result)),
+        "function max()\n"
+        "  path $\n"
+        "    step [\"a\"]\n"
+        "    union of 2 branches\n"
+        "      branch\n"
+        "        step [\"b\"]\n"
+        "      branch\n"
+        "        step [\"c\"]\n"
+        "  constant 2\n"
+    );
+
+    buffer = R"({"x": a, "y": [1]})";
+    p = parser_lib::parser(buffer);
+    p.completely_parse_json(result, true);
+    EXPECT_EQ(
+        explain_lib::render(explain_lib::build_plan(result)),
+        "object\n"
+        "  \"x\": path $\n"
+        "    step [\"a\"]\n"
+        "  \"y\": constant [1]\n"
+    );
+
+    buffer = "max(items[*].rating)";
+    p = parser_lib::parser(buffer);
+    p.completely_parse_json(result, true);
+    EXPECT_EQ(
+        explain_lib::render(explain_lib::build_plan(result)),
+        "function max()\n"
+        "  path $\n"
+        "    step [\"items\"]\n"
+        "    each element [*]\n"
+        "      step [\"rating\"]\n"
+    );
+}
+
+TEST(ExplainTest, AnalyzePlanTest) {
+    std::shared_ptr<json_lib::json> base;
+    std::string buffer
+        = R"({"a": { "b": [ 1, 2, { "c": "test" }, [11, 12] ]}})";
+    parser_lib::parser p(buffer);
+    p.completely_parse_json(base);
+
+    std::shared_ptr<json_lib::json> result;
+    buffer = "[a{.b[0], .b[3]}, max(a.b[3]), a.b[a.b[1]].c]";
+    p = parser_lib::parser(buffer);
+    p.completely_parse_json(result, true);
+    const auto plan = explain_lib::build_plan(result);
+
+    reference_lib::evaluation_profile profile;
+    reference_lib::active_profile = &profile;
+    result = reference_lib::evaluate(result, base);
+    reference_lib::active_profile = nullptr;
+    EXPECT_EQ(result->to_string(), "[[1, [11, 12]], 12, \"test\"]");
+
+    ASSERT_EQ(plan.children.size(), 3);
+    const auto* union_step
+        = profile.find(plan.children[0].children[1].step.get());
+    ASSERT_NE(union_step, nullptr);
+    EXPECT_EQ(union_step->calls, 1);
+    EXPECT_EQ(union_step->produced, 2);
+
+    const auto* max_step = profile.find(plan.children[1].step.get());
+    ASSERT_NE(max_step, nullptr);
+    EXPECT_EQ(max_step->visited, 2);
+    EXPECT_EQ(max_step->produced, 1);
+
+    const auto* subscript
+        = profile.find(plan.children[2].children[2].step.get());
+    ASSERT_NE(subscript, nullptr);
+    EXPECT_EQ(subscript->calls, 1);
+    EXPECT_EQ(subscript->produced, 1);
+
+    const std::string rendered = explain_lib::render(plan, &profile);
+    EXPECT_NE(rendered.find("union of 2 branches (calls=1"), std::string::npos);
+    EXPECT_EQ(rendered.find("never executed"), std::string::npos);
+}
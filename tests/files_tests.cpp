@@ -0,0 +1,159 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "files.hpp"
+#include "helpers.hpp"
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+TEST(FilesTest, GlobMatchTest) {
+    EXPECT_TRUE(files_lib::glob_match("*.json", "a.json"));
+    EXPECT_TRUE(files_lib::glob_match("*.json", ".json"));
+    EXPECT_TRUE(files_lib::glob_match("log-??.json", "log-01.json"));
+    EXPECT_TRUE(files_lib::glob_match("*a*b*", "xxaybzz"));
+    EXPECT_TRUE(files_lib::glob_match("*", ""));
+    EXPECT_FALSE(files_lib::glob_match("*.json", "a.json.bak"));
+    EXPECT_FALSE(files_lib::glob_match("log-??.json", "log-1.json"));
+    EXPECT_FALSE(files_lib::glob_match("a*b", "ba"));
+}
+
+TEST(FilesTest, ExpandAndEvaluateTest) {
+    const auto directory = test_lib::temp_path("files_tests");
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "nested");
+    std::ofstream(directory / "b.json") << R"({"id": 2})";
+    std::ofstream(directory / "a.json") << R"({"id": 1})";
+    std::ofstream(directory / "notes.txt") << "not json";
+    std::ofstream(directory / "nested" / "c.json") << R"({"id": 3})";
+    std::ofstream(directory / "nested" / "broken.json") << R"({"id": )";
+
+    EXPECT_TRUE(files_lib::is_collection(directory));
+    EXPECT_TRUE(files_lib::is_collection(directory / "*.json"));
+    EXPECT_FALSE(files_lib::is_collection(directory / "a.json"));
+
+    const auto files = files_lib::expand(
+        { directory / "*.json", directory / "nested", directory / "x.json" }
+    );
+    const std::vector<std::filesystem::path> expected {
+        directory / "a.json", directory / "b.json",
+        directory / "nested" / "broken.json", directory / "nested" / "c.json",
+        directory / "x.json"
+    };
+    EXPECT_EQ(files, expected);
+
+    std::ostringstream out;
+    EXPECT_EQ(files_lib::evaluate_files(files, "id", 3, out), 2);
+    EXPECT_EQ(
+        out.str(),
+        (directory / "a.json").string() + "\t1\n"
+            + (directory / "b.json").string() + "\t2\n"
+            + (directory / "nested" / "c.json").string() + "\t3\n"
+    );
+    std::filesystem::remove_all(directory);
+}
+
+TEST(FilesTest, FindTest) {
+    const auto directory = test_lib::temp_path("find_tests");
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::ofstream(directory / "a.json") << R"({"user": {"name": "Alice"}})";
+    std::ofstream(directory / "b.json") << R"({"user": {"name": "Bob"}})";
+    std::ofstream(directory / "c.json") << R"([{"id": 3, "tags": ["Bob"]}])";
+    std::ofstream(directory / "d.json") << R"({"id": )";
+    const auto files = files_lib::expand({ directory });
+    const auto path = [&](const std::string& name) {
+        return (directory / name).string() + '\n';
+    };
+
+    bloom_lib::catalog summaries;
+    std::ostringstream out;
+    auto stats = files_lib::find_files(
+        files, { bloom_lib::target::value, "Bob" }, summaries, 2, out
+    );
+    EXPECT_EQ(out.str(), path("b.json") + path("c.json"));
+    EXPECT_EQ(stats.parsed, 3);
+    EXPECT_EQ(stats.skipped, 0);
+    EXPECT_EQ(stats.matched, 2);
+    EXPECT_EQ(stats.failed, 1);
+    EXPECT_EQ(summaries.size(), 3);
+
+    // Rewrite a.json with the same size and time: only a file that is
+    // never opened keeps pretending to be valid.
+    const auto modified
+        = std::filesystem::last_write_time(directory / "a.json");
+    std::ofstream(directory / "a.json") << R"({"user": {"name": "Alice"]])";
+    std::filesystem::last_write_time(directory / "a.json", modified);
+
+    out.str("");
+    stats = files_lib::find_files(
+        files, { bloom_lib::target::key, "id" }, summaries, 2, out
+    );
+    EXPECT_EQ(out.str(), path("c.json"));
+    EXPECT_EQ(stats.skipped, 2);
+    EXPECT_EQ(stats.parsed, 1);
+    EXPECT_EQ(stats.failed, 1);
+
+    // Modified files are parsed and summarized again.
+    std::ofstream(directory / "b.json") << R"({"id": 2})";
+    out.str("");
+    stats = files_lib::find_files(
+        files, { bloom_lib::target::key, "id" }, summaries, 1, out
+    );
+    EXPECT_EQ(out.str(), path("b.json") + path("c.json"));
+    EXPECT_EQ(stats.skipped, 1);
+    EXPECT_EQ(stats.parsed, 2);
+    std::filesystem::remove_all(directory);
+}
+
+TEST(FilesTest, FormatTest) {
+    const auto directory = test_lib::temp_path("format_tests");
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    // {"id": 5} in MessagePack.
+    std::ofstream(directory / "m.msgpack", std::ios::binary)
+        << "\x81\xa2id\x05";
+    std::ofstream(directory / "x.json") << R"({"id": 6})";
+    const std::vector<std::filesystem::path> files {
+        directory / "m.msgpack", directory / "x.json"
+    };
+
+    std::ostringstream out;
+    EXPECT_EQ(files_lib::evaluate_files(files, "id", 2, out), 0);
+    EXPECT_EQ(
+        out.str(),
+        files[0].string() + "\t5\n" + files[1].string() + "\t6\n"
+    );
+
+    out.str("");
+    EXPECT_EQ(
+        files_lib::evaluate_files(
+            files, "id", 2, out, nullptr, files_lib::file_format::json
+        ),
+        1
+    );
+    EXPECT_EQ(out.str(), files[1].string() + "\t6\n");
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,160 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "governor.hpp"
+#include "helpers.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace {
+using test_lib::parse;
+
+std::string limit_of(const std::function<void()>& action) {
+    try {
+        action();
+    } catch (const governor_lib::limit_exceeded& e) {
+        return e.resource();
+    }
+    return "";
+}
+}
+
+TEST(GovernorTest, LimitsTest) {
+    governor_lib::limits limits;
+    EXPECT_TRUE(limits.unlimited());
+    limits.max_time = std::chrono::milliseconds(5);
+    EXPECT_FALSE(limits.unlimited());
+
+    EXPECT_NO_THROW(governor_lib::check("max_depth", 100, 0));
+    EXPECT_NO_THROW(governor_lib::check("max_depth", 3, 3));
+    try {
+        governor_lib::check("max_depth", 4, 3);
+        FAIL() << "expected limit_exceeded";
+    } catch (const governor_lib::limit_exceeded& e) {
+        EXPECT_EQ(e.resource(), "max_depth");
+        EXPECT_EQ(e.limit(), 3);
+        EXPECT_STREQ(e.what(), "limit exceeded: max_depth of 3");
+    }
+}
+
+TEST(GovernorTest, ParserLimitsTest) {
+    const std::string nested = R"({"a": [[[1, 2], [3]], {"b": null}]})";
+    const size_t usage = parse(nested)->memory_usage();
+    governor_lib::limits limits;
+    governor_lib::active_limits = &limits;
+
+    limits.max_depth = 3;
+    EXPECT_EQ(limit_of([&] { parse(nested); }), "max_depth");
+    limits.max_depth = 4;
+    EXPECT_EQ(limit_of([&] { parse(nested); }), "");
+    EXPECT_EQ(limit_of([&] { parse("a[a[a[a[a[0]]]]]", true); }), "max_depth");
+
+    limits = { .max_nodes = 9 };
+    EXPECT_EQ(limit_of([&] { parse(nested); }), "max_nodes");
+    limits.max_nodes = 10;
+    EXPECT_EQ(limit_of([&] { parse(nested); }), "");
+
+    limits = { .max_input_bytes = nested.size() - 1 };
+    EXPECT_EQ(limit_of([&] { parse(nested); }), "max_input_bytes");
+
+    limits = { .max_memory = usage - 1 };
+    EXPECT_EQ(limit_of([&] { parse(nested); }), "max_memory");
+    limits.max_memory = usage;
+    EXPECT_EQ(limit_of([&] { parse(nested); }), "");
+
+    governor_lib::active_limits = nullptr;
+    limits = { .max_depth = 1, .max_nodes = 1 };
+    EXPECT_EQ(limit_of([&] { parse(nested); }), "");
+}
+
+TEST(GovernorTest, EvaluationLimitsTest) {
+    const auto base = parse(R"({"a": {"b": [5, 1, 9, 3]}})");
+    governor_lib::limits limits { .max_steps = 4 };
+    governor_lib::active_limits = &limits;
+    EXPECT_EQ(
+        reference_lib::evaluate(parse("a.b[2]", true), base)->to_string(), "9"
+    );
+    EXPECT_EQ(
+        limit_of([&] {
+            reference_lib::evaluate(parse("max(a.b)", true), base);
+        }),
+        "max_steps"
+    );
+    limits.max_steps = 10;
+    EXPECT_EQ(
+        reference_lib::evaluate(parse("max(a.b)", true), base)->to_string(),
+        "9"
+    );
+    governor_lib::active_limits = nullptr;
+}
+
+TEST(GovernorTest, CancellationTokenTest) {
+    const std::string document = R"({"a": [1, 2, 3], "b": {"c": null}})";
+    governor_lib::cancellation_token token;
+    {
+        const governor_lib::token_scope scope(token);
+        EXPECT_NO_THROW(parse(document));
+        token.cancel();
+        EXPECT_THROW(parse(document), governor_lib::operation_cancelled);
+    }
+    EXPECT_EQ(governor_lib::active_token, nullptr);
+    EXPECT_NO_THROW(parse(document));
+
+    governor_lib::cancellation_token expired;
+    expired.cancel_after(std::chrono::nanoseconds(0));
+    const governor_lib::token_scope scope(expired);
+    try {
+        parse(document);
+        FAIL() << "expected operation_cancelled";
+    } catch (const governor_lib::operation_cancelled& e) {
+        EXPECT_TRUE(e.deadline_exceeded());
+    }
+}
+
+TEST(GovernorTest, CancelFromOtherThreadTest) {
+    const auto base = parse(R"({"a": [5, 1, 9, 3]})");
+    governor_lib::cancellation_token token;
+    std::atomic<size_t> evaluations = 0;
+    bool cancelled = false;
+    std::thread worker([&] {
+        const governor_lib::token_scope scope(token);
+        try {
+            for (;;) {
+                reference_lib::evaluate(parse("max(a)", true), base);
+                ++evaluations;
+            }
+        } catch (const governor_lib::operation_cancelled& e) {
+            cancelled = !e.deadline_exceeded();
+        }
+    });
+    while (evaluations == 0) {
+        std::this_thread::yield();
+    }
+    token.cancel();
+    worker.join();
+    EXPECT_TRUE(cancelled);
+}
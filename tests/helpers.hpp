@@ -0,0 +1,68 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TEST_HELPERS_HPP
+#define TEST_HELPERS_HPP
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+/**
+ * @brief Helpers shared by the unit tests.
+ */
+namespace test_lib {
+/**
+ * @brief Parse `text` as a document or, if `dynamic`, as an expression.
+ */
+inline std::shared_ptr<json_lib::json>
+parse(std::string text, const bool dynamic = false) {
+    std::shared_ptr<json_lib::json> result;
+    parser_lib::parser(text).completely_parse_json(result, dynamic);
+    return result;
+}
+
+/**
+ * @brief A path in the temporary directory named after the running test
+ * and process, so that tests run concurrently never share files.
+ *
+ * @param name Suffix of the file or directory name, e.g. `"test.jbin"`.
+ */
+inline std::filesystem::path temp_path(const std::string_view name) {
+    const auto* info = testing::UnitTest::GetInstance()->current_test_info();
+    std::string unique = std::to_string(getpid());
+    if (info != nullptr) {
+        unique = std::string(info->test_suite_name()) + '.' + info->name()
+            + '.' + unique;
+    }
+    return std::filesystem::temp_directory_path()
+        / (unique + '.' + std::string(name));
+}
+}
+
+#endif // TEST_HELPERS_HPP
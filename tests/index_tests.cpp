@@ -0,0 +1,161 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "helpers.hpp"
+#include "index.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+namespace {
+using test_lib::parse;
+
+const std::string document = R"({"name": "idx", "zeta": -7, "pi": 3.25,
+    "flags": [true, false, null], "nested": {"b": [1, [2, 22], 3],
+    "a": {"k": "v"}}, "esc\"aped": "q\"uote", "empty": []})";
+}
+
+TEST(IndexTest, StructureTest) {
+    const std::string bytes = index_lib::encode(document, 2, { 10, 20 });
+    const index_lib::structural_index index(bytes);
+    EXPECT_EQ(index.source(), (index_lib::stamp { 10, 20 }));
+    EXPECT_EQ(index.max_depth(), 2);
+
+    const auto root = index.root();
+    EXPECT_EQ(root.begin, 0);
+    EXPECT_EQ(root.end, document.size());
+    EXPECT_EQ(index.type(root), json_lib::json_type::object_json);
+    EXPECT_EQ(index.size(root), 7);
+
+    const auto text = [&](const index_lib::span& value) {
+        return document.substr(value.begin, value.end - value.begin);
+    };
+    EXPECT_EQ(text(*index.member(root, "pi")), "3.25");
+    EXPECT_EQ(text(*index.member(root, "esc\"aped")), "\"q\\\"uote\"");
+    EXPECT_FALSE(index.member(root, "missing").has_value());
+
+    const auto flags = *index.member(root, "flags");
+    EXPECT_EQ(index.type(flags), json_lib::json_type::array_json);
+    EXPECT_EQ(text(*index.element(flags, 2)), "null");
+    EXPECT_FALSE(index.element(flags, 3).has_value());
+    EXPECT_EQ(index.size(*index.member(root, "empty")), 0);
+
+    // The third level is beyond the depth limit and only has a range.
+    const auto nested = *index.member(root, "nested");
+    const auto b = *index.member(nested, "b");
+    EXPECT_EQ(text(b), "[1, [2, 22], 3]");
+    EXPECT_EQ(b.record, 0);
+    EXPECT_EQ(index.type(b), json_lib::json_type::null_json);
+    EXPECT_FALSE(index.element(b, 0).has_value());
+
+    const std::string scalar = index_lib::encode(" 42 ", 3);
+    const index_lib::structural_index top(scalar);
+    EXPECT_EQ(top.root().begin, 1);
+    EXPECT_EQ(top.root().end, 3);
+    EXPECT_EQ(top.root().record, 0);
+}
+
+TEST(IndexTest, ScanTest) {
+    // Brackets and quotes inside strings, escaped backslashes and long runs
+    // without structural characters, all below the indexed depth.
+    const std::string text = R"([{"s": "]}[{\\", "t": ["a\"]", "\\\""]},
+        {"long": "abcdefghijklmnopqrstuvwxyz0123456789", "n": [[[]]]}, 7])";
+    const std::string bytes = index_lib::encode(text, 1);
+    const index_lib::structural_index index(bytes);
+    EXPECT_EQ(index.size(index.root()), 3);
+    const auto text_of = [&](const size_t i) {
+        const auto value = *index.element(index.root(), i);
+        return text.substr(value.begin, value.end - value.begin);
+    };
+    EXPECT_EQ(text_of(0), R"({"s": "]}[{\\", "t": ["a\"]", "\\\""]})");
+    EXPECT_EQ(
+        text_of(1),
+        R"({"long": "abcdefghijklmnopqrstuvwxyz0123456789", "n": [[[]]]})"
+    );
+    EXPECT_EQ(text_of(2), "7");
+}
+
+TEST(IndexTest, InvalidIndexTest) {
+    for (const auto* text :
+         { "", "[1, 2", "{\"a\" 1}", "[1,]", "{\"a\": 1} x", "\"open" }) {
+        EXPECT_THROW(index_lib::encode(text, 4), std::runtime_error) << text;
+    }
+    EXPECT_THROW(
+        index_lib::encode(R"({"a": 1, "a": 2})", 1), std::invalid_argument
+    );
+    EXPECT_NO_THROW(index_lib::encode(R"([{"a": 1, "a": 2}])", 1));
+
+    const std::string bytes = index_lib::encode(document, 2);
+    const std::string header = "JIDX";
+    EXPECT_THROW(index_lib::structural_index { header }, std::runtime_error);
+    std::string damaged = bytes;
+    damaged[4] = '\x7F';
+    EXPECT_THROW(index_lib::structural_index { damaged }, std::runtime_error);
+}
+
+TEST(IndexTest, EvaluateTest) {
+    const auto input = test_lib::temp_path("index.json");
+    std::ofstream(input) << document;
+    index_lib::build(input, 2);
+    const index_lib::structural_index index(index_lib::sidecar_path(input));
+    EXPECT_EQ(index.source(), index_lib::stamp::of(input));
+
+    const auto query = [&](const std::string& expression) {
+        return index_lib::evaluate(index, document, parse(expression, true))
+            ->to_string();
+    };
+    const auto reference = [&](const std::string& expression) {
+        return reference_lib::evaluate(parse(expression, true), parse(document))
+            ->to_string();
+    };
+    for (const auto* expression :
+         { "nested.b[1][0]", "$.nested.a", "$", "flags[2]", "max(nested.b[1])",
+           "size(flags)", "[zeta, nested.a.k]", "{\"x\": pi}",
+           "nested.b[nested.b[0]]", "nested{.b, .a}" }) {
+        EXPECT_EQ(query(expression), reference(expression)) << expression;
+    }
+    EXPECT_THROW(query("nested.c"), std::out_of_range);
+    EXPECT_THROW(query("flags[5]"), std::out_of_range);
+    EXPECT_THROW(query("zeta.x"), std::invalid_argument);
+    EXPECT_THROW(query("nested[0]"), std::invalid_argument);
+    EXPECT_THROW(query("flags[-1]"), std::out_of_range);
+
+    // `size()` of an indexed container is answered without reading the text.
+    const std::string blank(document.size(), ' ');
+    const auto size = [&](const std::string& expression) {
+        return index_lib::evaluate(index, blank, parse(expression, true))
+            ->to_string();
+    };
+    EXPECT_EQ(size("size(flags)"), "3");
+    EXPECT_EQ(size("size($)"), "7");
+    EXPECT_EQ(size("[size(nested), size(empty)]"), "[2, 0]");
+    EXPECT_EQ(query("size(nested.b)"), "3");
+
+    std::ofstream(input, std::ios::app) << ' ';
+    EXPECT_NE(index.source(), index_lib::stamp::of(input));
+    std::filesystem::remove(input);
+    std::filesystem::remove(index_lib::sidecar_path(input));
+}
@@ -87,6 +87,8 @@ TEST(JsonTest, BooleanJsonTest) {
     EXPECT_EQ(obj_false->indented_string(2, true), "false");
     EXPECT_EQ(obj_true->formatted_string(true), "true");
     EXPECT_EQ(obj_false->formatted_string(true), "false");
+    EXPECT_TRUE(obj_true->as_bool());
+    EXPECT_FALSE(obj_false->as_bool());
 }
 
 TEST(JsonTest, IntegerJsonTest) {
@@ -583,4 +585,42 @@ TEST(JsonTest, JsonByJsonTest) {
     EXPECT_THROW(res = json_bool->by(json_int), std::invalid_argument);
     EXPECT_EQ(null_res, nullptr);
     json_lib::enable_symmetric_indexing = enable_symmetric_indexing_copy;
+}
+
+TEST(JsonTest, MemoryUsageJsonTest) {
+    const auto integer = std::make_shared<json_lib::json_integer>(1);
+    EXPECT_GE(integer->memory_usage(), sizeof(json_lib::json_integer));
+
+    const auto short_string = std::make_shared<json_lib::json_string>("a");
+    const auto long_string
+        = std::make_shared<json_lib::json_string>(std::string(100, 'a'));
+    EXPECT_GE(
+        long_string->memory_usage(), short_string->memory_usage() + 100
+    );
+
+    std::vector<std::shared_ptr<json_lib::json>> values;
+    values.reserve(10);
+    values.emplace_back(integer);
+    values.emplace_back(long_string);
+    const auto arr = std::make_shared<json_lib::json_array>(values);
+    EXPECT_GE(
+        arr->memory_usage(),
+        integer->memory_usage() + long_string->memory_usage()
+            + 2 * sizeof(std::shared_ptr<json_lib::json>)
+    );
+
+    const auto obj = std::make_shared<json_lib::json_object>(
+        std::vector<std::pair<std::string, std::shared_ptr<json_lib::json>>> {
+            { "first", arr }, { "second", arr } }
+    );
+    EXPECT_GT(obj->memory_usage(), arr->memory_usage());
+
+    const auto copy = std::make_shared<json_lib::json_array>(values);
+    const auto distinct = std::make_shared<json_lib::json_object>(
+        std::vector<std::pair<std::string, std::shared_ptr<json_lib::json>>> {
+            { "first", arr }, { "second", copy } }
+    );
+    EXPECT_EQ(
+        distinct->memory_usage() - obj->memory_usage(), copy->memory_usage()
+    );
 }
\ No newline at end of file
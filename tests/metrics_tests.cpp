@@ -0,0 +1,124 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "helpers.hpp"
+#include "metrics.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+TEST(MetricsTest, HistogramBucketsTest) {
+    for (uint64_t value = 0; value < 100000; value += 7) {
+        const size_t index = metrics_lib::histogram::index_of(value);
+        EXPECT_LE(metrics_lib::histogram::lowest_of(index), value);
+        EXPECT_GE(metrics_lib::histogram::highest_of(index), value);
+    }
+    const uint64_t largest = std::numeric_limits<uint64_t>::max();
+    EXPECT_EQ(
+        metrics_lib::histogram::index_of(largest),
+        metrics_lib::histogram::bucket_count - 1
+    );
+    EXPECT_EQ(
+        metrics_lib::histogram::highest_of(
+            metrics_lib::histogram::bucket_count - 1
+        ),
+        largest
+    );
+    for (size_t index = 1; index < metrics_lib::histogram::bucket_count;
+         ++index) {
+        EXPECT_EQ(
+            metrics_lib::histogram::lowest_of(index),
+            metrics_lib::histogram::highest_of(index - 1) + 1
+        );
+    }
+}
+
+TEST(MetricsTest, HistogramPercentileTest) {
+    metrics_lib::histogram histogram;
+    EXPECT_EQ(histogram.percentile(50).count(), 0);
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.record(std::chrono::microseconds(i));
+    }
+    EXPECT_EQ(histogram.count(), 1000);
+    EXPECT_EQ(histogram.sum(), std::chrono::microseconds(500500));
+    const auto median = static_cast<double>(histogram.percentile(50).count());
+    EXPECT_NEAR(median, 500000.0, 500000.0 * 0.07);
+    const auto p99 = static_cast<double>(histogram.percentile(99).count());
+    EXPECT_NEAR(p99, 990000.0, 990000.0 * 0.07);
+    EXPECT_GE(histogram.percentile(100), std::chrono::microseconds(1000));
+    EXPECT_EQ(histogram.count_below(std::chrono::nanoseconds(999)), 0);
+    EXPECT_EQ(histogram.count_below(std::chrono::seconds(1)), 1000);
+}
+
+TEST(MetricsTest, RegistryTest) {
+    metrics_lib::registry registry;
+    metrics_lib::active_registry = &registry;
+    std::shared_ptr<json_lib::json> base;
+    std::string document = R"({"a": [1, 2, 3]})";
+    const size_t document_size = document.size();
+    parser_lib::parser(document).completely_parse_json(base);
+    std::shared_ptr<json_lib::json> expression;
+    std::string text = "a[1]";
+    parser_lib::parser(text).completely_parse_json(expression, true);
+    EXPECT_EQ(reference_lib::evaluate(expression, base)->to_string(), "2");
+    std::string broken = "[1, 2";
+    std::shared_ptr<json_lib::json> failed;
+    EXPECT_ANY_THROW(parser_lib::parser(broken).completely_parse_json(failed));
+    metrics_lib::active_registry = nullptr;
+
+    EXPECT_EQ(registry.parse.count(), 1);
+    EXPECT_EQ(registry.compile.count(), 1);
+    EXPECT_EQ(registry.evaluate.count(), 1);
+    EXPECT_EQ(registry.documents_loaded.value(), 1);
+    EXPECT_EQ(registry.bytes_parsed.value(), document_size);
+    EXPECT_EQ(registry.errors.value(), 1);
+
+    const std::string text_format = registry.render();
+    EXPECT_NE(
+        text_format.find("# TYPE json_eval_parse_seconds histogram\n"),
+        std::string::npos
+    );
+    EXPECT_NE(
+        text_format.find("json_eval_evaluate_seconds_bucket{le=\"+Inf\"} 1\n"),
+        std::string::npos
+    );
+    EXPECT_NE(
+        text_format.find("json_eval_errors_total 1\n"), std::string::npos
+    );
+    EXPECT_NE(
+        text_format.find("json_eval_documents_loaded_total 1\n"),
+        std::string::npos
+    );
+
+    const auto path = test_lib::temp_path("json_eval_metrics_test.prom");
+    registry.write_file(path);
+    std::ifstream ifs(path);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    EXPECT_EQ(ss.str(), text_format);
+    std::filesystem::remove(path);
+}
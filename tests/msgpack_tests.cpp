@@ -0,0 +1,114 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "helpers.hpp"
+#include "msgpack.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+using test_lib::parse;
+
+std::string bytes(const std::initializer_list<int> values) {
+    std::string result;
+    for (const int value : values) {
+        result += static_cast<char>(value);
+    }
+    return result;
+}
+}
+
+TEST(MsgpackTest, RoundTripTest) {
+    const std::string long_text(300, 'x');
+    std::string items;
+    for (int i = 0; i < 20; ++i) {
+        items += std::to_string(i * 1000 - 9000) + ", ";
+    }
+    const auto document = parse(
+        R"({"name": "msgpack", "small": [0, 127, -32, -33, 128, -129, 65536],
+        "big": [2147483647, -2147483648], "pi": 3.25, "e": 1500000000.25,
+        "flags": [true, false, null], "nested": {"a": {"k": "v"}},
+        "escaped": "q\"uote\n", "long": ")"
+        + long_text + R"(", "many": [)" + items + R"(0], "empty": {}})"
+    );
+    const std::string encoded = msgpack_lib::encode(*document);
+    EXPECT_EQ(msgpack_lib::decode(encoded)->to_string(), document->to_string());
+}
+
+TEST(MsgpackTest, EncodingTest) {
+    EXPECT_EQ(
+        msgpack_lib::encode(*parse(R"({"a": [1, -1, null, true]})")),
+        bytes({ 0x81, 0xA1, 'a', 0x94, 0x01, 0xFF, 0xC0, 0xC3 })
+    );
+    EXPECT_EQ(msgpack_lib::encode(*parse("200")), bytes({ 0xCC, 0xC8 }));
+    EXPECT_EQ(msgpack_lib::encode(*parse("-200")), bytes({ 0xD1, 0xFF, 0x38 }));
+    EXPECT_EQ(
+        msgpack_lib::encode(*parse("1.5")),
+        bytes({ 0xCB, 0x3F, 0xF8, 0, 0, 0, 0, 0, 0 })
+    );
+    EXPECT_THROW(
+        msgpack_lib::encode(*parse("a.b", true)), std::invalid_argument
+    );
+}
+
+TEST(MsgpackTest, DecodeTest) {
+    const auto decode = [](const std::string& input) {
+        return msgpack_lib::decode(input)->to_string();
+    };
+    EXPECT_EQ(decode(bytes({ 0xCD, 0x01, 0x00 })), "256");
+    EXPECT_EQ(decode(bytes({ 0xD3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                             0xFF, 0xFE })),
+              "-2");
+    EXPECT_EQ(decode(bytes({ 0xCA, 0x3F, 0xC0, 0, 0 })), "1.5");
+    EXPECT_EQ(decode(bytes({ 0xCB, 0x40, 0x08, 0, 0, 0, 0, 0, 0 })), "3.0");
+    EXPECT_EQ(decode(bytes({ 0xD9, 0x02, 'h', 'i' })), "\"hi\"");
+    EXPECT_EQ(decode(bytes({ 0xDC, 0x00, 0x02, 0xC2, 0xC0 })), "[false, null]");
+    EXPECT_EQ(
+        decode(bytes({ 0xDE, 0x00, 0x01, 0xD9, 0x01, 'k', 0x07 })),
+        "{\"k\": 7}"
+    );
+
+    for (const auto& input :
+         { bytes({}), bytes({ 0x92, 0x01 }), bytes({ 0xA3, 'a' }),
+           bytes({ 0x01, 0x02 }), bytes({ 0xC4, 0x01, 0x00 }),
+           bytes({ 0xD4, 0x01, 0x00 }), bytes({ 0x81, 0x01, 0x02 }),
+           bytes({ 0xCB, 0x7F, 0xF0, 0, 0, 0, 0, 0, 0 }),
+           bytes({ 0xDD, 0xFF, 0xFF, 0xFF, 0xFF }) }) {
+        EXPECT_THROW(msgpack_lib::decode(input), std::runtime_error);
+    }
+    EXPECT_THROW(
+        msgpack_lib::decode(bytes({ 0xCE, 0x80, 0, 0, 0 })), std::out_of_range
+    );
+    EXPECT_THROW(
+        msgpack_lib::decode(bytes({ 0x82, 0xA1, 'a', 1, 0xA1, 'a', 2 })),
+        std::invalid_argument
+    );
+}
+
+TEST(MsgpackTest, ExtensionTest) {
+    EXPECT_TRUE(msgpack_lib::has_extension("data/log.msgpack"));
+    EXPECT_TRUE(msgpack_lib::has_extension("log.mpk"));
+    EXPECT_FALSE(msgpack_lib::has_extension("log.json"));
+    EXPECT_FALSE(msgpack_lib::has_extension("msgpack"));
+}
@@ -0,0 +1,116 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "helpers.hpp"
+#include "parallel.hpp"
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+TEST(ParallelTest, SplitLinesTest) {
+    const std::string text
+        = "{\"a\": 1}\n{\"a\": 2}\n\n{\"a\": 3}\n{\"a\": 4}\n";
+    const auto partition = parallel_lib::split(text, 3);
+    EXPECT_EQ(partition.layout, parallel_lib::input_layout::lines);
+    ASSERT_FALSE(partition.ranges.empty());
+    EXPECT_LE(partition.ranges.size(), 3);
+    EXPECT_EQ(partition.ranges.front().first, 0);
+    EXPECT_EQ(partition.ranges.back().second, text.size());
+    std::string results;
+    for (size_t i = 0; i < partition.ranges.size(); ++i) {
+        const auto [begin, end] = partition.ranges[i];
+        EXPECT_TRUE(begin == 0 || text[begin - 1] == '\n');
+        if (i > 0) {
+            EXPECT_EQ(partition.ranges[i - 1].second, begin);
+        }
+        results += parallel_lib::evaluate_range(
+            text, partition.layout, partition.ranges[i], "a"
+        );
+    }
+    EXPECT_EQ(results, "1\n2\n3\n4\n");
+}
+
+TEST(ParallelTest, SplitArrayTest) {
+    const std::string text
+        = R"( [{"a": [1, 2]}, {"a": "x,]"}, {"a": 3}, {"a": [4]}] )";
+    const auto partition = parallel_lib::split(text, 4);
+    EXPECT_EQ(partition.layout, parallel_lib::input_layout::array);
+    EXPECT_GE(partition.ranges.size(), 2);
+    std::string results;
+    for (const auto& range : partition.ranges) {
+        results += parallel_lib::evaluate_range(
+            text, partition.layout, range, "a"
+        );
+    }
+    EXPECT_EQ(results, "[1, 2]\n\"x,]\"\n3\n[4]\n");
+
+    std::vector<std::string> emitted;
+    parallel_lib::evaluate_range(
+        text, partition.layout, { partition.ranges.front().first,
+                                  partition.ranges.back().second },
+        "a", [&](const std::string_view result) {
+            emitted.emplace_back(result);
+        }
+    );
+    EXPECT_EQ(
+        emitted,
+        (std::vector<std::string> { "[1, 2]\n", "\"x,]\"\n", "3\n", "[4]\n" })
+    );
+
+    const auto whole = parallel_lib::split(R"({"a": [1, 2]})", 4);
+    EXPECT_EQ(whole.layout, parallel_lib::input_layout::single);
+    ASSERT_EQ(whole.ranges.size(), 1);
+    EXPECT_EQ(
+        parallel_lib::evaluate_range(
+            R"({"a": [1, 2]})", whole.layout, whole.ranges[0], "a[1]"
+        ),
+        "2\n"
+    );
+    EXPECT_THROW(parallel_lib::split("[1, 2", 2), std::runtime_error);
+    EXPECT_TRUE(parallel_lib::split("  ", 2).ranges.empty());
+}
+
+TEST(ParallelTest, ForkedRunTest) {
+    const auto path = test_lib::temp_path("parallel_test.json");
+    std::string expected;
+    {
+        std::ofstream ofs(path);
+        for (int i = 0; i < 1000; ++i) {
+            ofs << R"({"id": )" << i << R"(, "tags": ["t)" << i << "\"]}\n";
+            expected += "\"t" + std::to_string(i) + "\"\n";
+        }
+    }
+    std::ostringstream out;
+    EXPECT_EQ(parallel_lib::run(path, "tags[0]", 4, out), 0);
+    EXPECT_EQ(out.str(), expected);
+
+    {
+        std::ofstream ofs(path);
+        ofs << "[1, {\"tags\": [2]}]";
+    }
+    std::ostringstream failed;
+    EXPECT_EQ(parallel_lib::run(path, "tags[0]", 2, failed), 1);
+    std::filesystem::remove(path);
+}
@@ -396,4 +396,59 @@ TEST(PathTest, FunctionsEvalJsonTest) {
     );
     result->set_root(base);
     EXPECT_EQ(result->to_string(), "[2, 4, 1, 4, 2, 11, 4]");
-}
\ No newline at end of file
+}
+
+TEST(PathTest, EvaluateJsonTest) {
+    std::shared_ptr<json_lib::json> base;
+    std::string buffer
+        = R"({"a": { "b": [ 1, 2, { "c": "test" }, [11, 12] ]}})";
+    parser_lib::parser prs(buffer);
+    prs.completely_parse_json(base);
+
+    std::shared_ptr<json_lib::json> result;
+    buffer = "max(a.b[0], a.b[1])";
+    prs = parser_lib::parser(buffer);
+    prs.completely_parse_json(result, true);
+    EXPECT_EQ(reference_lib::evaluate(result, base)->to_string(), "2");
+
+    buffer = "size(a.b)";
+    prs = parser_lib::parser(buffer);
+    prs.completely_parse_json(result, true);
+    EXPECT_EQ(reference_lib::evaluate(result, base)->to_string(), "4");
+
+    buffer = "a.b[a.b[1]].c";
+    prs = parser_lib::parser(buffer);
+    prs.completely_parse_json(result, true);
+    EXPECT_EQ(reference_lib::evaluate(result, base)->to_string(), "\"test\"");
+
+    buffer = "[1, 2]";
+    prs = parser_lib::parser(buffer);
+    prs.completely_parse_json(result, true);
+    EXPECT_EQ(reference_lib::evaluate(result, base)->to_string(), "[1, 2]");
+}
+
+TEST(PathTest, MemsizeEvalJsonTest) {
+    std::shared_ptr<json_lib::json> base;
+    std::string buffer
+        = R"({"a": { "b": [ 1, 2, { "c": "test" }, [11, 12] ]}})";
+    parser_lib::parser prs(buffer);
+    prs.completely_parse_json(base);
+    const auto a
+        = std::dynamic_pointer_cast<json_lib::json_object>(base)->at("a");
+
+    std::shared_ptr<json_lib::json> result;
+    buffer = "[memsize($), memsize(a), memsize(a.b[0])]";
+    prs = parser_lib::parser(buffer);
+    prs.completely_parse_json(result, true);
+    result = reference_lib::evaluate(result, base);
+    EXPECT_EQ(
+        result->to_string(),
+        "[" + std::to_string(base->memory_usage()) + ", "
+            + std::to_string(a->memory_usage()) + ", "
+            + std::to_string(sizeof(json_lib::json_integer) + 16) + "]"
+    );
+
+    buffer = "memsize(1, 2)";
+    prs = parser_lib::parser(buffer);
+    EXPECT_THROW(prs.completely_parse_json(result, true), std::invalid_argument);
+}
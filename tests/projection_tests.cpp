@@ -0,0 +1,148 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "helpers.hpp"
+#include "parser.hpp"
+#include "projection.hpp"
+#include "reference.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+using test_lib::parse;
+
+std::string query(
+    const std::string& expression, const std::shared_ptr<json_lib::json>& root
+) {
+    return reference_lib::evaluate(parse(expression, true), root)
+        ->to_string();
+}
+
+const std::string document = R"({"items": [
+    {"item": {"name": "a"}, "rating": 3, "tags": [1, 2]},
+    {"item": {"name": "b"}, "rating": 5, "tags": []},
+    {"item": "plain", "tags": [7]},
+    {"rating": 1, "tags": [4, 5, 6]},
+    12
+]})";
+
+class ProjectionCacheTest : public testing::Test {
+protected:
+    void TearDown() override { projection_lib::active_cache = nullptr; }
+};
+}
+
+TEST(ProjectionTest, ParseTest) {
+    EXPECT_EQ(
+        parse("items[*].item.name", true)->to_string(),
+        R"($["items"][*]["item"]["name"])"
+    );
+    EXPECT_EQ(parse("$[ * ][0]", true)->to_string(), "$[*][0]");
+    EXPECT_EQ(
+        parse("max(a[*].b[*].c)", true)->to_string(),
+        R"(max($["a"][*]["b"][*]["c"]))"
+    );
+    EXPECT_THROW(parse("a[*]{.x}", true), std::invalid_argument);
+    EXPECT_THROW(parse("a[*].b[@.c]", true), std::invalid_argument);
+    EXPECT_THROW(parse("a[*", true), std::runtime_error);
+}
+
+TEST(ProjectionTest, GatherTest) {
+    const auto root = parse(document);
+    EXPECT_EQ(query("items[*].item.name", root), R"(["a", "b"])");
+    EXPECT_EQ(query("items[*].rating", root), "[3, 5, 1]");
+    EXPECT_EQ(query("items[*].tags[1]", root), "[2, 5]");
+    EXPECT_EQ(query("items[*].tags[*]", root), "[[1, 2], [], [7], [4, 5, 6]]");
+    EXPECT_EQ(query("size(items[*].tags)", root), "4");
+    EXPECT_EQ(query("max(items[*].rating)", root), "5");
+    EXPECT_EQ(query("min(items[*].rating)", root), "1");
+    EXPECT_EQ(query("items[*].missing", root), "[]");
+    EXPECT_EQ(query("[1, 2][*]", root), "[1, 2]");
+    EXPECT_THROW(query("items[0][*]", root), std::invalid_argument);
+}
+
+TEST_F(ProjectionCacheTest, ReuseTest) {
+    projection_lib::cache cache(1 << 20);
+    projection_lib::active_cache = &cache;
+    const auto root = parse(document);
+
+    EXPECT_EQ(query("max(items[*].rating)", root), "5");
+    EXPECT_EQ(query("items[*].rating", root), "[3, 5, 1]");
+    EXPECT_EQ(cache.stats().builds, 1);
+    EXPECT_EQ(cache.stats().hits, 1);
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_GT(cache.memory_usage(), 0);
+
+    const auto& items = dynamic_cast<const json_lib::json_object&>(*root);
+    const auto column = cache.find(items.at("items"), R"(["rating"])");
+    ASSERT_NE(column, nullptr);
+    EXPECT_EQ(column->positions, (std::vector<size_t> { 0, 1, 3 }));
+
+    EXPECT_EQ(query("items[*].item.name", root), R"(["a", "b"])");
+    EXPECT_EQ(cache.size(), 2);
+
+    // A reparsed document is a new version and gathers its own columns.
+    const auto reloaded = parse(R"({"items": [{"rating": 9}]})");
+    EXPECT_EQ(query("items[*].rating", reloaded), "[9]");
+    EXPECT_EQ(cache.stats().builds, 3);
+    EXPECT_EQ(cache.size(), 3);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.memory_usage(), 0);
+}
+
+TEST_F(ProjectionCacheTest, ExpiredSourceTest) {
+    projection_lib::cache cache(1 << 20);
+    projection_lib::active_cache = &cache;
+    auto source = parse("[{\"a\": 1}, {\"a\": 2}]");
+    EXPECT_EQ(query("$[*].a", source), "[1, 2]");
+    source.reset();
+
+    // An array allocated at the same address later must not match.
+    source = parse("[{\"a\": 3}]");
+    EXPECT_EQ(query("$[*].a", source), "[3]");
+    EXPECT_EQ(cache.stats().hits, 0);
+}
+
+TEST_F(ProjectionCacheTest, MemoryLimitTest) {
+    const auto root = parse(document);
+    projection_lib::cache probe(1 << 20);
+    projection_lib::active_cache = &probe;
+    query("items[*].rating", root);
+    const size_t one = probe.memory_usage();
+
+    projection_lib::cache cache(one + one / 2);
+    projection_lib::active_cache = &cache;
+    query("items[*].rating", root);
+    query("items[*].tags[0]", root);
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_EQ(cache.stats().evictions, 1);
+    EXPECT_LE(cache.memory_usage(), cache.memory_limit());
+
+    projection_lib::cache tiny(1);
+    projection_lib::active_cache = &tiny;
+    EXPECT_EQ(query("items[*].rating", root), "[3, 5, 1]");
+    EXPECT_EQ(tiny.size(), 0);
+    EXPECT_EQ(tiny.stats().builds, 1);
+}
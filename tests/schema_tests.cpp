@@ -0,0 +1,173 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "helpers.hpp"
+#include "schema.hpp"
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace {
+const std::string records[] = {
+    R"({"id": 1, "name": "a", "tags": ["x", "y"], "price": 2.5})",
+    R"({"id": 2, "name": "bc", "tags": [], "price": null})",
+    R"({"id": -3, "name": "d\"e", "tags": ["z"], "extra": {"k": true}})",
+};
+
+schema_lib::node observe_all() {
+    schema_lib::node schema;
+    for (const auto& record : records) {
+        schema_lib::observe(record, schema);
+    }
+    return schema;
+}
+
+void write_file(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream(path, std::ios::binary) << text;
+}
+}
+
+TEST(SchemaTest, ObserveTest) {
+    const auto schema = observe_all();
+    EXPECT_EQ(schema.count, 3);
+    EXPECT_EQ(schema.of(json_lib::json_type::object_json), 3);
+    ASSERT_EQ(schema.properties.size(), 5);
+
+    const auto& ids = *schema.properties.at("id");
+    EXPECT_EQ(ids.count, 3);
+    EXPECT_EQ(ids.of(json_lib::json_type::integer_json), 3);
+    EXPECT_EQ(ids.numbers.min, -3);
+    EXPECT_EQ(ids.numbers.max, 2);
+
+    const auto& names = *schema.properties.at("name");
+    EXPECT_EQ(names.lengths.min, 1);
+    EXPECT_EQ(names.lengths.max, 3);
+
+    const auto& tags = *schema.properties.at("tags");
+    EXPECT_EQ(tags.sizes.min, 0);
+    EXPECT_EQ(tags.sizes.max, 2);
+    ASSERT_NE(tags.elements, nullptr);
+    EXPECT_EQ(tags.elements->of(json_lib::json_type::string_json), 3);
+
+    const auto& prices = *schema.properties.at("price");
+    EXPECT_EQ(prices.count, 2);
+    EXPECT_EQ(prices.of(json_lib::json_type::real_json), 1);
+    EXPECT_EQ(prices.of(json_lib::json_type::null_json), 1);
+    EXPECT_EQ(schema.properties.at("extra")->properties.size(), 1);
+
+    for (const std::string text :
+         { "", "{", "[1,]", R"({"a" 1})", "tru", "1 2", R"("open)", "--" }) {
+        schema_lib::node ignored;
+        EXPECT_THROW(schema_lib::observe(text, ignored), std::runtime_error)
+            << text;
+    }
+}
+
+TEST(SchemaTest, MergeTest) {
+    schema_lib::node first;
+    schema_lib::observe(records[0], first);
+    schema_lib::node rest;
+    schema_lib::observe(records[1], rest);
+    schema_lib::observe(records[2], rest);
+    rest.merge(first);
+    EXPECT_EQ(rest.to_string(), observe_all().to_string());
+
+    schema_lib::node empty;
+    empty.merge(rest);
+    EXPECT_EQ(empty.to_string(), rest.to_string());
+}
+
+TEST(SchemaTest, ToStringTest) {
+    schema_lib::node schema;
+    schema_lib::observe(R"({"a": [1, 2.5], "b": "xy"})", schema);
+    schema_lib::observe(R"({"a": []})", schema);
+    EXPECT_EQ(
+        schema.to_string(),
+        R"({"count": 2, "types": {"object": 2}, "properties": {"a": )"
+        R"({"count": 2, "types": {"array": 2}, "size": [0, 2], "elements": )"
+        R"({"count": 2, "types": {"integer": 1, "real": 1}, )"
+        R"("range": [1, 2.5]}}, "b": {"count": 1, "types": {"string": 1}, )"
+        R"("length": [2, 2]}}, "optional": ["b"]})"
+    );
+}
+
+TEST(SchemaTest, PropertyLimitTest) {
+    std::string text = "{";
+    for (size_t i = 0; i <= schema_lib::max_properties; ++i) {
+        text += (i == 0 ? "\"k" : ", \"k") + std::to_string(i) + "\": 0";
+    }
+    text += '}';
+    schema_lib::node schema;
+    schema_lib::observe(text, schema);
+    EXPECT_EQ(schema.properties.size(), schema_lib::max_properties);
+    ASSERT_NE(schema.others, nullptr);
+    EXPECT_EQ(schema.others->count, 1);
+}
+
+TEST(SchemaTest, InferTest) {
+    const auto directory = test_lib::temp_path("schema_tests");
+    std::filesystem::create_directories(directory);
+    std::string lines;
+    std::string array = "[";
+    for (size_t i = 0; i < 200; ++i) {
+        const auto& record = records[i % 3];
+        lines += record + '\n';
+        array += (i == 0 ? "" : ",\n") + record;
+    }
+    array += ']';
+    write_file(directory / "feed.ndjson", lines);
+    write_file(directory / "feed.json", array);
+
+    const auto serial = schema_lib::infer({ directory / "feed.ndjson" }, 1);
+    EXPECT_EQ(serial.count, 200);
+    for (const size_t threads : { size_t { 2 }, size_t { 3 }, size_t { 8 } }) {
+        EXPECT_EQ(
+            schema_lib::infer({ directory / "feed.ndjson" }, threads)
+                .to_string(),
+            serial.to_string()
+        ) << threads;
+    }
+
+    const auto document = schema_lib::infer({ directory / "feed.json" }, 4);
+    EXPECT_EQ(document.count, 1);
+    EXPECT_EQ(document.sizes.min, 200);
+    ASSERT_NE(document.elements, nullptr);
+    EXPECT_EQ(document.elements->to_string(), serial.to_string());
+
+    write_file(directory / "empty.json", "[]");
+    const auto empty = schema_lib::infer({ directory / "empty.json" }, 4);
+    EXPECT_EQ(empty.sizes.max, 0);
+    EXPECT_EQ(empty.elements, nullptr);
+
+    const auto both = schema_lib::infer(
+        { directory / "feed.json", directory / "feed.json" }, 4
+    );
+    EXPECT_EQ(both.count, 2);
+    EXPECT_EQ(both.elements->count, 400);
+
+    write_file(directory / "broken.json", "[1, 2, {]");
+    EXPECT_THROW(
+        schema_lib::infer({ directory / "broken.json" }, 2), std::runtime_error
+    );
+    std::filesystem::remove_all(directory);
+}
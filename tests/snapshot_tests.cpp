@@ -0,0 +1,121 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "helpers.hpp"
+#include "parser.hpp"
+#include "reference.hpp"
+#include "snapshot.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+using test_lib::parse;
+
+const std::string document = R"({"name": "snap", "zeta": -7, "pi": 3.25,
+    "flags": [true, false, null], "nested": {"b": [1, 2, 3], "a": {"k": "v"}},
+    "name2": "snap"})";
+}
+
+TEST(SnapshotTest, RoundTripTest) {
+    const auto tree = parse(document);
+    const std::string bytes = snapshot_lib::encode(*tree);
+    const snapshot_lib::snapshot data(bytes);
+    EXPECT_EQ(data.root().materialize()->to_string(), tree->to_string());
+
+    const auto root = data.root();
+    EXPECT_EQ(root.type(), json_lib::json_type::object_json);
+    EXPECT_EQ(root.size(), 6);
+    EXPECT_EQ(root.key_at(1), "zeta");
+    EXPECT_EQ(root.find("zeta")->integer(), -7);
+    EXPECT_EQ(root.find("pi")->text(), "3.25");
+    EXPECT_EQ(root.find("name2")->text(), "snap");
+    EXPECT_FALSE(root.find("missing").has_value());
+    EXPECT_FALSE(root.find("zeta")->find("x").has_value());
+    const auto flags = *root.find("flags");
+    EXPECT_TRUE(flags.at(0).boolean());
+    EXPECT_EQ(flags.at(2).type(), json_lib::json_type::null_json);
+    EXPECT_THROW(static_cast<void>(flags.at(3)), std::out_of_range);
+    EXPECT_EQ(root.find("nested")->find("a")->find("k")->text(), "v");
+
+    for (const auto& scalar : { "42", "\"text\"", "[]", "{}" }) {
+        const std::string encoded = snapshot_lib::encode(*parse(scalar));
+        const snapshot_lib::snapshot data(encoded);
+        EXPECT_EQ(
+            data.root().materialize()->to_string(), parse(scalar)->to_string()
+        );
+    }
+}
+
+TEST(SnapshotTest, InvalidSnapshotTest) {
+    const std::string bytes = snapshot_lib::encode(*parse(document));
+    const std::string header = "JBIN";
+    EXPECT_THROW(snapshot_lib::snapshot { header }, std::runtime_error);
+    const std::string truncated = bytes.substr(0, 40);
+    EXPECT_THROW(snapshot_lib::snapshot { truncated }, std::runtime_error);
+    std::string damaged = bytes;
+    damaged[15] = '\x7F';
+    EXPECT_THROW(snapshot_lib::snapshot { damaged }, std::runtime_error);
+    EXPECT_THROW(
+        snapshot_lib::encode(*parse("a.b", true)), std::invalid_argument
+    );
+
+    std::string looped = snapshot_lib::encode(*parse("[[]]"));
+    const snapshot_lib::snapshot nested(looped);
+    const uint64_t root = nested.root().offset();
+    for (size_t i = 0; i < 8; ++i) {
+        looped[root + 5 + i] = looped[8 + i];
+    }
+    const snapshot_lib::snapshot cycle(looped);
+    EXPECT_THROW(static_cast<void>(cycle.root().at(0)), std::runtime_error);
+    EXPECT_THROW(
+        static_cast<void>(cycle.root().materialize()), std::runtime_error
+    );
+}
+
+TEST(SnapshotTest, EvaluateTest) {
+    const auto path = test_lib::temp_path("test.jbin");
+    snapshot_lib::write(*parse(document), path);
+    EXPECT_TRUE(snapshot_lib::is_snapshot(path));
+    const snapshot_lib::snapshot data(path);
+
+    const auto query = [&](const std::string& expression) {
+        return snapshot_lib::evaluate(data, parse(expression, true))
+            ->to_string();
+    };
+    const auto reference = [&](const std::string& expression) {
+        return reference_lib::evaluate(parse(expression, true), parse(document))
+            ->to_string();
+    };
+    for (const auto* expression :
+         { "nested.b[1]", "$.nested.a", "$", "max(nested.b)",
+           "size(nested.b)", "[zeta, nested.a.k]", "{\"x\": pi}",
+           "nested.b[nested.b[0]]", "nested{.b, .a}", "memsize(flags)" }) {
+        EXPECT_EQ(query(expression), reference(expression)) << expression;
+    }
+    EXPECT_THROW(query("nested.c"), std::out_of_range);
+    EXPECT_THROW(query("nested.b[5]"), std::out_of_range);
+    EXPECT_THROW(query("zeta.x"), std::invalid_argument);
+    EXPECT_THROW(query("nested[0]"), std::invalid_argument);
+    std::filesystem::remove(path);
+    EXPECT_FALSE(snapshot_lib::is_snapshot(path));
+}
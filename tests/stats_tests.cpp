@@ -0,0 +1,117 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "alloc.hpp"
+#include "parser.hpp"
+#include "stats.hpp"
+#include <gtest/gtest.h>
+
+TEST(StatsTest, DocumentStatsTest) {
+    std::shared_ptr<json_lib::json> base;
+    std::string buffer
+        = R"({"a": { "b": [ 1, 2, { "c": "test" }, [11, 1.5, null, true] ]}})";
+    parser_lib::parser p(buffer);
+    p.completely_parse_json(base);
+
+    stats_lib::document_stats stats;
+    stats.collect(*base);
+    const auto count = [&stats](json_lib::json_type type) {
+        return stats.nodes[static_cast<size_t>(type)];
+    };
+    EXPECT_EQ(count(json_lib::json_type::object_json), 3);
+    EXPECT_EQ(count(json_lib::json_type::array_json), 2);
+    EXPECT_EQ(count(json_lib::json_type::integer_json), 3);
+    EXPECT_EQ(count(json_lib::json_type::real_json), 1);
+    EXPECT_EQ(count(json_lib::json_type::string_json), 1);
+    EXPECT_EQ(count(json_lib::json_type::boolean_json), 1);
+    EXPECT_EQ(count(json_lib::json_type::null_json), 1);
+    EXPECT_EQ(stats.total_nodes(), 12);
+    EXPECT_EQ(stats.max_depth, 5);
+    EXPECT_EQ(stats.string_bytes, 7);
+
+    stats_lib::document_stats scalar;
+    scalar.collect(json_lib::json_integer(1));
+    EXPECT_EQ(scalar.total_nodes(), 1);
+    EXPECT_EQ(scalar.max_depth, 1);
+}
+
+TEST(StatsTest, RunStatsTest) {
+    const auto item = std::make_shared<json_lib::json_integer>(1);
+    stats_lib::run_stats stats;
+    stats.bytes_read = 42;
+    stats.document.collect(*item);
+
+    std::shared_ptr<json_lib::json> result;
+    std::string buffer = stats.to_string();
+    parser_lib::parser p(buffer);
+    p.completely_parse_json(result);
+    ASSERT_EQ(result->type(), json_lib::json_type::object_json);
+    const auto object = std::dynamic_pointer_cast<json_lib::json_object>(result);
+    EXPECT_EQ(object->at("bytes_read")->to_string(), "42");
+    EXPECT_EQ(object->at("max_depth")->to_string(), "1");
+    EXPECT_EQ(
+        std::dynamic_pointer_cast<json_lib::json_object>(object->at("nodes"))
+            ->at("integer")
+            ->to_string(),
+        "1"
+    );
+    EXPECT_EQ(
+        std::dynamic_pointer_cast<json_lib::json_object>(object->at("time_us"))
+            ->size(),
+        5
+    );
+    const auto allocations = std::dynamic_pointer_cast<json_lib::json_object>(
+        object->at("allocations")
+    );
+    ASSERT_NE(allocations, nullptr);
+    EXPECT_EQ(
+        allocations->size(), alloc_lib::enabled ? alloc_lib::phase_count + 1 : 1
+    );
+    const auto total = std::dynamic_pointer_cast<json_lib::json_object>(
+        allocations->at("total")
+    );
+    EXPECT_NE(total->at("count")->to_string(), "0");
+}
+
+TEST(StatsTest, LatencySummaryTest) {
+    EXPECT_EQ(stats_lib::summarize({}).count, 0);
+    EXPECT_EQ(stats_lib::summarize({}).throughput(), 0);
+
+    std::vector<std::chrono::nanoseconds> samples;
+    for (int i = 200; i >= 1; --i) {
+        samples.emplace_back(i * 1000);
+    }
+    const auto summary = stats_lib::summarize(samples);
+    EXPECT_EQ(summary.count, 200);
+    EXPECT_EQ(summary.min, std::chrono::microseconds(1));
+    EXPECT_EQ(summary.median, std::chrono::microseconds(100));
+    EXPECT_EQ(summary.p99, std::chrono::microseconds(198));
+    EXPECT_EQ(summary.max, std::chrono::microseconds(200));
+    EXPECT_EQ(summary.total, std::chrono::microseconds(20100));
+    EXPECT_NEAR(summary.throughput(), 200 / 0.0201, 1e-6);
+    EXPECT_NE(summary.to_string().find("p99: 198.000us"), std::string::npos);
+
+    const auto single = stats_lib::summarize({ std::chrono::nanoseconds(5) });
+    EXPECT_EQ(single.median, std::chrono::nanoseconds(5));
+    EXPECT_EQ(single.p99, std::chrono::nanoseconds(5));
+}
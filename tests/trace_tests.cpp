@@ -0,0 +1,93 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "parser.hpp"
+#include "trace.hpp"
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+TEST(TraceTest, RecorderTest) {
+    trace_lib::recorder recorder;
+    EXPECT_EQ(recorder.size(), 0);
+    {
+        const trace_lib::span span("outside");
+    }
+    EXPECT_EQ(recorder.size(), 0);
+
+    trace_lib::active_recorder = &recorder;
+    {
+        const trace_lib::span span("inside \"quoted\"", "test");
+    }
+    std::thread([] { const trace_lib::span span("worker"); }).join();
+    trace_lib::active_recorder = nullptr;
+    EXPECT_EQ(recorder.size(), 2);
+
+    std::stringstream ss;
+    recorder.write(ss);
+    std::shared_ptr<json_lib::json> result;
+    parser_lib::parser p(ss);
+    p.completely_parse_json(result);
+    const auto events = std::dynamic_pointer_cast<json_lib::json_array>(
+        std::dynamic_pointer_cast<json_lib::json_object>(result)->at(
+            "traceEvents"
+        )
+    );
+    ASSERT_EQ(events->size(), 2);
+    const auto first
+        = std::dynamic_pointer_cast<json_lib::json_object>(events->at(0));
+    const auto second
+        = std::dynamic_pointer_cast<json_lib::json_object>(events->at(1));
+    EXPECT_EQ(first->at("name")->to_string(), R"("inside \"quoted\"")");
+    EXPECT_EQ(first->at("cat")->to_string(), "\"test\"");
+    EXPECT_EQ(first->at("ph")->to_string(), "\"X\"");
+    EXPECT_EQ(second->at("name")->to_string(), "\"worker\"");
+    EXPECT_NE(first->at("tid")->to_string(), second->at("tid")->to_string());
+}
+
+TEST(TraceTest, EvaluationTraceTest) {
+    trace_lib::recorder recorder(true);
+    trace_lib::active_recorder = &recorder;
+    std::shared_ptr<json_lib::json> base;
+    std::string buffer = R"({"a": [1, 2, 3], "b": {"c": 4}})";
+    parser_lib::parser p(buffer);
+    p.completely_parse_json(base);
+    std::shared_ptr<json_lib::json> result;
+    buffer = "max(a[0], b.c)";
+    p = parser_lib::parser(buffer);
+    p.completely_parse_json(result, true);
+    result = reference_lib::evaluate(result, base);
+    EXPECT_EQ(result->to_string(), "4");
+    trace_lib::active_recorder = nullptr;
+
+    std::stringstream ss;
+    recorder.write(ss);
+    const std::string trace = ss.str();
+    for (const std::string name :
+         { "parse", "compile", "evaluate", "serialize", "a", "b", "[0]",
+           "[\\\"c\\\"]", "max()" }) {
+        EXPECT_NE(trace.find("\"name\": \"" + name + '"'), std::string::npos)
+            << name;
+    }
+}
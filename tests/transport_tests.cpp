@@ -0,0 +1,101 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2024 Yaroslav Riabtsev <yaroslav.riabtsev@rwth-aachen.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "helpers.hpp"
+#include "transport.hpp"
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <fstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST(TransportTest, MemfdSegmentTest) {
+    const int fd = transport_lib::create_memfd("transport_test");
+    ASSERT_GE(fd, 0);
+    const std::string text(1 << 20, 'x');
+    transport_lib::write_segment(fd, text);
+    {
+        const transport_lib::mapped_segment segment(fd);
+        EXPECT_EQ(segment.view().size(), text.size());
+        EXPECT_EQ(segment.view(), text);
+    }
+    transport_lib::write_segment(fd, R"({"a": 1})");
+    {
+        const transport_lib::mapped_segment segment(fd);
+        EXPECT_EQ(segment.view(), R"({"a": 1})");
+    }
+    transport_lib::write_segment(fd, "");
+    {
+        const transport_lib::mapped_segment segment(fd);
+        EXPECT_TRUE(segment.view().empty());
+    }
+    close(fd);
+    EXPECT_THROW(transport_lib::write_segment(fd, "[]"), std::runtime_error);
+}
+
+TEST(TransportTest, PathSegmentTest) {
+    const auto path = test_lib::temp_path("transport_test.json");
+    transport_lib::write_segment(path, "[1, 2, 3]");
+    transport_lib::write_segment(path, "[4]");
+    EXPECT_EQ(std::filesystem::file_size(path), 3);
+    std::filesystem::remove(path);
+    EXPECT_THROW(
+        transport_lib::write_segment(
+            std::filesystem::path("/nonexistent/dir/out.json"), "[]"
+        ),
+        std::runtime_error
+    );
+}
+
+TEST(TransportTest, InheritedMemfdTest) {
+    const auto input = test_lib::temp_path("input.json");
+    std::ofstream(input) << R"({"a": [1, 2, 3]})";
+    const int fd = transport_lib::create_memfd("transport_child");
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(fcntl(fd, F_GETFD) & FD_CLOEXEC, 0);
+    const std::string target = "fd:" + std::to_string(fd);
+
+    const pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        const int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        execl(
+            JSON_EVAL_BINARY, "json_eval", "--output-shm", target.c_str(),
+            input.c_str(), "a", static_cast<char*>(nullptr)
+        );
+        _exit(127);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    {
+        const transport_lib::mapped_segment segment(fd);
+        EXPECT_EQ(segment.view(), "[1, 2, 3]");
+    }
+    close(fd);
+    std::filesystem::remove(input);
+}